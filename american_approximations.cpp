@@ -0,0 +1,342 @@
+#include "american_approximations.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    // Normal cdf from erfc, accurate deep in the tails the bivariate terms reach
+    double cnd(double x) {
+        return 0.5 * std::erfc(-x * M_SQRT1_2);
+    }
+
+    double pdf(double x) {
+        return 0.5 * M_2_SQRTPI * M_SQRT1_2 * std::exp(-0.5 * x * x);
+    }
+
+    void validate(double S, double K, double T, double sigma) {
+        if (S <= 0 || K <= 0 || T <= 0 || sigma <= 0) {
+            throw std::invalid_argument("Invalid parameters: All values must be positive");
+        }
+    }
+
+    // The approximations take one flat rate and no cash dividends, so American contracts need
+    // flat market data. Europeans under a Carry are priced on the prepaid forward
+    void validateCarry(bool flat, bool isAmerican) {
+        if (isAmerican && !flat) {
+            throw std::invalid_argument("American approximations need flat market data, use BinomialPricer under a carry");
+        }
+    }
+
+    // Generalized Black-Scholes with cost of carry b, b = r for a non-dividend stock
+    double europeanPrice(double S, double K, double r, double b, double sigma, double T, bool isCall) {
+        const double sigmaSqrtT = sigma * std::sqrt(T);
+        const double d1 = (std::log(S / K) + (b + 0.5 * sigma * sigma) * T) / sigmaSqrtT;
+        const double d2 = d1 - sigmaSqrtT;
+        const double carry = std::exp((b - r) * T);
+        const double discount = std::exp(-r * T);
+        return isCall
+            ? S * carry * cnd(d1) - K * discount * cnd(d2)
+            : K * discount * cnd(-d2) - S * carry * cnd(-d1);
+    }
+
+    // Barone-Adesi-Whaley, the critical spot solves
+    //   call: S* - K = c(S*) + (1 - e^{(b-r)T} N(d1(S*))) S* / q2
+    //   put:  K - S* = p(S*) - (1 - e^{(b-r)T} N(-d1(S*))) S* / q1
+    // by Newton from Barone-Adesi and Whaley's seed, then the premium is A (S / S*)^q
+    double baroneAdesiWhaley(double S, double K, double r, double b, double sigma, double T, bool isCall) {
+        // Calls with b >= r are never exercised early, puts need positive rates to be
+        if (isCall ? b >= r : r <= 0) {
+            return europeanPrice(S, K, r, b, sigma, T, isCall);
+        }
+
+        const double variance = sigma * sigma;
+        const double sigmaSqrtT = sigma * std::sqrt(T);
+        const double M = 2.0 * r / variance;
+        const double N = 2.0 * b / variance;
+        const double carry = std::exp((b - r) * T);
+        const double discountComplement = -std::expm1(-r * T);
+        const double sgn = isCall ? 1.0 : -1.0;
+        const double root = std::sqrt((N - 1) * (N - 1) + 4.0 * M / discountComplement);
+        const double q = 0.5 * (-(N - 1) + sgn * root);
+
+        // Seed from the perpetual boundary, pulled towards the strike for short expiries
+        const double qInfinity = 0.5 * (-(N - 1) + sgn * std::sqrt((N - 1) * (N - 1) + 4.0 * M));
+        const double perpetual = K / (1.0 - 1.0 / qInfinity);
+        double critical = isCall
+            ? K + (perpetual - K) * (1.0 - std::exp(-(b * T + 2.0 * sigmaSqrtT) * K / (perpetual - K)))
+            : perpetual + (K - perpetual) * std::exp((b * T - 2.0 * sigmaSqrtT) * K / (K - perpetual));
+
+        for (int iteration = 0; iteration < 100; ++iteration) {
+            const double d1 = (std::log(critical / K) + (b + 0.5 * variance) * T) / sigmaSqrtT;
+            const double nd1 = cnd(sgn * d1);
+            const double rhs = europeanPrice(critical, K, r, b, sigma, T, isCall)
+                             + sgn * (1.0 - carry * nd1) * critical / q;
+            const double lhs = sgn * (critical - K);
+            if (std::abs(lhs - rhs) < 1e-9 * K) {
+                break;
+            }
+            // Slope of the right-hand side in S*
+            const double slope = sgn * carry * nd1 * (1.0 - 1.0 / q)
+                               + (sgn - carry * pdf(d1) / sigmaSqrtT) / q;
+            critical = isCall
+                ? (K + rhs - slope * critical) / (1.0 - slope)
+                : (K - rhs + slope * critical) / (1.0 + slope);
+        }
+
+        const double d1 = (std::log(critical / K) + (b + 0.5 * variance) * T) / sigmaSqrtT;
+        const double A = sgn * (critical / q) * (1.0 - carry * cnd(sgn * d1));
+        if (isCall ? S >= critical : S <= critical) {
+            return sgn * (S - K);
+        }
+        return europeanPrice(S, K, r, b, sigma, T, isCall) + A * std::pow(S / critical, q);
+    }
+
+    // Gauss-Legendre abscissae (negative half) and weights for 6, 12 and 20 points
+    constexpr double GAUSS_X[3][10] = {
+        {-0.9324695142031522, -0.6612093864662647, -0.2386191860831970},
+        {-0.9815606342467191, -0.9041172563704750, -0.7699026741943050,
+         -0.5873179542866171, -0.3678314989981802, -0.1252334085114692},
+        {-0.9931285991850949, -0.9639719272779138, -0.9122344282513259, -0.8391169718222188,
+         -0.7463319064601508, -0.6360536807265150, -0.5108670019508271, -0.3737060887154196,
+         -0.2277858511416451, -0.07652652113349733}
+    };
+    constexpr double GAUSS_W[3][10] = {
+        {0.1713244923791705, 0.3607615730481384, 0.4679139345726904},
+        {0.04717533638651177, 0.1069393259953183, 0.1600783285433464,
+         0.2031674267230659, 0.2334925365383547, 0.2491470458134029},
+        {0.01761400713915212, 0.04060142980038694, 0.06267204833410906, 0.08327674157670475,
+         0.1019301198172404, 0.1181945319615184, 0.1316886384491766, 0.1420961093183821,
+         0.1491729864726037, 0.1527533871307259}
+    };
+
+    // Genz's (2004) bivariate normal for one correlation
+    // Below |rho| = 0.925 the quadrature depends on rho only through its nodes
+    // sin(asin(rho) (1 +- x) / 2), which are tabulated here so evaluations cost one exp per node
+    class BivariateNormal {
+        public:
+            explicit BivariateNormal(double rho) : rho(rho) {
+                const double absRho = std::abs(rho);
+                rule = absRho < 0.3 ? 0 : (absRho < 0.75 ? 1 : 2);
+                points = rule == 0 ? 3 : (rule == 1 ? 6 : 10);
+                if (absRho < 0.925) {
+                    const double asr = std::asin(rho);
+                    for (int i = 0; i < points; ++i) {
+                        for (int side = 0; side < 2; ++side) {
+                            const double sn = std::sin(0.5 * asr * (1.0 + (side ? -1.0 : 1.0) * GAUSS_X[rule][i]));
+                            const int node = 2 * i + side;
+                            sine[node] = sn;
+                            inverse[node] = 1.0 / (1.0 - sn * sn);
+                            weight[node] = GAUSS_W[rule][i] * asr / (4.0 * M_PI);
+                        }
+                    }
+                }
+            }
+
+            // P(X < a, Y < b)
+            double operator()(double a, double b) const {
+                // Genz works with the upper orthant P(X > h, Y > k)
+                double h = -a;
+                double k = -b;
+                double hk = h * k;
+
+                if (std::abs(rho) < 0.925) {
+                    const double hs = 0.5 * (h * h + k * k);
+                    double result = 0.0;
+                    for (int node = 0; node < 2 * points; ++node) {
+                        result += weight[node] * std::exp((sine[node] * hk - hs) * inverse[node]);
+                    }
+                    return result + cnd(-h) * cnd(-k);
+                }
+
+                double result = 0.0;
+                if (rho < 0) {
+                    k = -k;
+                    hk = -hk;
+                }
+                if (std::abs(rho) < 1.0) {
+                    const double as = (1.0 - rho) * (1.0 + rho);
+                    double aa = std::sqrt(as);
+                    const double bs = (h - k) * (h - k);
+                    const double c = (4.0 - hk) / 8.0;
+                    const double d = (12.0 - hk) / 16.0;
+                    result = aa * std::exp(-0.5 * (bs / as + hk))
+                           * (1.0 - c * (bs - as) * (1.0 - d * bs / 5.0) / 3.0 + c * d * as * as / 5.0);
+                    if (hk > -160.0) {
+                        const double bb = std::sqrt(bs);
+                        result -= std::exp(-0.5 * hk) * std::sqrt(2.0 * M_PI) * cnd(-bb / aa) * bb
+                                * (1.0 - c * bs * (1.0 - d * bs / 5.0) / 3.0);
+                    }
+                    aa *= 0.5;
+                    for (int i = 0; i < points; ++i) {
+                        for (const double side : {1.0, -1.0}) {
+                            const double xs = (aa * (side * GAUSS_X[rule][i] + 1.0)) * (aa * (side * GAUSS_X[rule][i] + 1.0));
+                            const double rs = std::sqrt(1.0 - xs);
+                            result += aa * GAUSS_W[rule][i] * (std::exp(-0.5 * bs / xs - hk / (1.0 + rs)) / rs
+                                                               - std::exp(-0.5 * (bs / xs + hk)) * (1.0 + c * xs * (1.0 + d * xs)));
+                        }
+                    }
+                    result = -result / (2.0 * M_PI);
+                }
+
+                if (rho > 0) {
+                    return result + cnd(-std::max(h, k));
+                }
+                result = -result;
+                if (k > h) {
+                    result += h < 0 ? cnd(k) - cnd(h) : cnd(-h) - cnd(-k);
+                }
+                return result;
+            }
+
+        private:
+            double rho;
+            int rule;
+            int points;
+            double sine[20];
+            double inverse[20];
+            double weight[20];
+    };
+
+    // Bjerksund-Stensland splits the expiry at t1 = T (sqrt(5) - 1) / 2, so every bivariate term
+    // has correlation +-sqrt(t1 / T) whatever the contract
+    const double GOLDEN_SPLIT = 0.5 * (std::sqrt(5.0) - 1.0);
+    const BivariateNormal correlated(std::sqrt(GOLDEN_SPLIT));
+    const BivariateNormal anticorrelated(-std::sqrt(GOLDEN_SPLIT));
+
+    // Bjerksund-Stensland phi: value of receiving S^gamma at T unless the spot hits I first,
+    // and only if it ends below H
+    double phi(double S, double T, double gamma, double H, double I, double r, double b, double sigma) {
+        const double variance = sigma * sigma;
+        const double sigmaSqrtT = sigma * std::sqrt(T);
+        const double lambda = (-r + gamma * b + 0.5 * gamma * (gamma - 1.0) * variance) * T;
+        const double d = -(std::log(S / H) + (b + (gamma - 0.5) * variance) * T) / sigmaSqrtT;
+        const double kappa = 2.0 * b / variance + 2.0 * gamma - 1.0;
+        return std::exp(lambda) * std::pow(S, gamma)
+             * (cnd(d) - std::pow(I / S, kappa) * cnd(d - 2.0 * std::log(I / S) / sigmaSqrtT));
+    }
+
+    // Bjerksund-Stensland psi: the same claim with the barrier I1 on [0, t1] and I2 on [t1, T]
+    double psi(double S, double T, double gamma, double H, double I2, double I1, double t1,
+               double r, double b, double sigma) {
+        const double variance = sigma * sigma;
+        const double drift = b + (gamma - 0.5) * variance;
+        const double sigmaSqrtT1 = sigma * std::sqrt(t1);
+        const double sigmaSqrtT = sigma * std::sqrt(T);
+        const double e1 = (std::log(S / I1) + drift * t1) / sigmaSqrtT1;
+        const double e2 = (std::log(I2 * I2 / (S * I1)) + drift * t1) / sigmaSqrtT1;
+        const double e3 = (std::log(S / I1) - drift * t1) / sigmaSqrtT1;
+        const double e4 = (std::log(I2 * I2 / (S * I1)) - drift * t1) / sigmaSqrtT1;
+        const double f1 = (std::log(S / H) + drift * T) / sigmaSqrtT;
+        const double f2 = (std::log(I2 * I2 / (S * H)) + drift * T) / sigmaSqrtT;
+        const double f3 = (std::log(I1 * I1 / (S * H)) + drift * T) / sigmaSqrtT;
+        const double f4 = (std::log(S * I1 * I1 / (H * I2 * I2)) + drift * T) / sigmaSqrtT;
+        const double lambda = -r + gamma * b + 0.5 * gamma * (gamma - 1.0) * variance;
+        const double kappa = 2.0 * b / variance + 2.0 * gamma - 1.0;
+        return std::exp(lambda * T) * std::pow(S, gamma)
+             * (correlated(-e1, -f1)
+                - std::pow(I2 / S, kappa) * correlated(-e2, -f2)
+                - std::pow(I1 / S, kappa) * anticorrelated(-e3, -f3)
+                + std::pow(I1 / I2, kappa) * anticorrelated(-e4, -f4));
+    }
+
+    double bjerksundStenslandCall(double S, double K, double r, double b, double sigma, double T) {
+        if (b >= r) {
+            return europeanPrice(S, K, r, b, sigma, T, true);
+        }
+
+        const double variance = sigma * sigma;
+        const double t1 = GOLDEN_SPLIT * T;
+        const double beta = (0.5 - b / variance) + std::sqrt((b / variance - 0.5) * (b / variance - 0.5) + 2.0 * r / variance);
+        const double bInfinity = beta / (beta - 1.0) * K;
+        const double b0 = std::max(K, r / (r - b) * K);
+        const double scale = K * K / ((bInfinity - b0) * b0);
+        const double I1 = b0 + (bInfinity - b0) * -std::expm1(-(b * t1 + 2.0 * sigma * std::sqrt(t1)) * scale);
+        const double I2 = b0 + (bInfinity - b0) * -std::expm1(-(b * T + 2.0 * sigma * std::sqrt(T)) * scale);
+        if (S >= I2) {
+            return S - K;
+        }
+
+        const double alpha1 = (I1 - K) * std::pow(I1, -beta);
+        const double alpha2 = (I2 - K) * std::pow(I2, -beta);
+        return alpha2 * std::pow(S, beta) - alpha2 * phi(S, t1, beta, I2, I2, r, b, sigma)
+             + phi(S, t1, 1, I2, I2, r, b, sigma) - phi(S, t1, 1, I1, I2, r, b, sigma)
+             - K * phi(S, t1, 0, I2, I2, r, b, sigma) + K * phi(S, t1, 0, I1, I2, r, b, sigma)
+             + alpha1 * phi(S, t1, beta, I1, I2, r, b, sigma)
+             - alpha1 * psi(S, T, beta, I1, I2, I1, t1, r, b, sigma)
+             + psi(S, T, 1, I1, I2, I1, t1, r, b, sigma) - psi(S, T, 1, K, I2, I1, t1, r, b, sigma)
+             - K * psi(S, T, 0, I1, I2, I1, t1, r, b, sigma) + K * psi(S, T, 0, K, I2, I1, t1, r, b, sigma);
+    }
+
+    // Puts by the put-call transformation P(S, K, r, b) = C(K, S, r - b, -b)
+    double bjerksundStensland(double S, double K, double r, double b, double sigma, double T, bool isCall) {
+        return isCall
+            ? bjerksundStenslandCall(S, K, r, b, sigma, T)
+            : bjerksundStenslandCall(K, S, r - b, -b, sigma, T);
+    }
+
+    // Shared by both pricers: European contracts get Black-Scholes, Americans the approximation
+    template <typename Approximation>
+    double approximatePrice(Approximation approximation, double S, double K, double r, double sigma, double T,
+                            bool isCall, bool isAmerican) {
+        return isAmerican
+            ? approximation(S, K, r, r, sigma, T, isCall)
+            : europeanPrice(S, K, r, r, sigma, T, isCall);
+    }
+
+    template <typename Approximation>
+    void approximatePrices(Approximation approximation, const OptionBatch& batch, double* prices, size_t count) {
+        if (count < batch.size) {
+            throw std::invalid_argument("Output buffer is smaller than the batch");
+        }
+
+        for (size_t i = 0; i < batch.size; ++i) {
+            validate(batch.spot[i], batch.strike[i], batch.expiry[i], batch.volatility[i]);
+            validateCarry(batch.isFlat(i), batch.style[i] == Option::Style::AMERICAN);
+        }
+
+        for (size_t i = 0; i < batch.size; ++i) {
+            prices[i] = approximatePrice(approximation, batch.spot[i], batch.strike[i], batch.riskFreeRate[i],
+                                         batch.volatility[i], batch.expiry[i],
+                                         batch.type[i] == Option::Type::CALL,
+                                         batch.style[i] == Option::Style::AMERICAN);
+        }
+    }
+
+    // One contract on the prepaid forward and the zero rate to its expiry
+    template <typename Approximation>
+    double scalarPrice(Approximation approximation, const Option& option, const MarketData& marketData) {
+        const double T = option.getExpiry();
+        const double S = marketData.getPrepaidForward(T);
+        const double sigma = marketData.getVolatility(option);
+        const bool isAmerican = option.getStyle() == Option::Style::AMERICAN;
+        validate(S, option.getStrike(), T, sigma);
+        validateCarry(marketData.isFlat(), isAmerican);
+        return approximatePrice(approximation, S, option.getStrike(), marketData.getRiskFreeRate(T), sigma, T,
+                                option.getType() == Option::Type::CALL, isAmerican);
+    }
+}
+
+double bivariateNormalCDF(double a, double b, double rho) {
+    return BivariateNormal(rho)(a, b);
+}
+
+double BaroneAdesiWhaleyPricer::calculatePrice(const Option& option, const MarketData& marketData) {
+    OPTIONS_TIME_SCOPE(BARONE_ADESI_WHALEY_PRICE);
+    return scalarPrice(baroneAdesiWhaley, option, marketData);
+}
+
+void BaroneAdesiWhaleyPricer::calculatePrices(const OptionBatch& batch, double* prices, size_t count) {
+    OPTIONS_TIME_SCOPE(BARONE_ADESI_WHALEY_BATCH);
+    approximatePrices(baroneAdesiWhaley, batch, prices, count);
+}
+
+double BjerksundStenslandPricer::calculatePrice(const Option& option, const MarketData& marketData) {
+    OPTIONS_TIME_SCOPE(BJERKSUND_STENSLAND_PRICE);
+    return scalarPrice(bjerksundStensland, option, marketData);
+}
+
+void BjerksundStenslandPricer::calculatePrices(const OptionBatch& batch, double* prices, size_t count) {
+    OPTIONS_TIME_SCOPE(BJERKSUND_STENSLAND_BATCH);
+    approximatePrices(bjerksundStensland, batch, prices, count);
+}
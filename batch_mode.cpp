@@ -0,0 +1,743 @@
+#include "batch_mode.hpp"
+#include "chain_file.hpp"
+#include "chain_pricer.hpp"
+#include "american_approximations.hpp"
+#include "thread_pool.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace BatchMode {
+    namespace {
+        constexpr size_t IO_BLOCK = 1 << 20;   // read and write buffer size
+        constexpr size_t PIPELINE_DEPTH = 3;   // chunks in flight, one per stage
+        constexpr size_t DECISION_BLOCK = 8;   // contracts per decision task
+
+        enum class Outcome : char { BUY, SELL, HOLD, SKIPPED, INVALID, FAILED };
+
+        struct Chunk {
+            size_t firstRow = 0;
+            OptionBatch view{};   // contracts to price, either chain below or a slice of a mapped file
+            OptionChain chain;
+            std::vector<double> price, delta, gamma, theta, vega, rho;
+            std::vector<Outcome> outcome;
+
+            // Per-style sub-chains handed to the batch pricers, reused across chunks
+            OptionChain european, american;
+            std::vector<size_t> europeanRows, americanRows;
+            std::vector<double> scratch;
+        };
+
+        // Unbounded hand-off between stages, memory is bounded by the fixed set of chunks
+        class ChunkQueue {
+            public:
+                void push(Chunk* chunk) {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        items.push_back(chunk);
+                    }
+                    ready.notify_one();
+                }
+
+                // Blocks until a chunk arrives, false once closed and drained
+                bool pop(Chunk*& chunk) {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    ready.wait(lock, [&] { return closed || !items.empty(); });
+                    if (items.empty()) {
+                        return false;
+                    }
+                    chunk = items.front();
+                    items.pop_front();
+                    return true;
+                }
+
+                void close() {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        closed = true;
+                    }
+                    ready.notify_all();
+                }
+
+            private:
+                std::mutex mutex;
+                std::condition_variable ready;
+                std::deque<Chunk*> items;
+                bool closed = false;
+        };
+
+        FILE* openFile(const std::string& path, const char* mode, FILE* standard) {
+            if (path == "-") {
+                return standard;
+            }
+            FILE* file = std::fopen(path.c_str(), mode);
+            if (!file) {
+                throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+            }
+            return file;
+        }
+
+        bool equalsIgnoreCase(const char* begin, const char* end, const char* word) {
+            const size_t length = std::strlen(word);
+            if (static_cast<size_t>(end - begin) != length) {
+                return false;
+            }
+            for (size_t i = 0; i < length; ++i) {
+                char c = begin[i];
+                if (c >= 'A' && c <= 'Z') {
+                    c = static_cast<char>(c - 'A' + 'a');
+                }
+                if (c != word[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Formats results with to_chars into a large buffer flushed with fwrite
+        class ResultWriter {
+            public:
+                explicit ResultWriter(const std::string& path)
+                    : path(path), file(openFile(path, "wb", stdout)), buffer(IO_BLOCK) {
+                    append("row,price,delta,gamma,theta,vega,rho,action\n");
+                }
+
+                ~ResultWriter() {
+                    if (file != stdout) {
+                        std::fclose(file);
+                    }
+                }
+
+                ResultWriter(const ResultWriter&) = delete;
+                ResultWriter& operator=(const ResultWriter&) = delete;
+
+                // Returns the number of rows reported as errors
+                size_t write(const Chunk& chunk) {
+                    size_t errors = 0;
+                    for (size_t i = 0; i < chunk.view.size; ++i) {
+                        if (used + 256 > buffer.size()) {
+                            flush();
+                        }
+                        appendInteger(chunk.firstRow + i);
+
+                        const Outcome outcome = chunk.outcome[i];
+                        if (outcome == Outcome::INVALID) {
+                            append(",,,,,,,ERROR\n");
+                            ++errors;
+                            continue;
+                        }
+                        for (const auto* column : {&chunk.price, &chunk.delta, &chunk.gamma,
+                                                   &chunk.theta, &chunk.vega, &chunk.rho}) {
+                            append(",");
+                            appendNumber((*column)[i]);
+                        }
+                        switch (outcome) {
+                            case Outcome::BUY: append(",BUY\n"); break;
+                            case Outcome::SELL: append(",SELL\n"); break;
+                            case Outcome::HOLD: append(",HOLD\n"); break;
+                            case Outcome::FAILED: append(",ERROR\n"); ++errors; break;
+                            default: append(",\n"); break;
+                        }
+                    }
+                    return errors;
+                }
+
+                void flush() {
+                    if (used > 0 && std::fwrite(buffer.data(), 1, used, file) != used) {
+                        throw std::runtime_error("Failed writing " + path);
+                    }
+                    used = 0;
+                }
+
+                void finish() {
+                    flush();
+                    if (std::fflush(file) != 0) {
+                        throw std::runtime_error("Failed writing " + path);
+                    }
+                }
+
+            private:
+                void append(const char* text) {
+                    const size_t length = std::strlen(text);
+                    std::memcpy(buffer.data() + used, text, length);
+                    used += length;
+                }
+
+                void appendInteger(size_t value) {
+                    used = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value).ptr - buffer.data();
+                }
+
+                void appendNumber(double value) {
+                    used = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value,
+                                         std::chars_format::general, 12).ptr - buffer.data();
+                }
+
+                std::string path;
+                FILE* file;
+                std::vector<char> buffer;
+                size_t used = 0;
+        };
+
+        // Prices a chunk with Greeks and runs the trading decision per contract
+        class PricingStage {
+            public:
+                PricingStage(WorkStealingPool& pool, bool decisions)
+                    : pool(pool), pricer(pool), decisions(decisions) {
+                    decisionStrategies.push_back(std::make_unique<BlackScholesPricer>());
+                    decisionStrategies.push_back(std::make_unique<BinomialPricer>());
+                    // Americans compare Bjerksund-Stensland with the tree. TradingDecision::screen would skip
+                    // the tree on clear contracts, but may differ from this on a few of them
+                    americanStrategies.push_back(std::make_unique<BjerksundStenslandPricer>());
+                    americanStrategies.push_back(std::make_unique<BinomialPricer>());
+                }
+
+                void process(Chunk& chunk) {
+                    const OptionBatch batch = chunk.view;
+                    const size_t n = batch.size;
+                    for (auto* column : {&chunk.price, &chunk.delta, &chunk.gamma,
+                                         &chunk.theta, &chunk.vega, &chunk.rho}) {
+                        column->assign(n, 0.0);
+                    }
+                    chunk.outcome.assign(n, Outcome::SKIPPED);
+
+                    // Invalid rows are reported individually instead of failing the whole batch
+                    chunk.europeanRows.clear();
+                    chunk.americanRows.clear();
+                    for (size_t i = 0; i < n; ++i) {
+                        if (!isValid(batch, i)) {
+                            chunk.outcome[i] = Outcome::INVALID;
+                        } else if (batch.style[i] == Option::Style::AMERICAN) {
+                            chunk.americanRows.push_back(i);
+                        } else {
+                            chunk.europeanRows.push_back(i);
+                        }
+                    }
+
+                    priceStyle(chunk, chunk.european, chunk.europeanRows, blackScholes);
+                    priceStyle(chunk, chunk.american, chunk.americanRows, binomial);
+
+                    if (decisions) {
+                        decide(chunk, chunk.europeanRows);
+                        decide(chunk, chunk.americanRows);
+                    }
+                }
+
+            private:
+                static bool isValid(const OptionBatch& batch, size_t i) {
+                    const double S = batch.spot[i], K = batch.strike[i], T = batch.expiry[i], sigma = batch.volatility[i];
+                    return std::isfinite(S) && std::isfinite(K) && std::isfinite(T) && std::isfinite(sigma) &&
+                           std::isfinite(batch.riskFreeRate[i]) && S > 0 && K > 0 && T > 0 && sigma > 0;
+                }
+
+                void priceStyle(Chunk& chunk, OptionChain& subChain, const std::vector<size_t>& rows,
+                                PricingStrategy& strategy) {
+                    const OptionBatch batch = chunk.view;
+                    const size_t count = rows.size();
+                    if (count == 0) {
+                        return;
+                    }
+
+                    // A chunk of one style with no bad rows, the usual case, is priced in place
+                    if (count == batch.size) {
+                        pricer.priceWithGreeks(strategy, batch, GreeksBatch{
+                            chunk.price.data(), chunk.delta.data(), chunk.gamma.data(),
+                            chunk.theta.data(), chunk.vega.data(), chunk.rho.data()
+                        }, chunk.price.size());
+                        return;
+                    }
+
+                    subChain.clear();
+                    for (const size_t i : rows) {
+                        subChain.add(Option(batch.type[i], batch.style[i], batch.strike[i], batch.expiry[i]),
+                                     MarketData(batch.spot[i], batch.riskFreeRate[i], batch.volatility[i]));
+                    }
+                    chunk.scratch.resize(6 * count);
+                    double* s = chunk.scratch.data();
+                    const GreeksBatch out{s, s + count, s + 2 * count, s + 3 * count, s + 4 * count, s + 5 * count};
+                    pricer.priceWithGreeks(strategy, subChain.batch(), out, count);
+
+                    for (size_t k = 0; k < count; ++k) {
+                        const size_t row = rows[k];
+                        chunk.price[row] = out.price[k];
+                        chunk.delta[row] = out.delta[k];
+                        chunk.gamma[row] = out.gamma[k];
+                        chunk.theta[row] = out.theta[k];
+                        chunk.vega[row] = out.vega[k];
+                        chunk.rho[row] = out.rho[k];
+                    }
+                }
+
+                void decide(Chunk& chunk, const std::vector<size_t>& rows) {
+                    const OptionBatch batch = chunk.view;
+                    const size_t blocks = (rows.size() + DECISION_BLOCK - 1) / DECISION_BLOCK;
+
+                    // Contracts are spread over the pool, each volatility sweep runs on its task's thread
+                    pool.parallelFor(blocks, [&](size_t b) {
+                        TradingDecision trader;
+                        const size_t end = std::min(rows.size(), (b + 1) * DECISION_BLOCK);
+                        for (size_t k = b * DECISION_BLOCK; k < end; ++k) {
+                            const size_t i = rows[k];
+                            const Option option(batch.type[i], batch.style[i], batch.strike[i], batch.expiry[i]);
+                            const MarketData marketData(batch.spot[i], batch.riskFreeRate[i], batch.volatility[i]);
+                            try {
+                                const TradingDecision::Action action = trader.makeDecision(option,
+                                    option.getStyle() == Option::Style::AMERICAN ? americanStrategies : decisionStrategies,
+                                    marketData, analyzer);
+                                switch (action) {
+                                    case TradingDecision::Action::BUY: chunk.outcome[i] = Outcome::BUY; break;
+                                    case TradingDecision::Action::SELL: chunk.outcome[i] = Outcome::SELL; break;
+                                    case TradingDecision::Action::HOLD: chunk.outcome[i] = Outcome::HOLD; break;
+                                }
+                            } catch (const std::exception&) {
+                                chunk.outcome[i] = Outcome::FAILED;
+                            }
+                        }
+                    });
+                }
+
+                WorkStealingPool& pool;
+                ChainPricer pricer;
+                BlackScholesPricer blackScholes;
+                BinomialPricer binomial;
+                std::vector<std::unique_ptr<PricingStrategy>> decisionStrategies;
+                std::vector<std::unique_ptr<PricingStrategy>> americanStrategies;
+                StatisticalAnalyzer analyzer;
+                bool decisions;
+        };
+
+        size_t parseCount(const std::string& text, const std::string& flag) {
+            size_t value = 0;
+            const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+            if (result.ec != std::errc() || result.ptr != text.data() + text.size()) {
+                throw std::invalid_argument("Invalid value for " + flag + ": " + text);
+            }
+            return value;
+        }
+
+        // Stage latencies and counters as JSON, or as a table on stderr for "-", then the trace
+        void writeProfile(const Config& config) {
+            if (!config.profilePath.empty()) {
+                const Instrumentation::Snapshot snapshot = Instrumentation::snapshot();
+                if (config.profilePath == "-") {
+                    Instrumentation::writeText(snapshot, std::cerr);
+                } else {
+                    std::ofstream out(config.profilePath);
+                    Instrumentation::writeJson(snapshot, out);
+                    if (!out) {
+                        throw std::runtime_error("Cannot write profile " + config.profilePath);
+                    }
+                }
+            }
+            if (!config.tracePath.empty()) {
+                std::ofstream out(config.tracePath);
+                Instrumentation::writeChromeTrace(out);
+                if (!out) {
+                    throw std::runtime_error("Cannot write trace " + config.tracePath);
+                }
+            }
+        }
+    }
+
+    ChainReader::ChainReader(const std::string& path)
+        : path(path), file(openFile(path, "rb", stdin)), buffer(IO_BLOCK) {
+        while (tail < sizeof(RECORD_MAGIC) && fill()) {}
+        binary = tail >= sizeof(RECORD_MAGIC) &&
+                 std::memcmp(buffer.data(), RECORD_MAGIC, sizeof(RECORD_MAGIC)) == 0;
+        if (binary) {
+            head = sizeof(RECORD_MAGIC);
+        }
+    }
+
+    ChainReader::~ChainReader() {
+        if (file != stdin) {
+            std::fclose(file);
+        }
+    }
+
+    bool ChainReader::read(OptionChain& chain, size_t capacity) {
+        return binary ? readRecords(chain, capacity) : readCsv(chain, capacity);
+    }
+
+    // Moves unread bytes to the front and tops the buffer up, false if nothing was added
+    bool ChainReader::fill() {
+        if (head > 0) {
+            std::memmove(buffer.data(), buffer.data() + head, tail - head);
+            tail -= head;
+            head = 0;
+        }
+        if (atEof || tail == buffer.size()) {
+            return false;
+        }
+        const size_t got = std::fread(buffer.data() + tail, 1, buffer.size() - tail, file);
+        if (got == 0) {
+            if (std::ferror(file)) {
+                throw std::runtime_error("Failed reading " + path);
+            }
+            atEof = true;
+            return false;
+        }
+        tail += got;
+        return true;
+    }
+
+    bool ChainReader::readRecords(OptionChain& chain, size_t capacity) {
+        while (chain.size() < capacity) {
+            while (tail - head < sizeof(Record) && fill()) {}
+            if (tail - head < sizeof(Record)) {
+                if (head != tail) {
+                    throw std::runtime_error(path + ": truncated record at end of file");
+                }
+                break;
+            }
+
+            Record record;
+            std::memcpy(&record, buffer.data() + head, sizeof(Record));
+            head += sizeof(Record);
+            if ((record.type != 0 && record.type != 1) || (record.style != 0 && record.style != 1)) {
+                throw std::runtime_error(path + ": invalid type or style in record " +
+                                         std::to_string(recordsRead));
+            }
+            ++recordsRead;
+
+            chain.add(Option(record.type == 0 ? Option::Type::CALL : Option::Type::PUT,
+                             record.style == 0 ? Option::Style::EUROPEAN : Option::Style::AMERICAN,
+                             record.strike, record.expiry),
+                      MarketData(record.spot, record.rate, record.volatility));
+        }
+        return chain.size() > 0;
+    }
+
+    bool ChainReader::readCsv(OptionChain& chain, size_t capacity) {
+        const char* begin;
+        const char* end;
+        while (chain.size() < capacity && nextLine(begin, end)) {
+            if (end > begin && end[-1] == '\r') {
+                --end;
+            }
+            if (begin == end || *begin == '#') {
+                continue;
+            }
+            // Optional header, the first line with content when its first field is "type"
+            if (!sawContent) {
+                sawContent = true;
+                const char* first = begin;
+                const char* comma = static_cast<const char*>(std::memchr(begin, ',', end - begin));
+                const char* last = comma ? comma : end;
+                while (first < last && (*first == ' ' || *first == '\t')) ++first;
+                while (last > first && (last[-1] == ' ' || last[-1] == '\t')) --last;
+                if (equalsIgnoreCase(first, last, "type")) {
+                    continue;
+                }
+            }
+            parseLine(begin, end, chain);
+        }
+        return chain.size() > 0;
+    }
+
+    bool ChainReader::nextLine(const char*& begin, const char*& end) {
+        while (true) {
+            const char* start = buffer.data() + head;
+            const char* stop = buffer.data() + tail;
+            const char* newline = static_cast<const char*>(std::memchr(start, '\n', stop - start));
+            if (newline) {
+                begin = start;
+                end = newline;
+                head = newline + 1 - buffer.data();
+                ++lineNumber;
+                return true;
+            }
+            if (!fill()) {
+                if (!atEof) {
+                    throw std::runtime_error(path + ": line " + std::to_string(lineNumber + 1) +
+                                             " exceeds the read buffer");
+                }
+                if (head == tail) {
+                    return false;
+                }
+                // Last line without a trailing newline
+                begin = buffer.data() + head;
+                end = buffer.data() + tail;
+                head = tail;
+                ++lineNumber;
+                return true;
+            }
+        }
+    }
+
+    void ChainReader::parseLine(const char* begin, const char* end, OptionChain& chain) {
+        const char* fields[7][2];
+        size_t count = 0;
+        const char* cursor = begin;
+        while (count < 7) {
+            const char* comma = static_cast<const char*>(std::memchr(cursor, ',', end - cursor));
+            const char* fieldEnd = comma ? comma : end;
+            fields[count][0] = cursor;
+            fields[count][1] = fieldEnd;
+            ++count;
+            if (!comma) {
+                break;
+            }
+            cursor = comma + 1;
+        }
+        if (count != 7 || cursor != fields[6][0]) {
+            fail("expected 7 fields: type,style,strike,expiry,spot,rate,volatility");
+        }
+        for (auto& field : fields) {
+            while (field[0] < field[1] && (*field[0] == ' ' || *field[0] == '\t')) ++field[0];
+            while (field[1] > field[0] && (field[1][-1] == ' ' || field[1][-1] == '\t')) --field[1];
+        }
+
+        Option::Type type;
+        if (equalsIgnoreCase(fields[0][0], fields[0][1], "call") || equalsIgnoreCase(fields[0][0], fields[0][1], "c")) {
+            type = Option::Type::CALL;
+        } else if (equalsIgnoreCase(fields[0][0], fields[0][1], "put") || equalsIgnoreCase(fields[0][0], fields[0][1], "p")) {
+            type = Option::Type::PUT;
+        } else {
+            fail("option type must be call or put");
+        }
+
+        Option::Style style;
+        if (equalsIgnoreCase(fields[1][0], fields[1][1], "european") || equalsIgnoreCase(fields[1][0], fields[1][1], "e")) {
+            style = Option::Style::EUROPEAN;
+        } else if (equalsIgnoreCase(fields[1][0], fields[1][1], "american") || equalsIgnoreCase(fields[1][0], fields[1][1], "a")) {
+            style = Option::Style::AMERICAN;
+        } else {
+            fail("option style must be european or american");
+        }
+
+        double values[5];
+        for (int k = 0; k < 5; ++k) {
+            const char* first = fields[k + 2][0];
+            const char* last = fields[k + 2][1];
+            const auto result = std::from_chars(first, last, values[k]);
+            if (result.ec != std::errc() || result.ptr != last || first == last) {
+                fail("malformed number in field " + std::to_string(k + 3));
+            }
+        }
+
+        chain.add(Option(type, style, values[0], values[1]), MarketData(values[2], values[3], values[4]));
+    }
+
+    void ChainReader::fail(const std::string& message) const {
+        throw std::runtime_error(path + ": line " + std::to_string(lineNumber) + ": " + message);
+    }
+
+    const char* usage() {
+        return "Usage: options_pricing [--batch <input|-> [--output <file|->] [--chunk <contracts>]\n"
+               "                        [--threads <n>] [--no-decisions] [--convert <chain file>]\n"
+               "                        [--profile <file|->] [--trace <file>]]\n"
+               "Without --batch the calculator runs interactively.\n";
+    }
+
+    bool parseArguments(int argc, char** argv, Config& config) {
+        bool batch = false;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument("Missing value for " + arg);
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--batch") {
+                batch = true;
+                config.inputPath = value();
+            } else if (arg == "--output") {
+                config.outputPath = value();
+            } else if (arg == "--chunk") {
+                config.chunkSize = parseCount(value(), arg);
+            } else if (arg == "--threads") {
+                config.threads = parseCount(value(), arg);
+            } else if (arg == "--no-decisions") {
+                config.decisions = false;
+            } else if (arg == "--convert") {
+                config.convertPath = value();
+            } else if (arg == "--profile") {
+                config.profilePath = value();
+            } else if (arg == "--trace") {
+                config.tracePath = value();
+            } else {
+                throw std::invalid_argument("Unknown argument: " + arg);
+            }
+        }
+
+        if (!batch && argc > 1) {
+            throw std::invalid_argument("Batch options require --batch <input>");
+        }
+        if (config.chunkSize == 0) {
+            throw std::invalid_argument("Chunk size must be positive");
+        }
+        if (!Instrumentation::enabled() && !(config.profilePath.empty() && config.tracePath.empty())) {
+            throw std::invalid_argument("--profile and --trace need a build with OPTIONS_INSTRUMENTATION enabled");
+        }
+        return batch;
+    }
+
+    Summary run(const Config& config) {
+        if (config.chunkSize == 0) {
+            throw std::invalid_argument("Chunk size must be positive");
+        }
+        const auto start = std::chrono::steady_clock::now();
+
+        if (!config.convertPath.empty()) {
+            const size_t count = ChainFile::convert(config.inputPath, config.convertPath);
+            return Summary{count, 0, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+        }
+
+        // The profile covers this run only
+        const bool profiling = !(config.profilePath.empty() && config.tracePath.empty());
+        if (profiling) {
+            Instrumentation::reset();
+        }
+        if (!config.tracePath.empty()) {
+            Instrumentation::startTrace();
+        }
+
+        // Columnar files are mapped and sliced in place, anything else is parsed into the chunks
+        std::unique_ptr<ChainFile::MappedChain> mapped;
+        std::unique_ptr<ChainReader> reader;
+        if (config.inputPath != "-" && ChainFile::isChainFile(config.inputPath)) {
+            mapped = std::make_unique<ChainFile::MappedChain>(config.inputPath);
+        } else {
+            reader = std::make_unique<ChainReader>(config.inputPath);
+        }
+        ResultWriter writer(config.outputPath);
+        WorkStealingPool pool(config.threads);
+        PricingStage stage(pool, config.decisions);
+
+        // A fixed set of chunks cycles empty -> filled -> priced -> empty
+        std::vector<Chunk> chunks(PIPELINE_DEPTH);
+        ChunkQueue empty, filled, priced;
+        for (Chunk& chunk : chunks) {
+            if (reader) {
+                chunk.chain.reserve(config.chunkSize);
+            }
+            empty.push(&chunk);
+        }
+
+        Summary summary{0, 0, 0.0};
+        std::exception_ptr readError, priceError, writeError;
+        auto abort = [&] {
+            empty.close();
+            filled.close();
+            priced.close();
+        };
+
+        std::thread readThread([&] {
+            try {
+                size_t row = 0;
+                Chunk* chunk;
+                while (empty.pop(chunk)) {
+                    OPTIONS_TIME_SCOPE(BATCH_READ);
+                    chunk->firstRow = row;
+                    if (mapped) {
+                        if (row >= mapped->size()) {
+                            break;
+                        }
+                        const size_t end = std::min(mapped->size(), row + config.chunkSize);
+                        mapped->verify(row, end);
+                        chunk->view = mapped->batch().slice(row, end);
+                    } else {
+                        chunk->chain.clear();
+                        if (!reader->read(chunk->chain, config.chunkSize)) {
+                            break;
+                        }
+                        chunk->view = chunk->chain.batch();
+                    }
+                    row += chunk->view.size;
+                    filled.push(chunk);
+                }
+            } catch (...) {
+                readError = std::current_exception();
+                abort();
+            }
+            filled.close();
+        });
+
+        std::thread writeThread([&] {
+            try {
+                Chunk* chunk;
+                while (priced.pop(chunk)) {
+                    OPTIONS_TIME_SCOPE(BATCH_WRITE);
+                    summary.contracts += chunk->view.size;
+                    summary.errors += writer.write(*chunk);
+                    empty.push(chunk);
+                }
+                writer.finish();
+            } catch (...) {
+                writeError = std::current_exception();
+                abort();
+            }
+        });
+
+        try {
+            Chunk* chunk;
+            while (filled.pop(chunk)) {
+                {
+                    OPTIONS_TIME_SCOPE(BATCH_PRICE);
+                    stage.process(*chunk);
+                }
+                priced.push(chunk);
+            }
+        } catch (...) {
+            priceError = std::current_exception();
+            abort();
+        }
+        priced.close();
+
+        readThread.join();
+        writeThread.join();
+
+        for (const auto& error : {readError, priceError, writeError}) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (profiling) {
+            Instrumentation::stopTrace();
+            writeProfile(config);
+        }
+        return summary;
+    }
+
+    void writeRecordFile(const std::string& path, const OptionChain& chain) {
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+        }
+
+        const OptionBatch batch = chain.batch();
+        bool ok = std::fwrite(RECORD_MAGIC, 1, sizeof(RECORD_MAGIC), file) == sizeof(RECORD_MAGIC);
+        for (size_t i = 0; ok && i < batch.size; ++i) {
+            const Record record{
+                batch.type[i] == Option::Type::CALL ? 0 : 1,
+                batch.style[i] == Option::Style::EUROPEAN ? 0 : 1,
+                batch.strike[i], batch.expiry[i], batch.spot[i], batch.riskFreeRate[i], batch.volatility[i]
+            };
+            ok = std::fwrite(&record, sizeof(Record), 1, file) == 1;
+        }
+
+        if (std::fclose(file) != 0 || !ok) {
+            throw std::runtime_error("Failed writing " + path);
+        }
+    }
+}
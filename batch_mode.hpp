@@ -0,0 +1,93 @@
+#pragma once
+
+#include "options_classes.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Non-interactive batch mode: streams a chain file through the pricers in fixed-size chunks
+//
+// Input is either CSV with one contract per line
+//     type,style,strike,expiry,spot,rate,volatility     (e.g. call,european,100,1,100,0.05,0.2)
+// a packed record file (RECORD_MAGIC followed by Record structs), or a columnar chain file
+// (chain_file.hpp) which is memory-mapped and priced in place. The format is detected from
+// the first bytes, "-" reads stdin. Output is CSV
+//     row,price,delta,gamma,theta,vega,rho,action
+// Reading, pricing and writing run on separate threads over a fixed set of recycled chunks,
+// so memory stays bounded whatever the file size
+namespace BatchMode {
+    struct Config {
+        std::string inputPath;
+        std::string outputPath = "-";  // "-" = stdout
+        size_t chunkSize = 16384;      // contracts per chunk
+        size_t threads = 0;            // pricing threads, 0 = hardware concurrency
+        bool decisions = true;         // run TradingDecision per contract, Americans through the screening path
+        std::string convertPath;       // when set, write the input as a columnar chain file instead of pricing
+        std::string profilePath;       // stage latency snapshot as JSON, "-" = table on stderr (instrumented builds)
+        std::string tracePath;         // Chrome trace of every timed scope (instrumented builds)
+    };
+
+    struct Summary {
+        size_t contracts;
+        size_t errors;   // rows rejected by validation or pricing
+        double seconds;
+    };
+
+    // Packed binary row, native byte order
+    struct Record {
+        int32_t type;   // 0 = call, 1 = put
+        int32_t style;  // 0 = european, 1 = american
+        double strike;
+        double expiry;
+        double spot;
+        double rate;
+        double volatility;
+    };
+    static_assert(sizeof(Record) == 48, "Record must stay packed at 48 bytes");
+
+    constexpr char RECORD_MAGIC[8] = {'O', 'P', 'T', 'R', 'E', 'C', '0', '1'};
+
+    // Streams contracts from a CSV or packed record file with bounded memory
+    class ChainReader {
+        public:
+            explicit ChainReader(const std::string& path);  // "-" = stdin
+            ~ChainReader();
+
+            ChainReader(const ChainReader&) = delete;
+            ChainReader& operator=(const ChainReader&) = delete;
+
+            // Appends up to capacity contracts to chain, false once the input is exhausted
+            bool read(OptionChain& chain, size_t capacity);
+
+        private:
+            bool fill();
+            bool readRecords(OptionChain& chain, size_t capacity);
+            bool readCsv(OptionChain& chain, size_t capacity);
+            bool nextLine(const char*& begin, const char*& end);
+            void parseLine(const char* begin, const char* end, OptionChain& chain);
+            [[noreturn]] void fail(const std::string& message) const;
+
+            std::string path;
+            FILE* file;
+            std::vector<char> buffer;
+            size_t head = 0;  // first unread byte
+            size_t tail = 0;  // one past the last buffered byte
+            bool atEof = false;
+            bool binary = false;
+            size_t lineNumber = 0;
+            size_t recordsRead = 0;
+            bool sawContent = false;  // a CSV line other than a blank or comment has been read
+    };
+
+    // Fills config from --batch style arguments. Returns false when batch mode was not requested,
+    // throws std::invalid_argument on malformed flags
+    bool parseArguments(int argc, char** argv, Config& config);
+    const char* usage();
+
+    Summary run(const Config& config);
+
+    // Writes a chain as a packed record file
+    void writeRecordFile(const std::string& path, const OptionChain& chain);
+}
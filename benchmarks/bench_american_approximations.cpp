@@ -0,0 +1,94 @@
+// Closed-form American approximations vs the binomial tree, per contract and inside TradingDecision
+#include "bench_common.hpp"
+#include "../american_approximations.hpp"
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    const size_t contracts = argc > 1 ? std::stoul(argv[1]) : 2000;
+    const OptionChain chain = Bench::makeChain(contracts, Option::Style::AMERICAN);
+    const OptionBatch batch = chain.batch();
+
+    // Reference: Leisen-Reimer with Richardson at 2001 steps, well inside the approximations' error
+    BinomialSettings fine;
+    fine.scheme = BinomialSettings::Scheme::LEISEN_REIMER;
+    fine.richardson = true;
+    fine.steps = 2001;
+    BinomialPricer reference(fine);
+    std::vector<double> exact(contracts);
+    reference.calculatePrices(batch, exact.data(), contracts);
+
+    BinomialPricer binomial;
+    BaroneAdesiWhaleyPricer baroneAdesiWhaley;
+    BjerksundStenslandPricer bjerksundStensland;
+
+    std::cout << "=== " << contracts << " American contracts, error vs Leisen-Reimer 2001-step tree ===\n";
+    std::cout << std::left << std::setw(24) << "Method" << std::setw(18) << "Latency (us)"
+              << std::setw(14) << "RMS error" << "Max error\n";
+    for (PricingStrategy* strategy : std::initializer_list<PricingStrategy*>{&binomial, &baroneAdesiWhaley, &bjerksundStensland}) {
+        std::vector<double> prices(contracts);
+        const double seconds = Bench::bestTime([&] { strategy->calculatePrices(batch, prices.data(), contracts); }, 3);
+        double sumSquares = 0.0, maxError = 0.0;
+        for (size_t i = 0; i < contracts; ++i) {
+            const double error = std::abs(prices[i] - exact[i]);
+            sumSquares += error * error;
+            maxError = std::max(maxError, error);
+        }
+        std::cout << std::left << std::setw(24) << strategy->getStrategyName() << std::fixed << std::setprecision(3)
+                  << std::setw(18) << seconds * 1e6 / contracts << std::scientific << std::setprecision(2)
+                  << std::setw(14) << std::sqrt(sumSquares / contracts) << maxError << "\n";
+    }
+
+    // Decisions: the approximation against the tree on every contract, vs screening on the two
+    // approximations and falling back to that pair unless the screened action is clear
+    std::vector<std::unique_ptr<PricingStrategy>> strategies;
+    strategies.push_back(std::make_unique<BjerksundStenslandPricer>());
+    strategies.push_back(std::make_unique<BinomialPricer>());
+    std::vector<std::unique_ptr<PricingStrategy>> screeners;
+    screeners.push_back(std::make_unique<BjerksundStenslandPricer>());
+    screeners.push_back(std::make_unique<BaroneAdesiWhaleyPricer>());
+
+    const size_t decisions = std::min<size_t>(contracts, 200);
+    const StatisticalAnalyzer analyzer;
+    TradingDecision trader;
+    std::vector<TradingDecision::Action> full(decisions), screened(decisions);
+    size_t refined = 0;
+
+    const double fullSeconds = Bench::bestTime([&] {
+        for (size_t i = 0; i < decisions; ++i) {
+            const Option option(batch.type[i], batch.style[i], batch.strike[i], batch.expiry[i]);
+            const MarketData marketData(batch.spot[i], batch.riskFreeRate[i], batch.volatility[i]);
+            full[i] = trader.evaluate(option, strategies, marketData, analyzer).action;
+        }
+    }, 1);
+    const double screenSeconds = Bench::bestTime([&] {
+        refined = 0;
+        for (size_t i = 0; i < decisions; ++i) {
+            const Option option(batch.type[i], batch.style[i], batch.strike[i], batch.expiry[i]);
+            const MarketData marketData(batch.spot[i], batch.riskFreeRate[i], batch.volatility[i]);
+            const TradingDecision::Decision decision = trader.screen(option, screeners, strategies, marketData, analyzer);
+            screened[i] = decision.action;
+            refined += decision.refined;
+        }
+    }, 3);
+
+    // Hit rate is the share of contracts decided without the tree, agreement is reported per type
+    size_t agree[2] = {0, 0}, total[2] = {0, 0};
+    for (size_t i = 0; i < decisions; ++i) {
+        const int isCall = batch.type[i] == Option::Type::CALL;
+        agree[isCall] += full[i] == screened[i];
+        ++total[isCall];
+    }
+    std::cout << "\n=== Decision latency per American contract, " << decisions << " contracts ===\n";
+    std::cout << std::left << std::setw(24) << "Path" << "Latency (us)\n" << std::fixed << std::setprecision(2)
+              << std::setw(24) << "evaluate (with tree)" << fullSeconds * 1e6 / decisions << "\n"
+              << std::setw(24) << "screen" << screenSeconds * 1e6 / decisions << "\n"
+              << "Speedup " << fullSeconds / screenSeconds << "x, kept without the tree on " << decisions - refined
+              << "/" << decisions << " (" << 100.0 * (decisions - refined) / decisions << "%)\n"
+              << "Actions agree on " << agree[0] << "/" << total[0] << " puts and " << agree[1] << "/" << total[1] << " calls\n";
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+// Batch mode end to end: CSV vs packed records, prices and Greeks without decisions, output discarded
+#include "bench_common.hpp"
+#include "../batch_mode.hpp"
+#include <cstdio>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+namespace {
+    void writeCsv(const std::string& path, const OptionChain& chain) {
+        FILE* file = std::fopen(path.c_str(), "w");
+        const OptionBatch batch = chain.batch();
+        std::fprintf(file, "type,style,strike,expiry,spot,rate,volatility\n");
+        for (size_t i = 0; i < batch.size; ++i) {
+            std::fprintf(file, "%s,%s,%.10g,%.10g,%.10g,%.10g,%.10g\n",
+                         batch.type[i] == Option::Type::CALL ? "call" : "put",
+                         batch.style[i] == Option::Style::EUROPEAN ? "european" : "american",
+                         batch.strike[i], batch.expiry[i], batch.spot[i], batch.riskFreeRate[i], batch.volatility[i]);
+        }
+        std::fclose(file);
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t contracts = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const OptionChain chain = Bench::makeChain(contracts, Option::Style::EUROPEAN);
+
+    const std::string csvPath = "bench_batch_input.csv";
+    const std::string binaryPath = "bench_batch_input.bin";
+    writeCsv(csvPath, chain);
+    BatchMode::writeRecordFile(binaryPath, chain);
+
+    std::cout << "=== Batch mode, " << contracts << " European contracts, prices + Greeks ===\n";
+    std::cout << std::left << std::setw(16) << "Input" << "Mopts/sec\n";
+    for (const std::string& path : {csvPath, binaryPath}) {
+        BatchMode::Config config;
+        config.inputPath = path;
+        config.outputPath = "/dev/null";
+        config.decisions = false;
+        const double seconds = Bench::bestTime([&] { BatchMode::run(config); }, 3);
+        std::cout << std::left << std::setw(16) << (path == csvPath ? "CSV" : "Packed records")
+                  << std::fixed << std::setprecision(2) << contracts / seconds / 1e6 << "\n";
+    }
+
+    std::remove(csvPath.c_str());
+    std::remove(binaryPath.c_str());
+    return 0;
+}
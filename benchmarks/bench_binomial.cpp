@@ -0,0 +1,161 @@
+// Binomial lattice latency: the original pow-per-node implementation vs the table-driven engine,
+// then the error and latency of each lattice scheme
+#include "bench_common.hpp"
+#include "../lattice_engine.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace {
+    // Original BinomialPricer::calculatePrice, kept as the baseline
+    double legacyBinomial(const Option& option, const MarketData& marketData) {
+        const double S = marketData.getSpot();
+        const double K = option.getStrike();
+        const double r = marketData.getRiskFreeRate();
+        const double sigma = marketData.getVolatility();
+        const double T = option.getExpiry();
+
+        const int N = static_cast<int>(std::min(1000.0, std::max(100.0, T * 365)));
+        const double dt = T/N;
+        const double u = exp(sigma * sqrt(dt));
+        const double d = 1.0/u;
+        const double p = (exp(r * dt) - d)/(u - d);
+        const double discount = exp(-r * dt);
+
+        std::vector<double> values(N + 1);
+        const bool isCall = option.getType() == Option::Type::CALL;
+        for (int j = 0; j <= N; ++j) {
+            double spot = S * pow(u, j) * pow(d, N-j);
+            values[j] = isCall ? std::max(0.0, spot - K) : std::max(0.0, K - spot);
+        }
+        for (int i = N-1; i >= 0; --i) {
+            for (int j = 0; j <= i; ++j) {
+                double holding_value = discount * (p * values[j+1] + (1-p) * values[j]);
+                if (option.getStyle() == Option::Style::AMERICAN) {
+                    double spot = S * pow(u, j) * pow(d, i-j);
+                    double exercise_value = isCall ? std::max(0.0, spot - K) : std::max(0.0, K - spot);
+                    values[j] = std::max(holding_value, exercise_value);
+                } else {
+                    values[j] = holding_value;
+                }
+            }
+        }
+        return values[0];
+    }
+
+    double crrTree(const Option& option, const MarketData& marketData, int steps) {
+        const Lattice::Geometry geometry = Lattice::crrGeometry(marketData.getRiskFreeRate(), marketData.getVolatility(),
+                                                                option.getExpiry(), steps);
+        Lattice::Arena& arena = Lattice::threadArena();
+        arena.reset(Lattice::tableSize(steps) + steps + 1);
+        const double* spots = Lattice::buildSpots(marketData.getSpot(), geometry, arena);
+        return Payoff::dispatch(option.getType(), option.getStyle(), [&](auto type, auto style) {
+            Lattice::Lane lane{geometry, Lattice::buildExercise<decltype(type)::value>(spots, steps, option.getStrike(), arena),
+                               arena.take(steps + 1)};
+            Lattice::sweep<decltype(style)::value>(&lane, 1);
+            return lane.values[0];
+        });
+    }
+}
+
+int main() {
+    BinomialPricer pricer;
+    const MarketData marketData(100.0, 0.05, 0.2);
+
+    std::cout << "=== Binomial latency per contract ===\n";
+    std::cout << std::left << std::setw(10) << "Style" << std::setw(8) << "N"
+              << std::setw(16) << "Legacy (us)" << std::setw(16) << "Engine (us)"
+              << std::setw(10) << "Speedup" << "|diff|\n";
+
+    for (Option::Style style : {Option::Style::AMERICAN, Option::Style::EUROPEAN}) {
+        for (int steps : {100, 500, 1000}) {
+            // Expiry chosen so the adaptive step rule lands exactly on N
+            const Option option(Option::Type::PUT, style, 100.0, steps / 365.0);
+            const int calls = 200000 / steps;
+
+            double legacyPrice = 0.0, enginePrice = 0.0;
+            const double legacy = Bench::bestTime([&] {
+                for (int k = 0; k < calls; ++k) legacyPrice = legacyBinomial(option, marketData);
+            }) / calls;
+            const double engine = Bench::bestTime([&] {
+                for (int k = 0; k < calls; ++k) enginePrice = pricer.calculatePrice(option, marketData);
+            }) / calls;
+
+            std::cout << std::left << std::setw(10) << (style == Option::Style::AMERICAN ? "American" : "European")
+                      << std::setw(8) << steps << std::fixed << std::setprecision(2)
+                      << std::setw(16) << legacy * 1e6 << std::setw(16) << engine * 1e6
+                      << std::setw(10) << legacy / engine << std::scientific << std::setprecision(1)
+                      << std::abs(legacyPrice - enginePrice) << "\n";
+        }
+    }
+
+    // Puts around the money, European against Black-Scholes and American against 10000-step
+    // trees averaged with their neighbour and extrapolated against 5000 steps
+    std::vector<std::pair<Option, MarketData>> contracts;
+    std::vector<double> references;
+    for (Option::Style style : {Option::Style::EUROPEAN, Option::Style::AMERICAN}) {
+        for (double strike : {90.0, 100.0, 110.0}) {
+            for (double expiry : {0.25, 1.0, 3.0}) {
+                for (double vol : {0.2, 0.4}) {
+                    const Option option(Option::Type::PUT, style, strike, expiry);
+                    const MarketData data(100.0, 0.05, vol);
+                    contracts.emplace_back(option, data);
+                    if (style == Option::Style::EUROPEAN) {
+                        references.push_back(BlackScholesPricer(false).calculatePrice(option, data));
+                    } else {
+                        auto smoothed = [&](int steps) {
+                            return 0.5 * (crrTree(option, data, steps) + crrTree(option, data, steps + 1));
+                        };
+                        references.push_back(2.0 * smoothed(10000) - smoothed(5000));
+                    }
+                }
+            }
+        }
+    }
+    const size_t half = contracts.size() / 2;
+
+    std::cout << "\n=== Lattice schemes, " << half << " European and " << half << " American puts ===\n";
+    std::cout << std::left << std::setw(30) << "Scheme" << std::setw(10) << "Mean N" << std::setw(14) << "Latency (us)"
+              << std::setw(16) << "Max err (Eur)" << "Max err (Amer)\n";
+
+    using Scheme = BinomialSettings::Scheme;
+    auto report = [&](const std::string& name, const BinomialSettings& settings) {
+        BinomialPricer schemePricer(settings);
+        std::vector<double> prices(contracts.size());
+        const double seconds = Bench::bestTime([&] {
+            for (size_t i = 0; i < contracts.size(); ++i) {
+                prices[i] = schemePricer.calculatePrice(contracts[i].first, contracts[i].second);
+            }
+        }, 3) / contracts.size();
+
+        double steps = 0.0, europeanError = 0.0, americanError = 0.0;
+        for (size_t i = 0; i < contracts.size(); ++i) {
+            steps += schemePricer.selectSteps(contracts[i].first, contracts[i].second);
+            double& worst = i < half ? europeanError : americanError;
+            worst = std::max(worst, std::abs(prices[i] - references[i]));
+        }
+        std::cout << std::left << std::setw(30) << name << std::fixed << std::setprecision(0) << std::setw(10)
+                  << steps / contracts.size() << std::setprecision(2) << std::setw(14) << seconds * 1e6
+                  << std::scientific << std::setprecision(2) << std::setw(16) << europeanError << americanError << "\n";
+    };
+
+    auto settingsFor = [](Scheme scheme, bool richardson, int steps, double tolerance = 0.0) {
+        BinomialSettings settings;
+        settings.scheme = scheme;
+        settings.richardson = richardson;
+        settings.steps = steps;
+        settings.tolerance = tolerance;
+        return settings;
+    };
+    report("CRR, expiry rule (default)", BinomialSettings());
+    report("CRR N=1000", settingsFor(Scheme::CRR, false, 1000));
+    report("Smoothed N=100", settingsFor(Scheme::SMOOTHED, false, 100));
+    report("Smoothed + Richardson N=100", settingsFor(Scheme::SMOOTHED, true, 100));
+    report("Leisen-Reimer N=101", settingsFor(Scheme::LEISEN_REIMER, false, 101));
+    report("LR + Richardson N=101", settingsFor(Scheme::LEISEN_REIMER, true, 101));
+    report("LR + Richardson, tol 1e-2", settingsFor(Scheme::LEISEN_REIMER, true, 0, 1e-2));
+    report("LR + Richardson, tol 1e-3", settingsFor(Scheme::LEISEN_REIMER, true, 0, 1e-3));
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+// Black-Scholes chain throughput: per-contract scalar calls vs the vectorized batch kernels, prices and Greeks
+#include "bench_common.hpp"
+#include "../simd_kernels.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+int main() {
+    const size_t n = 1 << 20;
+    const OptionChain chain = Bench::makeChain(n, Option::Style::EUROPEAN);
+    const OptionBatch batch = chain.batch();
+
+    std::vector<double> reference(n), prices(n);
+    BlackScholesPricer scalar(false);
+
+    std::cout << "=== Black-Scholes throughput (" << n << " contracts) ===\n";
+    std::cout << std::left << std::setw(28) << "Kernel" << std::setw(16) << "Mopts/sec"
+              << "Max |diff| vs scalar\n";
+
+    auto report = [&](const char* name, double seconds, double maxDiff) {
+        std::cout << std::left << std::setw(28) << name << std::setw(16) << std::fixed << std::setprecision(2)
+                  << (n / seconds / 1e6) << std::scientific << std::setprecision(2) << maxDiff << "\n";
+    };
+
+    // Current scalar path, one virtual call per contract
+    const double perCall = Bench::bestTime([&] {
+        for (size_t i = 0; i < n; ++i) {
+            const Option option(batch.type[i], batch.style[i], batch.strike[i], batch.expiry[i]);
+            const MarketData marketData(batch.spot[i], batch.riskFreeRate[i], batch.volatility[i]);
+            reference[i] = scalar.calculatePrice(option, marketData);
+        }
+    });
+    report("calculatePrice (scalar)", perCall, 0.0);
+
+    const double scalarBatch = Bench::bestTime([&] { scalar.calculatePrices(batch, prices.data(), n); });
+    report("calculatePrices (scalar)", scalarBatch, 0.0);
+
+    for (Simd::Isa isa : {Simd::Isa::AVX2, Simd::Isa::AVX512}) {
+        if (!Simd::isSupported(isa)) {
+            std::cout << std::left << std::setw(28) << Simd::isaName(isa) << "not supported on this CPU\n";
+            continue;
+        }
+        const double seconds = Bench::bestTime([&] { Simd::blackScholesBatch(isa, batch, prices.data()); });
+        double maxDiff = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            maxDiff = std::max(maxDiff, std::abs(prices[i] - reference[i]));
+        }
+        report(Simd::isaName(isa), seconds, maxDiff);
+    }
+
+    // Risk pass: price plus all five Greeks per contract
+    std::vector<double> delta(n), gamma(n), theta(n), vega(n), rho(n);
+    const GreeksBatch greeks{prices.data(), delta.data(), gamma.data(), theta.data(), vega.data(), rho.data()};
+    BlackScholesPricer vectorized;
+
+    std::cout << "\n=== Price + Greeks throughput ===\n";
+    const double scalarGreeks = Bench::bestTime([&] { scalar.calculatePricesAndGreeks(batch, greeks, n); });
+    report("Greeks batch (scalar)", scalarGreeks, 0.0);
+    const double simdGreeks = Bench::bestTime([&] { vectorized.calculatePricesAndGreeks(batch, greeks, n); });
+    double maxDiff = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        maxDiff = std::max(maxDiff, std::abs(prices[i] - reference[i]));
+    }
+    report("Greeks batch (vectorized)", simdGreeks, maxDiff);
+
+    return 0;
+}
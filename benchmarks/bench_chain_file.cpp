@@ -0,0 +1,71 @@
+// Chain load time: CSV parse and packed records vs mapping a columnar chain file, then pricing from the mapping
+#include "bench_common.hpp"
+#include "../batch_mode.hpp"
+#include "../chain_file.hpp"
+#include <cstdio>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace {
+    void writeCsv(const std::string& path, const OptionChain& chain) {
+        FILE* file = std::fopen(path.c_str(), "w");
+        const OptionBatch batch = chain.batch();
+        for (size_t i = 0; i < batch.size; ++i) {
+            std::fprintf(file, "%s,%s,%.17g,%.17g,%.17g,%.17g,%.17g\n",
+                         batch.type[i] == Option::Type::CALL ? "call" : "put",
+                         batch.style[i] == Option::Style::EUROPEAN ? "european" : "american",
+                         batch.strike[i], batch.expiry[i], batch.spot[i], batch.riskFreeRate[i], batch.volatility[i]);
+        }
+        std::fclose(file);
+    }
+
+    // Streams the whole file through a ChainReader, the way a text loader fills a chain
+    size_t load(const std::string& path) {
+        BatchMode::ChainReader reader(path);
+        OptionChain chain;
+        size_t count = 0;
+        while (reader.read(chain, 65536)) {
+            count += chain.size();
+            chain.clear();
+        }
+        return count;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t contracts = argc > 1 ? std::stoul(argv[1]) : 10000000;
+    const std::string csvPath = "bench_chain_file.csv";
+    const std::string recordPath = "bench_chain_file.bin";
+    const std::string chainPath = "bench_chain_file.chain";
+    {
+        const OptionChain chain = Bench::makeChain(contracts, Option::Style::EUROPEAN);
+        writeCsv(csvPath, chain);
+        BatchMode::writeRecordFile(recordPath, chain);
+        ChainFile::write(chainPath, chain.batch());
+    }
+
+    std::cout << "=== Loading " << contracts << " contracts (ms) ===\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::left << std::setw(28) << "CSV parse" << Bench::bestTime([&] { load(csvPath); }, 3) * 1e3 << "\n";
+    std::cout << std::left << std::setw(28) << "Packed records" << Bench::bestTime([&] { load(recordPath); }, 3) * 1e3 << "\n";
+    std::cout << std::left << std::setw(28) << "Columnar mmap open"
+              << Bench::bestTime([&] { ChainFile::MappedChain mapped(chainPath); }, 3) * 1e3 << "\n";
+
+    ChainFile::MappedChain mapped(chainPath);
+    std::cout << std::left << std::setw(28) << "Columnar full verify"
+              << Bench::bestTime([&] { mapped.verify(); }, 3) * 1e3 << "\n";
+
+    // Prices come straight out of the mapped columns
+    BlackScholesPricer pricer;
+    std::vector<double> prices(mapped.size());
+    const double seconds = Bench::bestTime([&] { pricer.calculatePrices(mapped.batch(), prices.data(), prices.size()); }, 3);
+    std::cout << "\nBlack-Scholes from the mapping: " << std::setprecision(2)
+              << mapped.size() / seconds / 1e6 << " Mopts/sec\n";
+
+    std::remove(csvPath.c_str());
+    std::remove(recordPath.c_str());
+    std::remove(chainPath.c_str());
+    return 0;
+}
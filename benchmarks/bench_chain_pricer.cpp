@@ -0,0 +1,123 @@
+// ChainPricer scaling from 1 to N threads, with a bit-identical check against the 1-thread run, then
+// tiled Greeks against the single-contract ones with Carry rows (exit code 1 when they differ)
+#include "bench_common.hpp"
+#include "../chain_pricer.hpp"
+#include "../finite_difference.hpp"
+#include "../monte_carlo.hpp"
+#include "../term_structure.hpp"
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    void scale(const char* name, PricingStrategy& strategy, const OptionChain& chain, size_t maxThreads) {
+        const OptionBatch batch = chain.batch();
+        std::vector<double> reference(chain.size()), prices(chain.size());
+
+        std::cout << "\n" << name << " (" << chain.size() << " contracts)\n";
+        std::cout << std::left << std::setw(10) << "Threads" << std::setw(16) << "Kopts/sec"
+                  << std::setw(10) << "Speedup" << "Identical\n";
+
+        double baseline = 0.0;
+        for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+            WorkStealingPool pool(threads);
+            ChainPricer pricer(pool);
+            double* out = threads == 1 ? reference.data() : prices.data();
+            const double seconds = Bench::bestTime([&] { pricer.price(strategy, batch, out, chain.size()); }, 3);
+            if (threads == 1) {
+                baseline = seconds;
+            }
+
+            const bool identical = threads == 1 ||
+                std::memcmp(reference.data(), prices.data(), prices.size() * sizeof(double)) == 0;
+            std::cout << std::left << std::setw(10) << threads << std::fixed << std::setprecision(1)
+                      << std::setw(16) << chain.size() / seconds / 1e3 << std::setprecision(2)
+                      << std::setw(10) << baseline / seconds << (identical ? "yes" : "NO") << "\n";
+        }
+    }
+
+    // Every third row carries a dividend curve with a yield, in carryStyle, the rest are flat
+    struct ParityChain {
+        OptionChain chain;
+        std::vector<Option> options;
+        std::vector<MarketData> marketData;
+    };
+
+    ParityChain makeParityChain(size_t n, Option::Style flatStyle, Option::Style carryStyle) {
+        YieldCurve curve({0.25, 0.5, 1.0, 2.0}, {0.020, 0.024, 0.030, 0.035});
+        const auto carry = std::make_shared<const Carry>(curve, std::vector<Dividend>{{0.3, 0.8}, {0.8, 0.8}}, 0.01);
+        std::mt19937_64 rng(11);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        ParityChain parity;
+        for (size_t i = 0; i < n; ++i) {
+            const bool carried = i % 3 == 0;
+            const Option option(uniform(rng) < 0.5 ? Option::Type::CALL : Option::Type::PUT,
+                                carried ? carryStyle : flatStyle,
+                                100.0 * std::exp(uniform(rng) - 0.5), 0.1 + uniform(rng) * 1.4);
+            const MarketData base(100.0, 0.01 + uniform(rng) * 0.05, 0.1 + uniform(rng) * 0.4);
+            parity.options.push_back(option);
+            parity.marketData.push_back(carried ? base.withCarry(carry) : base);
+            parity.chain.add(option, parity.marketData.back());
+        }
+        return parity;
+    }
+
+    // Largest gap between priceWithGreeks over small tiles and calculatePriceAndGreeks per contract
+    double greeksGap(WorkStealingPool& pool, PricingStrategy& strategy, const ParityChain& parity) {
+        const size_t n = parity.chain.size();
+        std::vector<double> columns(6 * n);
+        double* c = columns.data();
+        ChainPricer(pool, 8).priceWithGreeks(strategy, parity.chain.batch(),
+                                             GreeksBatch{c, c + n, c + 2 * n, c + 3 * n, c + 4 * n, c + 5 * n}, n);
+        double gap = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            const PriceWithGreeks scalar = strategy.calculatePriceAndGreeks(parity.options[i], parity.marketData[i]);
+            const double expected[6] = {scalar.price, scalar.greeks.delta, scalar.greeks.gamma,
+                                        scalar.greeks.theta, scalar.greeks.vega, scalar.greeks.rho};
+            for (int g = 0; g < 6; ++g) {
+                gap = std::max(gap, std::abs(c[g * n + i] - expected[g]));
+            }
+        }
+        return gap;
+    }
+}
+
+int main(int argc, char** argv) {
+    // Optional argument overrides the thread ceiling, default is the hardware concurrency
+    const size_t maxThreads = argc > 1 ? std::stoul(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "=== ChainPricer scaling, up to " << maxThreads << " threads ===\n";
+
+    BlackScholesPricer blackScholes;
+    scale("Black-Scholes, European", blackScholes, Bench::makeChain(200000, Option::Style::EUROPEAN), maxThreads);
+
+    // Expiries up to 3 years give trees from 100 to 1000 steps, so tile costs vary widely
+    BinomialPricer binomial;
+    scale("Binomial, American", binomial, Bench::makeChain(2000, Option::Style::AMERICAN, 7, 3.0), maxThreads);
+
+    // The finite-difference grid rejects American rows under a non-flat Carry, so its carried rows
+    // are European. Monte Carlo prices European contracts only. Its bumped Greeks divide the round
+    // trip of a Carry row's spot through the prepaid forward by 1e-4 bumps, hence the tolerance
+    std::cout << "\n=== Tiled vs single-contract Greeks with Carry rows, max |diff| ===\n";
+    WorkStealingPool pool(std::min<size_t>(maxThreads, 4));
+    FiniteDifferencePricer finiteDifference;
+    MonteCarloSettings simulation;
+    simulation.paths = 4096;
+    MonteCarloPricer monteCarlo(simulation);
+    bool matched = true;
+    const auto check = [&](const char* name, PricingStrategy& strategy, Option::Style flatStyle, Option::Style carryStyle) {
+        const double gap = greeksGap(pool, strategy, makeParityChain(40, flatStyle, carryStyle));
+        matched = matched && gap <= 1e-7;
+        std::cout << std::left << std::setw(22) << name << std::scientific << std::setprecision(2) << gap
+                  << std::fixed << (gap <= 1e-7 ? "" : "  MISMATCH") << "\n";
+    };
+    check("Binomial", binomial, Option::Style::AMERICAN, Option::Style::AMERICAN);
+    check("Finite difference", finiteDifference, Option::Style::AMERICAN, Option::Style::EUROPEAN);
+    check("Monte Carlo", monteCarlo, Option::Style::EUROPEAN, Option::Style::EUROPEAN);
+
+    return matched ? 0 : 1;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../options_classes.hpp"
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+// Small helpers shared by the standalone benchmark programs
+namespace Bench {
+    // Best-of-N wall time in seconds, each repetition runs fn once
+    template <typename Fn>
+    double bestTime(Fn&& fn, int repetitions = 5) {
+        double best = 1e300;
+        for (int rep = 0; rep < repetitions; ++rep) {
+            const auto start = std::chrono::steady_clock::now();
+            fn();
+            const auto stop = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(stop - start).count());
+        }
+        return best;
+    }
+
+    // Reproducible synthetic chain around a single spot, strikes spread +-50% in log space
+    inline OptionChain makeChain(size_t n, Option::Style style, unsigned seed = 42,
+                                 double maxExpiry = 2.0) {
+        std::mt19937_64 rng(seed);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+        OptionChain chain;
+        chain.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            const double spot = 100.0;
+            const double strike = spot * std::exp(uniform(rng) - 0.5);
+            const double expiry = 0.05 + uniform(rng) * (maxExpiry - 0.05);
+            const Option::Type type = uniform(rng) < 0.5 ? Option::Type::CALL : Option::Type::PUT;
+            chain.add(Option(type, style, strike, expiry),
+                      MarketData(spot, 0.01 + uniform(rng) * 0.05, 0.1 + uniform(rng) * 0.5));
+        }
+        return chain;
+    }
+}
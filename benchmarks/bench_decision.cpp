@@ -0,0 +1,64 @@
+// Decision latency: the old serial sweep priced twice (makeDecision + main's re-run) vs TradingDecision::evaluate
+#include "bench_common.hpp"
+#include "../thread_pool.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Previous flow: 30 vol scenarios priced one call at a time, once for the analysis and once for the action
+    void legacyDecision(const Option& option, const std::vector<std::unique_ptr<PricingStrategy>>& strategies,
+                        const MarketData& marketData, const StatisticalAnalyzer& analyzer) {
+        for (int pass = 0; pass < 2; ++pass) {
+            std::vector<double> prices1, prices2;
+            for (int i = 0; i < 30; i++) {
+                const MarketData adjusted(marketData.getSpot(), marketData.getRiskFreeRate(),
+                                          marketData.getVolatility() * (0.95 + i * 0.01));
+                prices1.push_back(strategies[0]->calculatePrice(option, adjusted));
+                prices2.push_back(strategies[1]->calculatePrice(option, adjusted));
+            }
+            analyzer.analyzePricingDifference(prices1, prices2);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t threads = argc > 1 ? std::stoul(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<std::unique_ptr<PricingStrategy>> strategies;
+    strategies.push_back(std::make_unique<BinomialPricer>());
+    strategies.push_back(std::make_unique<BinomialPricer>());
+    std::vector<std::unique_ptr<PricingStrategy>> european;
+    european.push_back(std::make_unique<BlackScholesPricer>());
+    european.push_back(std::make_unique<BinomialPricer>());
+
+    const MarketData marketData(100.0, 0.05, 0.2);
+    const StatisticalAnalyzer analyzer;
+    WorkStealingPool pool(threads);
+    TradingDecision serial;
+    TradingDecision parallel(&pool);
+
+    std::cout << "=== Decision latency per contract (ms), pool of " << threads << " threads ===\n";
+    std::cout << std::left << std::setw(30) << "Case" << std::setw(12) << "Legacy"
+              << std::setw(12) << "Serial" << std::setw(12) << "Pool" << "Speedup (serial/pool)\n";
+
+    struct Case { const char* name; Option option; const std::vector<std::unique_ptr<PricingStrategy>>* strategies; };
+    const Case cases[] = {
+        {"European, BS vs Binomial", Option(Option::Type::CALL, Option::Style::EUROPEAN, 100.0, 1.0), &european},
+        {"American, Binomial x2", Option(Option::Type::PUT, Option::Style::AMERICAN, 100.0, 1.0), &strategies},
+    };
+
+    for (const Case& c : cases) {
+        const double legacy = Bench::bestTime([&] { legacyDecision(c.option, *c.strategies, marketData, analyzer); });
+        const double oneThread = Bench::bestTime([&] { serial.evaluate(c.option, *c.strategies, marketData, analyzer); });
+        const double pooled = Bench::bestTime([&] { parallel.evaluate(c.option, *c.strategies, marketData, analyzer); });
+        std::cout << std::left << std::setw(30) << c.name << std::fixed << std::setprecision(3)
+                  << std::setw(12) << legacy * 1e3 << std::setw(12) << oneThread * 1e3
+                  << std::setw(12) << pooled * 1e3 << std::setprecision(2)
+                  << legacy / oneThread << "x / " << legacy / pooled << "x\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Implied volatility solves/sec: bisection baseline vs ImpliedVolSolver per contract and in batch
+#include "bench_common.hpp"
+#include "../implied_vol.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace {
+    // Textbook baseline, halves [1e-6, 10] until the price matches
+    double bisection(BlackScholesPricer& pricer, const Option& option, double S, double r, double price) {
+        double lo = ImpliedVolSolver::MIN_VOLATILITY, hi = ImpliedVolSolver::MAX_VOLATILITY;
+        for (int i = 0; i < 100; ++i) {
+            const double mid = 0.5 * (lo + hi);
+            const double error = pricer.calculatePrice(option, MarketData(S, r, mid)) - price;
+            if (std::abs(error) <= 1e-10) {
+                return mid;
+            }
+            (error > 0 ? hi : lo) = mid;
+        }
+        return 0.5 * (lo + hi);
+    }
+
+    // Vol error only counts where vega lets a 1e-10 price tolerance pin the volatility down,
+    // deep in- or out-of-the-money quotes carry too little time value to invert
+    void report(const char* name, size_t n, double seconds, const std::vector<double>& vols,
+                const double* truth, const std::vector<int>& iterations, const std::vector<double>& vegas) {
+        double worst = 0.0, total = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            if (vegas[i] > 1e-3) {
+                worst = std::max(worst, std::abs(vols[i] - truth[i]));
+            }
+            total += iterations.empty() ? 0 : iterations[i];
+        }
+        std::cout << std::left << std::setw(26) << name << std::fixed << std::setprecision(1)
+                  << std::setw(14) << n / seconds / 1e3 << std::setprecision(2) << std::setw(12)
+                  << (iterations.empty() ? 0.0 : total / n) << std::scientific << std::setprecision(1)
+                  << worst << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 100000;
+    const OptionChain chain = Bench::makeChain(n, Option::Style::EUROPEAN);
+    const OptionBatch batch = chain.batch();
+
+    // Targets priced at the chain's own volatilities
+    BlackScholesPricer pricer;
+    std::vector<double> prices(n), delta(n), gamma(n), theta(n), vegas(n), rho(n);
+    pricer.calculatePricesAndGreeks(batch, GreeksBatch{prices.data(), delta.data(), gamma.data(),
+                                                       theta.data(), vegas.data(), rho.data()}, n);
+
+    std::cout << "=== Implied volatility, " << n << " European contracts ===\n";
+    std::cout << std::left << std::setw(26) << "Method" << std::setw(14) << "Ksolves/sec"
+              << std::setw(12) << "Mean iter" << "Max |vol error| (vega > 1e-3)\n";
+
+    std::vector<double> vols(n);
+    std::vector<int> iterations(n);
+    std::vector<uint8_t> converged(n);
+
+    double seconds = Bench::bestTime([&] {
+        for (size_t i = 0; i < n; ++i) {
+            vols[i] = bisection(pricer, Option(batch.type[i], batch.style[i], batch.strike[i], batch.expiry[i]),
+                                batch.spot[i], batch.riskFreeRate[i], prices[i]);
+        }
+    }, 1);
+    report("Bisection", n, seconds, vols, batch.volatility, {}, vegas);
+
+    ImpliedVolSolver solver;
+    seconds = Bench::bestTime([&] {
+        for (size_t i = 0; i < n; ++i) {
+            const auto result = solver.solve(Option(batch.type[i], batch.style[i], batch.strike[i], batch.expiry[i]),
+                                             MarketData(batch.spot[i], batch.riskFreeRate[i], 0.0), prices[i]);
+            vols[i] = result.volatility;
+            iterations[i] = result.iterations;
+        }
+    }, 3);
+    report("Halley, per contract", n, seconds, vols, batch.volatility, iterations, vegas);
+
+    ImpliedVolSolver scalarBatch(1e-10, 32, false);
+    seconds = Bench::bestTime([&] {
+        scalarBatch.solve(batch, prices.data(), ImpliedVolBatch{vols.data(), iterations.data(), converged.data()});
+    }, 3);
+    report("Halley, batch (scalar)", n, seconds, vols, batch.volatility, iterations, vegas);
+
+    seconds = Bench::bestTime([&] {
+        solver.solve(batch, prices.data(), ImpliedVolBatch{vols.data(), iterations.data(), converged.data()});
+    }, 3);
+    report("Halley, batch (SIMD)", n, seconds, vols, batch.volatility, iterations, vegas);
+
+    size_t failed = 0;
+    for (uint8_t flag : converged) {
+        failed += !flag;
+    }
+    std::cout << "Not converged (price at or outside the no-arbitrage bounds): " << failed << "\n";
+
+    // American puts, Newton on the lattice with the lattice vega
+    const size_t m = std::min<size_t>(n, 200);
+    const OptionChain american = Bench::makeChain(m, Option::Style::AMERICAN, 11, 1.0);
+    const OptionBatch americanBatch = american.batch();
+    BinomialPricer binomial;
+    std::vector<double> americanPrices(m), americanVegas(m);
+    for (size_t i = 0; i < m; ++i) {
+        const PriceWithGreeks model = binomial.calculatePriceAndGreeks(
+            Option(americanBatch.type[i], americanBatch.style[i], americanBatch.strike[i], americanBatch.expiry[i]),
+            MarketData(americanBatch.spot[i], americanBatch.riskFreeRate[i], americanBatch.volatility[i]));
+        americanPrices[i] = model.price;
+        americanVegas[i] = model.greeks.vega;
+    }
+
+    std::vector<double> americanVols(m);
+    std::vector<int> americanIterations(m);
+    seconds = Bench::bestTime([&] {
+        for (size_t i = 0; i < m; ++i) {
+            const auto result = solver.solve(
+                Option(americanBatch.type[i], americanBatch.style[i], americanBatch.strike[i], americanBatch.expiry[i]),
+                MarketData(americanBatch.spot[i], americanBatch.riskFreeRate[i], 0.0), americanPrices[i]);
+            americanVols[i] = result.volatility;
+            americanIterations[i] = result.iterations;
+        }
+    }, 1);
+    std::cout << "\n=== Implied volatility, " << m << " American contracts ===\n";
+    report("Newton on the lattice", m, seconds, americanVols, americanBatch.volatility, americanIterations, americanVegas);
+
+    return 0;
+}
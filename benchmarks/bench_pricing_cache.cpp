@@ -0,0 +1,110 @@
+// CachedPricer on a replayed quote loop: hit rate, time per tick and price error against no cache
+#include "bench_common.hpp"
+#include "../pricing_cache.hpp"
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    // A book re-priced every tick: spot follows a random walk of about 1bp per tick, vol and
+    // rate quotes only update every 50 ticks
+    struct Replay {
+        OptionChain book;
+        std::vector<OptionChain> ticks;
+    };
+
+    Replay makeReplay(size_t contracts, size_t ticks, Option::Style style) {
+        Replay replay;
+        replay.book = Bench::makeChain(contracts, style);
+        const OptionBatch book = replay.book.batch();
+
+        std::mt19937_64 rng(7);
+        std::normal_distribution<double> normal(0.0, 1.0);
+        double spot = 100.0, volShift = 0.0, rateShift = 0.0;
+        for (size_t t = 0; t < ticks; ++t) {
+            spot *= std::exp(1e-4 * normal(rng));
+            if (t % 50 == 0) {
+                volShift = 0.002 * normal(rng);
+                rateShift = 0.0002 * normal(rng);
+            }
+            OptionChain tick;
+            tick.reserve(contracts);
+            for (size_t i = 0; i < contracts; ++i) {
+                tick.add(Option(book.type[i], book.style[i], book.strike[i], book.expiry[i]),
+                         MarketData(spot, book.riskFreeRate[i] + rateShift, book.volatility[i] + volShift));
+            }
+            replay.ticks.push_back(std::move(tick));
+        }
+        return replay;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t contracts = argc > 1 ? std::stoul(argv[1]) : 500;
+    const size_t ticks = argc > 2 ? std::stoul(argv[2]) : 200;
+
+    struct Setup { const char* name; CacheSettings settings; };
+    CacheSettings exact;
+    CacheSettings quantized;
+    quantized.spotTolerance = 1e-3;
+    quantized.volTolerance = 1e-3;
+    quantized.rateTolerance = 1e-4;
+    CacheSettings taylor = quantized;
+    taylor.taylorRange = 5e-3;
+    const Setup setups[] = {{"Exact keys", exact}, {"Quantized 10bp spot", quantized}, {"Taylor 50bp spot", taylor}};
+
+    struct Model { const char* name; Option::Style style; };
+    const Model models[] = {{"Black-Scholes, European", Option::Style::EUROPEAN}, {"Binomial, American", Option::Style::AMERICAN}};
+
+    for (const Model& model : models) {
+        const Replay replay = makeReplay(contracts, ticks, model.style);
+        auto makeStrategy = [&]() -> std::unique_ptr<PricingStrategy> {
+            if (model.style == Option::Style::EUROPEAN) {
+                return std::make_unique<BlackScholesPricer>();
+            }
+            return std::make_unique<BinomialPricer>();
+        };
+
+        // Uncached prices are the reference for every cache setup
+        std::unique_ptr<PricingStrategy> direct = makeStrategy();
+        std::vector<std::vector<double>> reference(ticks, std::vector<double>(contracts));
+        const double directSeconds = Bench::bestTime([&] {
+            for (size_t t = 0; t < ticks; ++t) {
+                direct->calculatePrices(replay.ticks[t].batch(), reference[t].data(), contracts);
+            }
+        }, 1);
+
+        std::cout << "=== " << model.name << ", " << contracts << " contracts x " << ticks << " ticks ===\n";
+        std::cout << std::left << std::setw(24) << "Cache" << std::setw(16) << "us per tick" << std::setw(12)
+                  << "Hit rate" << std::setw(12) << "Taylor" << "Max error\n";
+        std::cout << std::left << std::setw(24) << "None" << std::fixed << std::setprecision(1) << std::setw(16)
+                  << directSeconds * 1e6 / ticks << std::setw(12) << "-" << std::setw(12) << "-" << "-\n";
+
+        for (const Setup& setup : setups) {
+            CachedPricer cached(makeStrategy(), setup.settings);
+            std::vector<double> prices(contracts);
+            double maxError = 0.0;
+            // The replay runs once from cold, the first tick fills the cache
+            const double seconds = Bench::bestTime([&] {
+                for (size_t t = 0; t < ticks; ++t) {
+                    cached.calculatePrices(replay.ticks[t].batch(), prices.data(), contracts);
+                    for (size_t i = 0; i < contracts; ++i) {
+                        maxError = std::max(maxError, std::abs(prices[i] - reference[t][i]));
+                    }
+                }
+            }, 1);
+            const CacheStats stats = cached.stats();
+            const double lookups = static_cast<double>(stats.hits + stats.taylorHits + stats.misses);
+            std::cout << std::left << std::setw(24) << setup.name << std::setprecision(1) << std::setw(16)
+                      << seconds * 1e6 / ticks << std::setprecision(3) << std::setw(12) << stats.hitRate()
+                      << std::setw(12) << stats.taylorHits / lookups << std::scientific << std::setprecision(2)
+                      << maxError << std::fixed << "\n";
+        }
+        std::cout << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+// Quasi-Monte Carlo: standard error and actual error against plain Monte Carlo as paths grow
+#include "bench_common.hpp"
+#include "../quasi_monte_carlo.hpp"
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <string>
+
+int main() {
+    const Option option(Option::Type::CALL, Option::Style::EUROPEAN, 100.0, 1.0);
+    const MarketData marketData(100.0, 0.05, 0.2);
+    const auto asian = std::make_shared<ArithmeticAsianPayoff>();
+
+    for (const bool pathDependent : {false, true}) {
+        const int steps = pathDependent ? 16 : 1;
+        const auto payoff = pathDependent ? asian : nullptr;
+
+        // Reference: the vanilla closed form, or a large scrambled Sobol run for the Asian
+        double reference = BlackScholesPricer(false).calculatePrice(option, marketData);
+        if (pathDependent) {
+            QuasiMonteCarloSettings settings;
+            settings.paths = 1 << 24;
+            settings.steps = steps;
+            settings.seed = 7;
+            reference = QuasiMonteCarloPricer(settings, nullptr, payoff).calculatePrice(option, marketData);
+        }
+
+        std::cout << "=== " << (pathDependent ? "Arithmetic Asian, 16 steps" : "Vanilla call") << ", reference "
+                  << std::fixed << std::setprecision(6) << reference << " ===\n";
+        std::cout << std::left << std::setw(10) << "Paths" << std::setw(14) << "MC std err" << std::setw(14) << "MC error"
+                  << std::setw(14) << "QMC std err" << std::setw(14) << "QMC error" << "MC paths per QMC path at equal std err\n";
+        for (size_t paths = 1 << 12; paths <= (1 << 20); paths <<= 2) {
+            // Plain estimators on both sides, so the gain is the sequence's alone
+            MonteCarloSettings mcSettings;
+            mcSettings.paths = paths;
+            mcSettings.steps = steps;
+            mcSettings.antithetic = false;
+            mcSettings.controlVariate = false;
+            const auto mc = MonteCarloPricer(mcSettings, nullptr, payoff).estimate(option, marketData);
+
+            QuasiMonteCarloSettings qmcSettings;
+            qmcSettings.paths = paths;
+            qmcSettings.steps = steps;
+            const auto qmc = QuasiMonteCarloPricer(qmcSettings, nullptr, payoff).estimate(option, marketData);
+
+            // Standard error falls as 1/sqrt(paths) for Monte Carlo
+            const double ratio = (mc.standardError / qmc.standardError) * (mc.standardError / qmc.standardError);
+            std::cout << std::left << std::setw(10) << paths << std::scientific << std::setprecision(2)
+                      << std::setw(14) << mc.standardError << std::setw(14) << std::abs(mc.price - reference)
+                      << std::setw(14) << qmc.standardError << std::setw(14) << std::abs(qmc.price - reference)
+                      << std::fixed << std::setprecision(0) << ratio << "x\n";
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,216 @@
+// RepricingEngine: tick-to-event latency on a resident book against repricing it from scratch
+#include "bench_common.hpp"
+#include "../repricing_engine.hpp"
+#include "../pricing_cache.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Tick {
+        size_t underlying;
+        MarketData marketData;
+    };
+
+    // Each tick moves one underlying's spot by about 1bp, vol quotes move every 50th tick
+    std::vector<Tick> makeTicks(size_t underlyings, size_t count) {
+        std::mt19937_64 rng(11);
+        std::normal_distribution<double> normal(0.0, 1.0);
+        std::uniform_int_distribution<size_t> pick(0, underlyings - 1);
+        std::vector<double> spots(underlyings, 100.0), vols(underlyings, 0.25);
+        std::vector<Tick> ticks;
+        for (size_t t = 0; t < count; ++t) {
+            const size_t u = pick(rng);
+            spots[u] *= std::exp(1e-4 * normal(rng));
+            if (t % 50 == 0) {
+                vols[u] = std::max(0.05, vols[u] + 0.002 * normal(rng));
+            }
+            ticks.push_back(Tick{u, MarketData(spots[u], 0.03, vols[u])});
+        }
+        return ticks;
+    }
+
+    double percentile(std::vector<double> values, double q) {
+        if (values.empty()) {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        return values[std::min(values.size() - 1, static_cast<size_t>(q * values.size()))];
+    }
+
+    void buildBook(RepricingEngine& engine, size_t underlyings, size_t perUnderlying) {
+        const OptionChain chain = Bench::makeChain(perUnderlying, Option::Style::EUROPEAN, 3, 1.0);
+        const OptionBatch batch = chain.batch();
+        for (size_t u = 0; u < underlyings; ++u) {
+            const size_t id = engine.addUnderlying(MarketData(100.0, 0.03, 0.25));
+            for (size_t i = 0; i < perUnderlying; ++i) {
+                engine.addContract(id, Option(batch.type[i], batch.style[i], batch.strike[i], batch.expiry[i]));
+            }
+            engine.post(id, MarketData(100.0, 0.03, 0.25));
+        }
+        engine.poll();
+    }
+
+    // Posts and polls tick by tick on this thread, latency is post to the tick's last event popped
+    void runInline(const std::string& name, RepricingEngine& engine, const RepricingEngine::Subscription& events,
+                   const std::vector<Tick>& ticks) {
+        PriceEvent event;
+        while (events->pop(event)) {
+        }
+        const RepricingEngine::Stats before = engine.stats();
+
+        std::vector<double> latencies;
+        latencies.reserve(ticks.size());
+        const auto start = Clock::now();
+        for (const Tick& tick : ticks) {
+            const auto posted = Clock::now();
+            engine.post(tick.underlying, tick.marketData);
+            engine.poll();
+            bool any = false;
+            while (events->pop(event)) {
+                any = true;
+            }
+            if (any) {
+                latencies.push_back(std::chrono::duration<double>(Clock::now() - posted).count());
+            }
+        }
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        const RepricingEngine::Stats after = engine.stats();
+        const double considered = static_cast<double>((after.repriced - before.repriced) + (after.skipped - before.skipped));
+        std::cout << std::left << std::setw(36) << name << std::fixed << std::setprecision(2) << std::setw(12)
+                  << seconds * 1e6 / ticks.size() << std::setw(12) << percentile(latencies, 0.5) * 1e6
+                  << std::setw(12) << percentile(latencies, 0.99) * 1e6 << std::setprecision(3)
+                  << (after.skipped - before.skipped) / considered << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t underlyings = argc > 1 ? std::stoul(argv[1]) : 100;
+    const size_t perUnderlying = argc > 2 ? std::stoul(argv[2]) : 50;
+    const std::vector<Tick> ticks = makeTicks(underlyings, 5000);
+    const size_t live = underlyings * perUnderlying;
+
+    std::cout << "=== " << live << " live European contracts on " << underlyings << " underlyings, "
+              << ticks.size() << " single-underlying ticks ===\n";
+    std::cout << std::left << std::setw(36) << "Path" << std::setw(12) << "us/tick" << std::setw(12)
+              << "p50 (us)" << std::setw(12) << "p99 (us)" << "Skipped\n";
+
+    // Status quo: every tick re-runs the whole book through calculatePrice
+    {
+        const OptionChain chain = Bench::makeChain(perUnderlying, Option::Style::EUROPEAN, 3, 1.0);
+        const OptionBatch batch = chain.batch();
+        BlackScholesPricer pricer;
+        std::vector<MarketData> markets(underlyings, MarketData(100.0, 0.03, 0.25));
+        double sink = 0.0;
+        const size_t sample = 200;
+        const auto start = Clock::now();
+        for (size_t t = 0; t < sample; ++t) {
+            markets[ticks[t].underlying] = ticks[t].marketData;
+            for (size_t u = 0; u < underlyings; ++u) {
+                for (size_t i = 0; i < perUnderlying; ++i) {
+                    sink += pricer.calculatePrice(Option(batch.type[i], batch.style[i], batch.strike[i], batch.expiry[i]), markets[u]);
+                }
+            }
+        }
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << std::left << std::setw(36) << "Whole book, calculatePrice" << std::fixed << std::setprecision(2)
+                  << std::setw(12) << seconds * 1e6 / sample << std::setw(12) << "-" << std::setw(12) << "-"
+                  << "-\n";
+        if (!std::isfinite(sink)) {
+            std::cout << "non-finite price\n";
+        }
+    }
+
+    {
+        RepricingEngine engine(std::make_unique<BlackScholesPricer>());
+        const RepricingEngine::Subscription events = engine.subscribe();
+        buildBook(engine, underlyings, perUnderlying);
+        runInline("Engine, prices", engine, events, ticks);
+    }
+    {
+        RepricingSettings settings;
+        settings.spotTolerance = 2e-4;
+        settings.volTolerance = 1e-3;
+        RepricingEngine engine(std::make_unique<BlackScholesPricer>(), {}, settings);
+        const RepricingEngine::Subscription events = engine.subscribe();
+        buildBook(engine, underlyings, perUnderlying);
+        runInline("Engine, prices, 2bp tolerance", engine, events, ticks);
+    }
+    {
+        // The decision's tree leg goes through the cache, its 30 vol scenarios barely move between ticks
+        CacheSettings cache;
+        cache.capacity = 1 << 20;
+        cache.spotTolerance = 1e-3;
+        cache.volTolerance = 1e-3;
+        std::vector<std::unique_ptr<PricingStrategy>> decision;
+        decision.push_back(std::make_unique<BlackScholesPricer>());
+        decision.push_back(std::make_unique<CachedPricer>(std::make_unique<BinomialPricer>(), cache));
+        RepricingEngine engine(std::make_unique<BlackScholesPricer>(), std::move(decision));
+        const RepricingEngine::Subscription events = engine.subscribe();
+        buildBook(engine, underlyings, perUnderlying);
+        runInline("Engine, prices + decisions", engine, events, ticks);
+    }
+
+    // Threaded: two feed threads post through the MPSC inbox while the engine thread polls
+    {
+        RepricingEngine engine(std::make_unique<BlackScholesPricer>());
+        const RepricingEngine::Subscription events = engine.subscribe();
+        buildBook(engine, underlyings, perUnderlying);
+        PriceEvent event;
+        while (events->pop(event)) {
+        }
+
+        std::atomic<size_t> received{0};
+        std::atomic<bool> feeding{true};
+        std::thread consumer([&] {
+            PriceEvent e;
+            while (true) {
+                const bool last = !feeding;
+                while (events->pop(e)) {
+                    ++received;
+                }
+                if (last) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        });
+
+        const auto start = Clock::now();
+        engine.start();
+        std::vector<std::thread> feeds;
+        for (size_t f = 0; f < 2; ++f) {
+            feeds.emplace_back([&, f] {
+                for (size_t t = f; t < ticks.size(); t += 2) {
+                    while (!engine.post(ticks[t].underlying, ticks[t].marketData)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (std::thread& feed : feeds) {
+            feed.join();
+        }
+        engine.stop();
+        feeding = false;
+        consumer.join();
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        const RepricingEngine::Stats stats = engine.stats();
+        std::cout << "\nThreaded, 2 feeds: " << std::fixed << std::setprecision(2) << seconds * 1e6 / ticks.size()
+                  << " us/tick, " << stats.conflated << " updates conflated, " << received.load() << " events received, "
+                  << stats.dropped << " dropped\n";
+    }
+
+    return 0;
+}
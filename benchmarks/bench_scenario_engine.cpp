@@ -0,0 +1,139 @@
+// Stress grids over a portfolio: every scenario rebuilt as a shifted chain and priced contract by
+// contract with the pricers' Greeks, vs ScenarioEngine sharing discount factors and lattice
+// geometries across contracts and scenarios, serial and on the pool
+#include "bench_common.hpp"
+#include "../scenario_engine.hpp"
+#include "../thread_pool.hpp"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct Book {
+        std::vector<MarketData> underlyings;
+        std::vector<size_t> underlying;
+        std::vector<Option> options;
+        std::vector<double> quantity;
+    };
+
+    // A listed-style book: a few expiries, a strike ladder on each, calls and puts, long and short
+    Book makeBook(size_t underlyingCount, Option::Style style) {
+        Book book;
+        const double expiries[] = {0.1, 0.25, 0.5, 1.0};
+        for (size_t u = 0; u < underlyingCount; ++u) {
+            const double spot = 50.0 + 25.0 * u;
+            book.underlyings.emplace_back(spot, 0.03, 0.2 + 0.05 * u);
+            for (const double expiry : expiries) {
+                for (int k = -5; k <= 5; ++k) {
+                    for (const Option::Type type : {Option::Type::CALL, Option::Type::PUT}) {
+                        book.underlying.push_back(u);
+                        book.options.emplace_back(type, style, spot * (1.0 + 0.04 * k), expiry);
+                        book.quantity.push_back((k + u) % 2 ? 10.0 : -5.0);
+                    }
+                }
+            }
+        }
+        return book;
+    }
+
+    // Previous approach: one shifted contract per (scenario, position), priced and summed
+    void naiveRun(const Book& book, const ScenarioGrid& grid, int steps, std::vector<ScenarioResult>& results) {
+        BlackScholesPricer blackScholes(false);
+        BinomialSettings settings;
+        settings.steps = steps;
+        BinomialPricer binomial(settings);
+
+        for (size_t i = 0; i < grid.size(); ++i) {
+            const ScenarioGrid::Scenario scenario = grid.scenario(i);
+            ScenarioResult result{0.0, 0.0, Greeks{0, 0, 0, 0, 0}};
+            for (size_t p = 0; p < book.options.size(); ++p) {
+                const Option& option = book.options[p];
+                const MarketData& base = book.underlyings[book.underlying[p]];
+                const MarketData shifted(base.getSpot() * (1.0 + scenario.spotShift), base.getRiskFreeRate() + scenario.rateShift,
+                                         base.getVolatility() + scenario.volShift);
+                const Option aged(option.getType(), option.getStyle(), option.getStrike(),
+                                  option.getExpiry() - scenario.timeShift);
+                PricingStrategy& pricer = option.getStyle() == Option::Style::EUROPEAN
+                    ? static_cast<PricingStrategy&>(blackScholes) : binomial;
+                const PriceWithGreeks priced = pricer.calculatePriceAndGreeks(aged, shifted);
+                const double q = book.quantity[p];
+                result.value += q * priced.price;
+                result.greeks.delta += q * priced.greeks.delta;
+                result.greeks.gamma += q * priced.greeks.gamma;
+                result.greeks.theta += q * priced.greeks.theta;
+                result.greeks.vega += q * priced.greeks.vega;
+                result.greeks.rho += q * priced.greeks.rho;
+            }
+            results[i] = result;
+        }
+    }
+
+    double maxDifference(const std::vector<ScenarioResult>& a, const std::vector<ScenarioResult>& b) {
+        double worst = 0.0;
+        for (size_t i = 0; i < a.size(); ++i) {
+            worst = std::max({worst, std::abs(a[i].value - b[i].value), std::abs(a[i].greeks.delta - b[i].greeks.delta),
+                              std::abs(a[i].greeks.vega - b[i].greeks.vega)});
+        }
+        return worst;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t underlyingCount = argc > 1 ? std::stoul(argv[1]) : 4;
+    const size_t threads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    const int steps = 100;
+
+    // Time shifts stay inside the shortest expiry so the naive pricers accept every contract
+    ScenarioGrid grid;
+    grid.spotShifts = ScenarioGrid::range(-0.2, 0.2, 21);
+    grid.volShifts = ScenarioGrid::range(-0.05, 0.1, 4);
+    grid.rateShifts = {-0.01, 0.0, 0.01};
+    grid.timeShifts = {0.0, 1.0 / 52};
+
+    ScenarioSettings settings;
+    settings.steps = steps;
+    WorkStealingPool pool(threads);
+
+    std::cout << "=== Scenario grid, " << grid.size() << " scenarios, ns per scenario x position ===\n";
+    std::cout << std::left << std::setw(26) << "Book" << std::setw(12) << "Naive" << std::setw(12) << "Engine"
+              << std::setw(12) << "Pooled" << std::setw(10) << "Speedup" << "max |diff|\n";
+
+    for (const Option::Style style : {Option::Style::EUROPEAN, Option::Style::AMERICAN}) {
+        const Book book = makeBook(underlyingCount, style);
+        ScenarioEngine serial(nullptr, settings);
+        ScenarioEngine pooled(&pool, settings);
+        for (ScenarioEngine* engine : {&serial, &pooled}) {
+            for (const MarketData& marketData : book.underlyings) {
+                engine->addUnderlying(marketData);
+            }
+            for (size_t p = 0; p < book.options.size(); ++p) {
+                engine->addPosition(book.underlying[p], book.options[p], book.quantity[p]);
+            }
+        }
+
+        const double cells = static_cast<double>(grid.size()) * book.options.size();
+        const int repetitions = style == Option::Style::EUROPEAN ? 5 : 1;
+        std::vector<ScenarioResult> naive(grid.size()), engine(grid.size()), parallel(grid.size());
+        const double naiveTime = Bench::bestTime([&] { naiveRun(book, grid, steps, naive); }, repetitions);
+        const double engineTime = Bench::bestTime([&] { serial.run(grid, engine.data(), engine.size()); }, repetitions);
+        const double pooledTime = Bench::bestTime([&] { pooled.run(grid, parallel.data(), parallel.size()); }, repetitions);
+
+        bool identical = true;
+        for (size_t i = 0; i < grid.size(); ++i) {
+            identical = identical && engine[i].value == parallel[i].value && engine[i].greeks.gamma == parallel[i].greeks.gamma;
+        }
+        const std::string name = std::string(style == Option::Style::EUROPEAN ? "European, " : "American N=100, ")
+                               + std::to_string(book.options.size());
+        std::cout << std::left << std::setw(26) << name << std::fixed << std::setprecision(1)
+                  << std::setw(12) << naiveTime * 1e9 / cells << std::setw(12) << engineTime * 1e9 / cells
+                  << std::setw(12) << pooledTime * 1e9 / cells << std::setprecision(2) << std::setw(10)
+                  << naiveTime / engineTime << std::scientific << std::setprecision(1)
+                  << maxDifference(naive, engine) << (identical ? "" : "  (pooled results differ)") << "\n";
+    }
+    std::cout << "Pool threads: " << threads << "\n";
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+// Compile-time payoffs: the lattice node loop with runtime type/style flags vs the instantiations
+// Payoff::dispatch picks, and batches of mixed kinds priced one virtual call per contract vs by
+// (type, style) group
+#include "bench_common.hpp"
+#include "../lattice_engine.hpp"
+#include "../payoff.hpp"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    // Previous Lattice::sweepFrom: exercise style tested per level and the payoff sign applied per node
+    void runtimeSweep(const Lattice::Geometry& geometry, const double* spots, const double* terminal, double K,
+                      bool isCall, bool isAmerican, double* values) {
+        const int N = geometry.steps;
+        const double sign = isCall ? 1.0 : -1.0;
+        std::copy(terminal, terminal + N + 1, values);
+        for (int i = N - 1; i >= 0; --i) {
+            if (isAmerican) {
+                const double* row = spots + (N - i);
+                const double centre = exp(i * geometry.drift);
+                for (int j = 0; j <= i; ++j) {
+                    values[j] = std::max(geometry.up * values[j+1] + geometry.down * values[j],
+                                         sign * (row[2 * j] * centre - K));
+                }
+            } else {
+                for (int j = 0; j <= i; ++j) {
+                    values[j] = geometry.up * values[j+1] + geometry.down * values[j];
+                }
+            }
+        }
+    }
+
+    // Mixed calls and puts, European and American, in random order
+    OptionChain mixedChain(size_t n, bool europeanOnly) {
+        OptionChain chain = Bench::makeChain(n, Option::Style::EUROPEAN, 17, 1.0);
+        if (europeanOnly) {
+            return chain;
+        }
+        const OptionBatch source = chain.batch();
+        std::mt19937_64 rng(3);
+        OptionChain mixed;
+        mixed.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            const Option::Style style = rng() % 2 ? Option::Style::AMERICAN : Option::Style::EUROPEAN;
+            mixed.add(Option(source.type[i], style, source.strike[i], source.expiry[i]),
+                      MarketData(source.spot[i], source.riskFreeRate[i], source.volatility[i]));
+        }
+        return mixed;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int steps = argc > 1 ? std::stoi(argv[1]) : 1000;
+
+    std::cout << "=== Leisen-Reimer node loop, N = " << steps << ", ns per node ===\n";
+    std::cout << std::left << std::setw(16) << "Contract" << std::setw(16) << "Runtime flags"
+              << std::setw(16) << "Specialized" << "|diff|\n";
+    const int N = steps | 1;
+    const double K = 100.0;
+    const Lattice::Geometry geometry = Lattice::leisenReimerGeometry(100.0, K, 0.05, 0.25, 1.0, N);
+    Lattice::Arena& arena = Lattice::threadArena();
+    arena.reset(Lattice::tableSize(N) + 3 * (N + 1));
+    const double* spots = Lattice::buildSpots(100.0, geometry, arena);
+    double* terminal = arena.take(N + 1);
+    double* values = arena.take(N + 1);
+    const double nodes = 0.5 * N * (N + 1.0);
+
+    for (const Option::Type type : {Option::Type::CALL, Option::Type::PUT}) {
+        for (const Option::Style style : {Option::Style::EUROPEAN, Option::Style::AMERICAN}) {
+            const bool isCall = type == Option::Type::CALL;
+            const bool isAmerican = style == Option::Style::AMERICAN;
+            const double centre = exp(N * geometry.drift);
+            for (int j = 0; j <= N; ++j) {
+                terminal[j] = std::max(0.0, (isCall ? 1.0 : -1.0) * (spots[2 * j] * centre - K));
+            }
+
+            double runtimePrice = 0.0, specializedPrice = 0.0;
+            const double runtime = Bench::bestTime([&] {
+                runtimeSweep(geometry, spots, terminal, K, isCall, isAmerican, values);
+                runtimePrice = values[0];
+            }, 20);
+            const double specialized = Bench::bestTime([&] {
+                Payoff::dispatch(type, style, [&](auto typeTag, auto styleTag) {
+                    Lattice::sweepFrom<decltype(typeTag)::value, decltype(styleTag)::value>(geometry, spots, terminal,
+                                                                                          K, values);
+                });
+                specializedPrice = values[0];
+            }, 20);
+
+            const std::string name = std::string(isAmerican ? "American " : "European ") + (isCall ? "call" : "put");
+            std::cout << std::left << std::setw(16) << name << std::fixed << std::setprecision(3)
+                      << std::setw(16) << runtime * 1e9 / nodes << std::setw(16) << specialized * 1e9 / nodes
+                      << std::scientific << std::setprecision(1) << std::abs(runtimePrice - specializedPrice) << "\n";
+        }
+    }
+
+    // Whole batches: the PricingStrategy default calls calculatePrice virtually for every contract
+    // and dispatches inside it, the overrides group the chain once
+    std::cout << "\n=== Mixed batches, ns per contract ===\n";
+    std::cout << std::left << std::setw(36) << "Case" << std::setw(16) << "Per contract"
+              << std::setw(16) << "Grouped" << "Speedup\n";
+
+    auto report = [](const std::string& name, PricingStrategy& pricer, const OptionChain& chain) {
+        std::vector<double> perContract(chain.size()), grouped(chain.size());
+        const double loose = Bench::bestTime([&] {
+            pricer.PricingStrategy::calculatePrices(chain.batch(), perContract.data(), chain.size());
+        }, 3);
+        const double tight = Bench::bestTime([&] {
+            pricer.calculatePrices(chain.batch(), grouped.data(), chain.size());
+        }, 3);
+        double maxDiff = 0.0;
+        for (size_t i = 0; i < chain.size(); ++i) {
+            maxDiff = std::max(maxDiff, std::abs(perContract[i] - grouped[i]));
+        }
+        std::cout << std::left << std::setw(36) << name << std::fixed << std::setprecision(1)
+                  << std::setw(16) << loose * 1e9 / chain.size() << std::setw(16) << tight * 1e9 / chain.size()
+                  << std::setprecision(2) << loose / tight << "x";
+        if (maxDiff > 0) {
+            std::cout << "  (max |diff| " << std::scientific << std::setprecision(1) << maxDiff << ")";
+        }
+        std::cout << "\n";
+    };
+
+    BlackScholesPricer scalarBlackScholes(false);
+    report("Black-Scholes scalar, 100000", scalarBlackScholes, mixedChain(100000, true));
+    BinomialSettings settings;
+    settings.steps = 100;
+    BinomialPricer binomial(settings);
+    report("Binomial N=100, 2000 mixed", binomial, mixedChain(2000, false));
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+// Statistical analyzer: exact Student's t critical values and p-values against published tables,
+// and the cost of testing many contracts one vector pair at a time vs the sample-major batch
+#include "bench_common.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    // Previous analyzer: a differences vector, two passes, normal p-value and a 1.96 interval
+    StatisticalAnalyzer::AnalysisResult legacyAnalyze(const std::vector<double>& prices1,
+                                                      const std::vector<double>& prices2) {
+        const size_t n = prices1.size();
+        std::vector<double> differences(n);
+        std::transform(prices1.begin(), prices1.end(), prices2.begin(), differences.begin(), std::minus<double>());
+        const double mean = std::accumulate(differences.begin(), differences.end(), 0.0) / n;
+        double squares = 0.0;
+        for (const double d : differences) {
+            squares += (d - mean) * (d - mean);
+        }
+        const double deviation = std::sqrt(squares / (n - 1));
+        const double error = deviation / std::sqrt(n);
+        const double p = std::erfc(std::abs(mean / error) / std::sqrt(2.0));
+        return {p, 1.96 * error, p < 0.05, mean, deviation};
+    }
+
+    // Paired series with a known t: deviations of unit sample variance scaled around the mean
+    std::vector<double> seriesWithT(double t, size_t n) {
+        std::vector<double> e(n);
+        for (size_t i = 0; i < n; ++i) {
+            e[i] = (i % 2 == 0 ? 1.0 : -1.0) * (1.0 + 0.1 * static_cast<double>(i % 5));
+        }
+        const double mean = std::accumulate(e.begin(), e.end(), 0.0) / n;
+        double squares = 0.0;
+        for (double& x : e) {
+            x -= mean;
+            squares += x * x;
+        }
+        const double scale = 1.0 / std::sqrt(squares / (n - 1));
+        for (double& x : e) {
+            x = x * scale + t / std::sqrt(static_cast<double>(n));
+        }
+        return e;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t contracts = argc > 1 ? std::stoul(argv[1]) : 10000;
+    const size_t samples = argc > 2 ? std::stoul(argv[2]) : 30;
+
+    // Two-sided 95% critical values and p-values from standard t tables
+    std::cout << "=== Student's t against tables, two-sided ===\n";
+    std::cout << std::left << std::setw(8) << "n" << std::setw(10) << "t" << std::setw(16) << "p exact"
+              << std::setw(16) << "p table" << std::setw(16) << "p normal" << std::setw(14) << "t crit"
+              << "t crit table\n";
+    struct Row { size_t n; double t; double p; double critical; };
+    const Row rows[] = {
+        {3, 4.302653, 0.05, 4.302653},
+        {6, 2.570582, 0.05, 2.570582},
+        {11, 3.169273, 0.01, 2.228139},
+        {30, 2.045230, 0.05, 2.045230},
+        {30, 3.659624, 0.001, 2.045230},
+        {121, 1.979930, 0.05, 1.979930},
+    };
+    const StatisticalAnalyzer analyzer;
+    for (const Row& row : rows) {
+        const std::vector<double> a = seriesWithT(row.t, row.n);
+        const std::vector<double> b(row.n, 0.0);
+        const StatisticalAnalyzer::AnalysisResult exact = analyzer.analyzePricingDifference(a, b);
+        const StatisticalAnalyzer::AnalysisResult normal = legacyAnalyze(a, b);
+        const double critical = exact.confidenceInterval / (exact.standard_deviation / std::sqrt(static_cast<double>(row.n)));
+        std::cout << std::left << std::setw(8) << row.n << std::fixed << std::setprecision(4) << std::setw(10) << row.t
+                  << std::setprecision(8) << std::setw(16) << exact.pValue << std::setw(16) << row.p
+                  << std::setw(16) << normal.pValue << std::setprecision(6) << std::setw(14) << critical
+                  << row.critical << "\n";
+    }
+
+    // Random paired series, sample-major for the batch and one vector pair per contract for the rest
+    std::mt19937_64 rng(5);
+    std::normal_distribution<double> noise(0.0, 0.01);
+    std::vector<double> prices1(contracts * samples), prices2(contracts * samples);
+    for (size_t i = 0; i < prices1.size(); ++i) {
+        const double price = 10.0 + 0.001 * static_cast<double>(i % contracts);
+        prices1[i] = price + noise(rng);
+        prices2[i] = price + noise(rng);
+    }
+    std::vector<std::vector<double>> series1(contracts, std::vector<double>(samples));
+    std::vector<std::vector<double>> series2(contracts, std::vector<double>(samples));
+    for (size_t c = 0; c < contracts; ++c) {
+        for (size_t k = 0; k < samples; ++k) {
+            series1[c][k] = prices1[k * contracts + c];
+            series2[c][k] = prices2[k * contracts + c];
+        }
+    }
+
+    std::vector<double> pValue(contracts), interval(contracts), mean(contracts), deviation(contracts);
+    std::unique_ptr<bool[]> significant(new bool[contracts]);
+    volatile double sink = 0.0;
+    const double legacy = Bench::bestTime([&] {
+        for (size_t c = 0; c < contracts; ++c) {
+            sink = sink + legacyAnalyze(series1[c], series2[c]).pValue;
+        }
+    });
+    const double scalar = Bench::bestTime([&] {
+        for (size_t c = 0; c < contracts; ++c) {
+            sink = sink + analyzer.analyzePricingDifference(series1[c], series2[c]).pValue;
+        }
+    });
+    const StatisticalAnalyzer::SeriesBatch batch{prices1.data(), prices2.data(), contracts, samples};
+    const double batched = Bench::bestTime([&] {
+        analyzer.analyzePricingDifferences(batch, {pValue.data(), interval.data(), significant.get(),
+                                                   mean.data(), deviation.data()});
+    });
+    const double momentsOnly = Bench::bestTime([&] {
+        analyzer.analyzePricingDifferences(batch, {nullptr, interval.data(), significant.get(),
+                                                   mean.data(), deviation.data()});
+    });
+
+    double maxDiff = 0.0;
+    for (size_t c = 0; c < contracts; ++c) {
+        const StatisticalAnalyzer::AnalysisResult one = analyzer.analyzePricingDifference(series1[c], series2[c]);
+        maxDiff = std::max({maxDiff, std::abs(one.pValue - pValue[c]), std::abs(one.confidenceInterval - interval[c])});
+    }
+
+    std::cout << "\n=== " << contracts << " contracts x " << samples << " samples, ns per contract ===\n";
+    std::cout << std::left << std::setw(34) << "Legacy (normal, allocating)" << std::fixed << std::setprecision(1)
+              << legacy * 1e9 / contracts << "\n";
+    std::cout << std::left << std::setw(34) << "Scalar (exact t)" << scalar * 1e9 / contracts << "\n";
+    std::cout << std::left << std::setw(34) << "Batch (exact t)" << batched * 1e9 / contracts << "\n";
+    std::cout << std::left << std::setw(34) << "Batch, no p-values" << momentsOnly * 1e9 / contracts << "\n";
+    std::cout << "Max |batch - scalar|: " << std::scientific << std::setprecision(2) << maxDiff << "\n";
+
+    return 0;
+}
@@ -0,0 +1,529 @@
+// Regression suite: registered micro and macro benchmarks, JSON results in the Google Benchmark
+// layout, and a comparison mode that fails when a benchmark slowed down against a stored baseline
+//
+//   bench_suite [--filter text] [--min-time seconds] [--repetitions n] [--json out.json]
+//               [--compare baseline.json] [--threshold fraction]
+//
+// Exit code 1 when --compare finds a regression beyond the threshold (default 0.10) or a baseline
+// benchmark the filter selects is missing from the run
+#include "bench_common.hpp"
+#include "../scenario_engine.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Runs the body `iterations` times and returns the items processed per iteration
+    using Body = std::function<double(size_t iterations)>;
+
+    struct Benchmark {
+        std::string name;
+        Body body;
+    };
+
+    struct Result {
+        std::string name;
+        size_t iterations;
+        double realTime;    // ns per iteration, best repetition
+        double cpuTime;     // ns per iteration, same repetition
+        double itemsPerSecond;
+    };
+
+    struct Settings {
+        std::string filter;
+        double minTime = 0.2;
+        int repetitions = 3;
+        std::string jsonPath;
+        std::string baselinePath;
+        double threshold = 0.10;
+    };
+
+    // Keeps results observable so the optimizer cannot drop the priced calls
+    volatile double sink = 0.0;
+
+    // Grows the iteration count until one run lasts minTime, then keeps the best of the repetitions
+    Result run(const Benchmark& benchmark, const Settings& settings) {
+        size_t iterations = 1;
+        double items = benchmark.body(1);
+        for (;;) {
+            const auto start = std::chrono::steady_clock::now();
+            items = benchmark.body(iterations);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (seconds >= settings.minTime || iterations >= (size_t(1) << 40)) {
+                break;
+            }
+            const double target = seconds > 0 ? 1.4 * settings.minTime / seconds * iterations : 10.0 * iterations;
+            iterations = static_cast<size_t>(std::min(std::max(target, iterations + 1.0), 10.0 * iterations));
+        }
+
+        Result result{benchmark.name, iterations, 1e300, 0.0, 0.0};
+        for (int rep = 0; rep < settings.repetitions; ++rep) {
+            const std::clock_t cpuStart = std::clock();
+            const auto start = std::chrono::steady_clock::now();
+            benchmark.body(iterations);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            const double cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+            if (seconds * 1e9 / iterations < result.realTime) {
+                result.realTime = seconds * 1e9 / iterations;
+                result.cpuTime = cpuSeconds * 1e9 / iterations;
+            }
+        }
+        result.itemsPerSecond = items * 1e9 / result.realTime;
+        return result;
+    }
+
+    std::string moneynessLabel(double strike) {
+        std::ostringstream label;
+        label << "K:" << strike;
+        return label.str();
+    }
+
+    std::vector<Benchmark> registry() {
+        std::vector<Benchmark> benchmarks;
+        const MarketData marketData(100.0, 0.05, 0.2);
+        const double strikes[] = {80.0, 100.0, 120.0};
+
+        // Per-call latency, out of, at and in the money for a call
+        for (const double strike : strikes) {
+            const Option european(Option::Type::CALL, Option::Style::EUROPEAN, strike, 1.0);
+            benchmarks.push_back({"BlackScholes/price/" + moneynessLabel(strike), [=](size_t iterations) {
+                BlackScholesPricer pricer;
+                for (size_t i = 0; i < iterations; ++i) {
+                    sink = sink + pricer.calculatePrice(european, marketData);
+                }
+                return 1.0;
+            }});
+            benchmarks.push_back({"BlackScholes/greeks/" + moneynessLabel(strike), [=](size_t iterations) {
+                BlackScholesPricer pricer;
+                for (size_t i = 0; i < iterations; ++i) {
+                    sink = sink + pricer.calculatePriceAndGreeks(european, marketData).greeks.delta;
+                }
+                return 1.0;
+            }});
+        }
+
+        for (const int steps : {100, 500, 1000}) {
+            for (const double strike : strikes) {
+                const Option american(Option::Type::PUT, Option::Style::AMERICAN, strike, 1.0);
+                benchmarks.push_back({"Binomial/price/N:" + std::to_string(steps) + "/" + moneynessLabel(strike),
+                                      [=](size_t iterations) {
+                    BinomialSettings settings;
+                    settings.steps = steps;
+                    BinomialPricer pricer(settings);
+                    for (size_t i = 0; i < iterations; ++i) {
+                        sink = sink + pricer.calculatePrice(american, marketData);
+                    }
+                    return 1.0;
+                }});
+            }
+        }
+
+        // Chain throughput through the batch API, items are contracts
+        const auto chain = [&benchmarks](const std::string& name, std::function<std::unique_ptr<PricingStrategy>()> make,
+                                         size_t contracts, Option::Style style) {
+            const auto shared = std::make_shared<OptionChain>(Bench::makeChain(contracts, style));
+            benchmarks.push_back({name + "/" + std::to_string(contracts), [=](size_t iterations) {
+                std::unique_ptr<PricingStrategy> pricer = make();
+                std::vector<double> prices(contracts);
+                for (size_t i = 0; i < iterations; ++i) {
+                    pricer->calculatePrices(shared->batch(), prices.data(), contracts);
+                    sink = sink + prices[0];
+                }
+                return static_cast<double>(contracts);
+            }});
+        };
+        chain("Chain/BlackScholes", [] { return std::make_unique<BlackScholesPricer>(); }, 100000, Option::Style::EUROPEAN);
+        chain("Chain/Binomial/American", [] { return std::make_unique<BinomialPricer>(); }, 1000, Option::Style::AMERICAN);
+
+        // End-to-end decisions: the 30-scenario sweep, both strategies and the analysis
+        struct DecisionCase {
+            const char* name;
+            Option option;
+            bool european;
+        };
+        const DecisionCase decisions[] = {
+            {"Decision/makeDecision/European", Option(Option::Type::CALL, Option::Style::EUROPEAN, 100.0, 1.0), true},
+            {"Decision/makeDecision/American", Option(Option::Type::PUT, Option::Style::AMERICAN, 100.0, 1.0), false},
+        };
+        for (const DecisionCase& decision : decisions) {
+            const Option option = decision.option;
+            const bool european = decision.european;
+            benchmarks.push_back({decision.name, [=](size_t iterations) {
+                std::vector<std::unique_ptr<PricingStrategy>> strategies;
+                if (european) {
+                    strategies.push_back(std::make_unique<BlackScholesPricer>());
+                } else {
+                    strategies.push_back(std::make_unique<BinomialPricer>());
+                }
+                strategies.push_back(std::make_unique<BinomialPricer>());
+                TradingDecision decisionMaker;
+                const StatisticalAnalyzer analyzer;
+                for (size_t i = 0; i < iterations; ++i) {
+                    sink = sink + static_cast<int>(decisionMaker.makeDecision(option, strategies, marketData, analyzer));
+                }
+                return 1.0;
+            }});
+        }
+
+        // Analyzer cost by sample size, items are samples per side
+        for (const size_t samples : {30, 1000, 100000}) {
+            std::mt19937_64 rng(11);
+            std::normal_distribution<double> noise(0.0, 0.01);
+            auto prices1 = std::make_shared<std::vector<double>>();
+            auto prices2 = std::make_shared<std::vector<double>>();
+            for (size_t i = 0; i < samples; ++i) {
+                const double price = 10.0 + 0.01 * static_cast<double>(i % 30);
+                prices1->push_back(price + noise(rng));
+                prices2->push_back(price + noise(rng));
+            }
+            benchmarks.push_back({"StatisticalAnalyzer/analyzePricingDifference/n:" + std::to_string(samples),
+                                  [=](size_t iterations) {
+                const StatisticalAnalyzer analyzer;
+                for (size_t i = 0; i < iterations; ++i) {
+                    sink = sink + analyzer.analyzePricingDifference(*prices1, *prices2).pValue;
+                }
+                return static_cast<double>(samples);
+            }});
+        }
+        // Book-wide scan, items are contracts
+        {
+            const size_t contracts = 10000;
+            const size_t samples = 30;
+            std::mt19937_64 rng(13);
+            std::normal_distribution<double> noise(0.0, 0.01);
+            auto prices = std::make_shared<std::vector<double>>(2 * contracts * samples);
+            for (size_t i = 0; i < contracts * samples; ++i) {
+                const double price = 10.0 + 0.001 * static_cast<double>(i % contracts);
+                (*prices)[i] = price + noise(rng);
+                (*prices)[contracts * samples + i] = price + noise(rng);
+            }
+            benchmarks.push_back({"StatisticalAnalyzer/analyzePricingDifferences/n:30",
+                                  [=](size_t iterations) {
+                const StatisticalAnalyzer analyzer;
+                std::vector<double> pValue(contracts);
+                const StatisticalAnalyzer::SeriesBatch series{prices->data(), prices->data() + contracts * samples,
+                                                              contracts, samples};
+                for (size_t i = 0; i < iterations; ++i) {
+                    analyzer.analyzePricingDifferences(series, {pValue.data(), nullptr, nullptr, nullptr, nullptr});
+                    sink = sink + pValue[i % contracts];
+                }
+                return static_cast<double>(contracts);
+            }});
+        }
+        benchmarks.push_back({"StatisticalAnalyzer/analyzeEstimate", [](size_t iterations) {
+            const StatisticalAnalyzer analyzer;
+            for (size_t i = 0; i < iterations; ++i) {
+                sink = sink + analyzer.analyzeEstimate(10.02, 0.01, 10.0).pValue;
+            }
+            return 1.0;
+        }});
+
+        // Portfolio stress grid, items are scenario x position cells
+        benchmarks.push_back({"ScenarioEngine/run/European/cells:105600", [](size_t iterations) {
+            ScenarioEngine engine;
+            for (size_t u = 0; u < 4; ++u) {
+                const double spot = 50.0 + 25.0 * u;
+                engine.addUnderlying(MarketData(spot, 0.03, 0.2 + 0.05 * u));
+                for (const double expiry : {0.1, 0.25, 0.5, 1.0}) {
+                    for (int k = -5; k <= 5; ++k) {
+                        engine.addPosition(u, Option(Option::Type::CALL, Option::Style::EUROPEAN, spot * (1.0 + 0.04 * k), expiry), 1.0);
+                        engine.addPosition(u, Option(Option::Type::PUT, Option::Style::EUROPEAN, spot * (1.0 + 0.04 * k), expiry), -1.0);
+                    }
+                }
+            }
+            ScenarioGrid grid;
+            grid.spotShifts = ScenarioGrid::range(-0.2, 0.2, 25);
+            grid.volShifts = ScenarioGrid::range(-0.05, 0.1, 4);
+            grid.rateShifts = {-0.01, 0.0, 0.01};
+            std::vector<ScenarioResult> results(grid.size());
+            for (size_t i = 0; i < iterations; ++i) {
+                engine.run(grid, results.data(), results.size());
+                sink = sink + results[i % results.size()].pnl;
+            }
+            return static_cast<double>(grid.size() * engine.positionCount());
+        }});
+
+        return benchmarks;
+    }
+
+    std::string escape(const std::string& text) {
+        std::string out;
+        for (const char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+            }
+            out += c;
+        }
+        return out;
+    }
+
+    void writeJson(const std::vector<Result>& results, const std::string& path) {
+        std::ofstream out(path);
+        if (!out) {
+            throw std::runtime_error("Cannot write " + path);
+        }
+        const std::time_t now = std::time(nullptr);
+        char date[32];
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        out << "{\n  \"context\": {\n"
+            << "    \"date\": \"" << date << "\",\n"
+            << "    \"executable\": \"bench_suite\",\n"
+            << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+            << "    \"library_build_type\": \"release\"\n"
+#else
+            << "    \"library_build_type\": \"debug\"\n"
+#endif
+            << "  },\n  \"benchmarks\": [\n";
+        out << std::setprecision(10);
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            out << "    {\n"
+                << "      \"name\": \"" << escape(r.name) << "\",\n"
+                << "      \"run_name\": \"" << escape(r.name) << "\",\n"
+                << "      \"run_type\": \"iteration\",\n"
+                << "      \"iterations\": " << r.iterations << ",\n"
+                << "      \"real_time\": " << r.realTime << ",\n"
+                << "      \"cpu_time\": " << r.cpuTime << ",\n"
+                << "      \"time_unit\": \"ns\",\n"
+                << "      \"items_per_second\": " << r.itemsPerSecond << "\n"
+                << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+
+    // Reads name -> real_time in ns from the "benchmarks" array of a results file, ours or Google
+    // Benchmark's. Only flat string and number members are kept, anything nested is skipped
+    class BaselineReader {
+        public:
+            explicit BaselineReader(std::string text) : text(std::move(text)) {}
+
+            std::map<std::string, double> read() {
+                std::map<std::string, double> times;
+                const size_t key = text.find("\"benchmarks\"");
+                if (key == std::string::npos) {
+                    throw std::runtime_error("Baseline has no benchmarks array");
+                }
+                pos = text.find('[', key);
+                if (pos == std::string::npos) {
+                    throw std::runtime_error("Baseline has no benchmarks array");
+                }
+                ++pos;
+                while (skipSpace() != ']') {
+                    std::map<std::string, std::string> fields = readObject();
+                    const double unit = unitInNs(fields["time_unit"]);
+                    if (fields.count("name") && fields.count("real_time") && fields["run_type"] != "aggregate") {
+                        times[fields["name"]] = std::stod(fields["real_time"]) * unit;
+                    }
+                    if (skipSpace() == ',') {
+                        ++pos;
+                    }
+                }
+                return times;
+            }
+
+        private:
+            std::string text;
+            size_t pos = 0;
+
+            static double unitInNs(const std::string& unit) {
+                if (unit == "us") return 1e3;
+                if (unit == "ms") return 1e6;
+                if (unit == "s") return 1e9;
+                return 1.0;
+            }
+
+            char skipSpace() {
+                while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+                    ++pos;
+                }
+                if (pos >= text.size()) {
+                    throw std::runtime_error("Baseline ends early");
+                }
+                return text[pos];
+            }
+
+            std::string readString() {
+                std::string out;
+                for (++pos; pos < text.size() && text[pos] != '"'; ++pos) {
+                    if (text[pos] == '\\') {
+                        ++pos;
+                    }
+                    out += text[pos];
+                }
+                ++pos;
+                return out;
+            }
+
+            // Scalars come back as text, objects and arrays are skipped and come back empty
+            std::string readValue() {
+                const char c = skipSpace();
+                if (c == '"') {
+                    return readString();
+                }
+                if (c == '{' || c == '[') {
+                    int depth = 0;
+                    do {
+                        if (text[pos] == '"') {
+                            readString();
+                            continue;
+                        }
+                        depth += (text[pos] == '{' || text[pos] == '[') - (text[pos] == '}' || text[pos] == ']');
+                        ++pos;
+                    } while (depth > 0 && pos < text.size());
+                    return std::string();
+                }
+                const size_t start = pos;
+                while (pos < text.size() && text[pos] != ',' && text[pos] != '}' && text[pos] != ']' &&
+                       !std::isspace(static_cast<unsigned char>(text[pos]))) {
+                    ++pos;
+                }
+                return text.substr(start, pos - start);
+            }
+
+            std::map<std::string, std::string> readObject() {
+                if (skipSpace() != '{') {
+                    throw std::runtime_error("Baseline benchmark entry is not an object");
+                }
+                ++pos;
+                std::map<std::string, std::string> fields;
+                while (skipSpace() != '}') {
+                    const std::string key = readString();
+                    if (skipSpace() != ':') {
+                        throw std::runtime_error("Baseline entry is missing a ':'");
+                    }
+                    ++pos;
+                    fields[key] = readValue();
+                    if (skipSpace() == ',') {
+                        ++pos;
+                    }
+                }
+                ++pos;
+                return fields;
+            }
+    };
+
+    // Prints the change of every benchmark present in both runs and lists the baseline benchmarks the
+    // filter selects but this run lacks. Returns the number of regressions plus missing benchmarks
+    int compare(const std::vector<Result>& results, const std::string& path, double threshold, const std::string& filter) {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("Cannot read baseline " + path);
+        }
+        std::stringstream text;
+        text << in.rdbuf();
+        const std::map<std::string, double> baseline = BaselineReader(text.str()).read();
+
+        std::cout << "\n=== Against " << path << ", threshold " << threshold * 100 << "% ===\n";
+        std::cout << std::left << std::setw(58) << "Benchmark" << std::setw(14) << "Baseline ns"
+                  << std::setw(14) << "Current ns" << "Change\n";
+        int regressions = 0;
+        for (const Result& r : results) {
+            const auto it = baseline.find(r.name);
+            if (it == baseline.end()) {
+                std::cout << std::left << std::setw(58) << r.name << "not in baseline\n";
+                continue;
+            }
+            const double change = r.realTime / it->second - 1.0;
+            const bool regressed = change > threshold;
+            regressions += regressed;
+            std::cout << std::left << std::setw(58) << r.name << std::fixed << std::setprecision(1)
+                      << std::setw(14) << it->second << std::setw(14) << r.realTime << std::showpos
+                      << change * 100 << "%" << std::noshowpos << (regressed ? "  REGRESSION" : "") << "\n";
+        }
+
+        int missing = 0;
+        for (const auto& entry : baseline) {
+            if (entry.first.find(filter) == std::string::npos) {
+                continue;
+            }
+            const bool ran = std::any_of(results.begin(), results.end(),
+                                         [&](const Result& r) { return r.name == entry.first; });
+            if (!ran) {
+                std::cout << std::left << std::setw(58) << entry.first << "MISSING from this run\n";
+                ++missing;
+            }
+        }
+        std::cout << (regressions ? std::to_string(regressions) + " regression(s)\n" : "No regressions\n");
+        if (missing) {
+            std::cout << missing << " baseline benchmark(s) missing\n";
+        }
+        return regressions + missing;
+    }
+
+    Settings parse(int argc, char** argv) {
+        Settings settings;
+        for (int i = 1; i < argc; ++i) {
+            const std::string flag = argv[i];
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + flag);
+            }
+            const std::string value = argv[++i];
+            if (flag == "--filter") {
+                settings.filter = value;
+            } else if (flag == "--min-time") {
+                settings.minTime = std::stod(value);
+            } else if (flag == "--repetitions") {
+                settings.repetitions = std::max(1, std::stoi(value));
+            } else if (flag == "--json") {
+                settings.jsonPath = value;
+            } else if (flag == "--compare") {
+                settings.baselinePath = value;
+            } else if (flag == "--threshold") {
+                settings.threshold = std::stod(value);
+            } else {
+                throw std::invalid_argument("Unknown option " + flag);
+            }
+        }
+        if (!(settings.minTime > 0) || !(settings.threshold >= 0)) {
+            throw std::invalid_argument("--min-time must be positive and --threshold non-negative");
+        }
+        return settings;
+    }
+}
+
+int main(int argc, char** argv) {
+    try {
+        const Settings settings = parse(argc, argv);
+
+        std::cout << std::left << std::setw(58) << "Benchmark" << std::setw(14) << "Time ns"
+                  << std::setw(14) << "CPU ns" << std::setw(14) << "Iterations" << "Items/s\n";
+        std::vector<Result> results;
+        for (const Benchmark& benchmark : registry()) {
+            if (benchmark.name.find(settings.filter) == std::string::npos) {
+                continue;
+            }
+            const Result r = run(benchmark, settings);
+            results.push_back(r);
+            std::cout << std::left << std::setw(58) << r.name << std::fixed << std::setprecision(1)
+                      << std::setw(14) << r.realTime << std::setw(14) << r.cpuTime << std::setw(14) << r.iterations
+                      << std::scientific << std::setprecision(3) << r.itemsPerSecond << std::fixed << std::endl;
+        }
+
+        if (!settings.jsonPath.empty()) {
+            writeJson(results, settings.jsonPath);
+            std::cout << "Wrote " << settings.jsonPath << "\n";
+        }
+        if (!settings.baselinePath.empty() && compare(results, settings.baselinePath, settings.threshold, settings.filter) > 0) {
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "bench_suite: " << e.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+// VolSurface: interpolation error off the grid, lookup latency, and pricing overhead against a flat vol
+#include "bench_common.hpp"
+#include "../vol_surface.hpp"
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    // Skewed smile that flattens with expiry, standing in for a market quote grid
+    double smile(double strike, double expiry) {
+        const double x = std::log(strike / 100.0) / std::sqrt(expiry);
+        return 0.2 - 0.04 * x + 0.06 * x * x / (1.0 + x * x) + 0.02 * std::exp(-expiry);
+    }
+
+    std::shared_ptr<const VolSurface> makeSurface(size_t strikeCount, size_t expiryCount) {
+        std::vector<double> strikes, expiries, vols;
+        for (size_t i = 0; i < strikeCount; ++i) {
+            strikes.push_back(40.0 + 140.0 * i / (strikeCount - 1));
+        }
+        for (size_t j = 0; j < expiryCount; ++j) {
+            // Denser at the short end, like listed expiries
+            const double u = static_cast<double>(j) / (expiryCount - 1);
+            expiries.push_back(0.02 + 2.0 * u * u);
+        }
+        for (const double t : expiries) {
+            for (const double k : strikes) {
+                vols.push_back(smile(k, t));
+            }
+        }
+        return std::make_shared<const VolSurface>(strikes, expiries, vols);
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t contracts = argc > 1 ? std::stoul(argv[1]) : 100000;
+
+    // Off-grid error against the generating smile
+    std::cout << "=== Interpolation error at 100000 random (K, T) ===\n";
+    std::cout << std::left << std::setw(16) << "Grid" << std::setw(16) << "Max error" << "RMS error\n";
+    const size_t grids[][2] = {{15, 6}, {29, 12}, {57, 24}};
+    for (const auto& grid : grids) {
+        const std::shared_ptr<const VolSurface> surface = makeSurface(grid[0], grid[1]);
+        std::mt19937_64 rng(3);
+        std::uniform_real_distribution<double> strike(60.0, 165.0), expiry(0.05, 2.0);
+        double maxError = 0.0, sumSquares = 0.0;
+        for (int n = 0; n < 100000; ++n) {
+            const double k = strike(rng), t = expiry(rng);
+            const double error = std::abs(surface->volatility(k, t) - smile(k, t));
+            maxError = std::max(maxError, error);
+            sumSquares += error * error;
+        }
+        std::cout << std::left << std::setw(16) << (std::to_string(grid[0]) + " x " + std::to_string(grid[1]))
+                  << std::scientific << std::setprecision(2) << std::setw(16) << maxError
+                  << std::sqrt(sumSquares / 100000) << std::fixed << "\n";
+    }
+
+    const std::shared_ptr<const VolSurface> surface = makeSurface(29, 12);
+    OptionChain chain = Bench::makeChain(contracts, Option::Style::EUROPEAN);
+    const OptionBatch batch = chain.batch();
+    std::vector<double> vols(contracts), prices(contracts);
+
+    std::cout << "\n=== Lookup, " << contracts << " contracts on a 29 x 12 grid ===\n";
+    double sink = 0.0;
+    const double scalarSeconds = Bench::bestTime([&] {
+        for (size_t i = 0; i < contracts; ++i) {
+            sink += surface->volatility(batch.strike[i], batch.expiry[i]);
+        }
+    });
+    const double batchSeconds = Bench::bestTime([&] {
+        surface->volatilities(batch.strike, batch.expiry, vols.data(), contracts);
+    });
+    std::cout << std::fixed << std::setprecision(1) << "volatility(K, T):   " << scalarSeconds * 1e9 / contracts << " ns\n"
+              << "volatilities(batch): " << batchSeconds * 1e9 / contracts << " ns per contract\n";
+
+    // Batch path: the surface fills the vol column once, the kernel is unchanged
+    std::cout << "\n=== Black-Scholes pricing, ns per contract ===\n";
+    BlackScholesPricer pricer;
+    const double flatBatch = Bench::bestTime([&] { pricer.calculatePrices(chain.batch(), prices.data(), contracts); });
+    const double surfaceBatch = Bench::bestTime([&] {
+        chain.applySurface(*surface);
+        pricer.calculatePrices(chain.batch(), prices.data(), contracts);
+    });
+
+    // Scalar path: MarketData carries the surface and the pricer reads the contract's vol
+    const MarketData flat(100.0, 0.03, 0.2);
+    const MarketData quoted(100.0, 0.03, surface);
+    const auto scalar = [&](const MarketData& marketData) {
+        return Bench::bestTime([&] {
+            for (size_t i = 0; i < contracts; ++i) {
+                sink += pricer.calculatePrice(Option(batch.type[i], batch.style[i], batch.strike[i], batch.expiry[i]), marketData);
+            }
+        });
+    };
+    const double flatScalar = scalar(flat);
+    const double surfaceScalar = scalar(quoted);
+
+    std::cout << std::left << std::setw(28) << "Path" << std::setw(12) << "Flat vol" << "Surface\n"
+              << std::setw(28) << "calculatePrices" << std::setprecision(1) << std::setw(12) << flatBatch * 1e9 / contracts
+              << surfaceBatch * 1e9 / contracts << "\n"
+              << std::setw(28) << "calculatePrice" << std::setw(12) << flatScalar * 1e9 / contracts
+              << surfaceScalar * 1e9 / contracts << "\n";
+    if (!std::isfinite(sink)) {
+        std::cout << "non-finite result\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,12 @@
+# Runs bench_suite for the bench target, comparing against BASELINE only when that file exists
+set(arguments --json ${RESULTS})
+if(EXISTS ${BASELINE})
+    list(APPEND arguments --compare ${BASELINE} --threshold ${THRESHOLD})
+else()
+    message(STATUS "No baseline at ${BASELINE}, run the bench_baseline target to store one")
+endif()
+
+execute_process(COMMAND ${SUITE} ${arguments} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "bench_suite failed or found regressions (exit code ${result})")
+endif()
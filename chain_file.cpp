@@ -0,0 +1,248 @@
+#include "chain_file.hpp"
+#include "batch_mode.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ChainFile {
+    namespace {
+        constexpr size_t ELEMENT_SIZE[COLUMN_COUNT] = {
+            sizeof(double), sizeof(double), sizeof(Option::Type), sizeof(Option::Style),
+            sizeof(double), sizeof(double), sizeof(double)
+        };
+        constexpr size_t CONVERT_CHUNK = 65536;
+        constexpr size_t COPY_BLOCK = 1 << 20;
+
+        size_t alignUp(size_t offset) {
+            return (offset + COLUMN_ALIGNMENT - 1) / COLUMN_ALIGNMENT * COLUMN_ALIGNMENT;
+        }
+
+        // Fills the header for count contracts, returns the file size
+        size_t layout(size_t count, Header& header) {
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = VERSION;
+            header.byteOrder = BYTE_ORDER_MARK;
+            header.count = count;
+
+            size_t offset = sizeof(Header);
+            for (int c = 0; c < COLUMN_COUNT; ++c) {
+                offset = alignUp(offset);
+                header.offsets[c] = offset;
+                offset += count * ELEMENT_SIZE[c];
+            }
+            header.fileSize = offset;
+            return offset;
+        }
+
+        const void* columnData(const OptionBatch& batch, int c) {
+            switch (c) {
+                case STRIKE: return batch.strike;
+                case EXPIRY: return batch.expiry;
+                case TYPE: return batch.type;
+                case STYLE: return batch.style;
+                case SPOT: return batch.spot;
+                case RATE: return batch.riskFreeRate;
+                default: return batch.volatility;
+            }
+        }
+
+        // Owns a stdio stream, closing it on every exit path
+        class File {
+            public:
+                File(FILE* handle, const std::string& path) : handle(handle), path(path) {
+                    if (!handle) {
+                        throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+                    }
+                }
+                ~File() {
+                    if (handle) {
+                        std::fclose(handle);
+                    }
+                }
+                File(const File&) = delete;
+                File& operator=(const File&) = delete;
+
+                void write(const void* data, size_t bytes) {
+                    if (bytes > 0 && std::fwrite(data, 1, bytes, handle) != bytes) {
+                        throw std::runtime_error("Failed writing " + path);
+                    }
+                }
+
+                // Zero fill up to offset, keeps the next column aligned
+                void padTo(size_t offset) {
+                    static const char zeros[COLUMN_ALIGNMENT] = {};
+                    const long position = std::ftell(handle);
+                    if (position < 0 || static_cast<size_t>(position) > offset) {
+                        throw std::runtime_error("Failed writing " + path);
+                    }
+                    write(zeros, offset - static_cast<size_t>(position));
+                }
+
+                void close() {
+                    FILE* closing = handle;
+                    handle = nullptr;
+                    if (std::fclose(closing) != 0) {
+                        throw std::runtime_error("Failed writing " + path);
+                    }
+                }
+
+                FILE* get() const { return handle; }
+
+            private:
+                FILE* handle;
+                std::string path;
+        };
+    }
+
+    bool isChainFile(const std::string& path) {
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        char magic[sizeof(MAGIC)];
+        const bool match = std::fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                           std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+        std::fclose(file);
+        return match;
+    }
+
+    void write(const std::string& path, const OptionBatch& batch) {
+        Header header;
+        layout(batch.size, header);
+
+        File file(std::fopen(path.c_str(), "wb"), path);
+        file.write(&header, sizeof(header));
+        for (int c = 0; c < COLUMN_COUNT; ++c) {
+            file.padTo(header.offsets[c]);
+            file.write(columnData(batch, c), batch.size * ELEMENT_SIZE[c]);
+        }
+        file.close();
+    }
+
+    size_t convert(const std::string& inputPath, const std::string& outputPath) {
+        // The count is only known at the end, so columns are spilled to temporary files first
+        BatchMode::ChainReader reader(inputPath);
+        std::vector<std::unique_ptr<File>> spills;
+        for (int c = 0; c < COLUMN_COUNT; ++c) {
+            spills.push_back(std::make_unique<File>(std::tmpfile(), "temporary column file"));
+        }
+
+        OptionChain chunk;
+        chunk.reserve(CONVERT_CHUNK);
+        size_t count = 0;
+        while (reader.read(chunk, CONVERT_CHUNK)) {
+            const OptionBatch batch = chunk.batch();
+            for (int c = 0; c < COLUMN_COUNT; ++c) {
+                spills[c]->write(columnData(batch, c), batch.size * ELEMENT_SIZE[c]);
+            }
+            count += batch.size;
+            chunk.clear();
+        }
+
+        Header header;
+        layout(count, header);
+
+        File output(std::fopen(outputPath.c_str(), "wb"), outputPath);
+        output.write(&header, sizeof(header));
+        std::vector<char> block(COPY_BLOCK);
+        for (int c = 0; c < COLUMN_COUNT; ++c) {
+            output.padTo(header.offsets[c]);
+            std::rewind(spills[c]->get());
+            size_t got;
+            while ((got = std::fread(block.data(), 1, block.size(), spills[c]->get())) > 0) {
+                output.write(block.data(), got);
+            }
+            if (std::ferror(spills[c]->get())) {
+                throw std::runtime_error("Failed reading temporary column file");
+            }
+        }
+        output.close();
+        return count;
+    }
+
+    MappedChain::MappedChain(const std::string& path) : path(path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Header))) {
+            ::close(fd);
+            throw std::runtime_error(path + ": not a chain file");
+        }
+
+        mappedSize = static_cast<size_t>(info.st_size);
+        void* mapping = ::mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("Cannot map " + path + ": " + std::strerror(errno));
+        }
+        data = static_cast<const char*>(mapping);
+        // Pricing walks every column front to back
+        ::madvise(mapping, mappedSize, MADV_SEQUENTIAL);
+
+        Header header;
+        std::memcpy(&header, data, sizeof(header));
+        const char* problem = nullptr;
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+            problem = "not a chain file";
+        } else if (header.byteOrder != BYTE_ORDER_MARK) {
+            problem = "written with a different byte order";
+        } else if (header.version != VERSION) {
+            problem = "unsupported chain file version";
+        } else if (header.fileSize != mappedSize || header.count > mappedSize / sizeof(int32_t)) {
+            problem = "truncated or corrupt chain file";
+        } else {
+            for (int c = 0; c < COLUMN_COUNT && !problem; ++c) {
+                const uint64_t offset = header.offsets[c];
+                if (offset < sizeof(Header) || offset % COLUMN_ALIGNMENT != 0 ||
+                    offset > mappedSize || header.count * ELEMENT_SIZE[c] > mappedSize - offset) {
+                    problem = "column outside the file";
+                }
+            }
+        }
+        if (problem) {
+            ::munmap(mapping, mappedSize);
+            throw std::runtime_error(path + ": " + problem);
+        }
+
+        count = header.count;
+        std::memcpy(offsets, header.offsets, sizeof(offsets));
+    }
+
+    MappedChain::~MappedChain() {
+        ::munmap(const_cast<char*>(data), mappedSize);
+    }
+
+    OptionBatch MappedChain::batch() const {
+        return OptionBatch{
+            reinterpret_cast<const double*>(column(STRIKE)),
+            reinterpret_cast<const double*>(column(EXPIRY)),
+            reinterpret_cast<const Option::Type*>(column(TYPE)),
+            reinterpret_cast<const Option::Style*>(column(STYLE)),
+            reinterpret_cast<const double*>(column(SPOT)),
+            reinterpret_cast<const double*>(column(RATE)),
+            reinterpret_cast<const double*>(column(VOLATILITY)),
+            count
+        };
+    }
+
+    void MappedChain::verify(size_t begin, size_t end) const {
+        const int32_t* types = reinterpret_cast<const int32_t*>(column(TYPE));
+        const int32_t* styles = reinterpret_cast<const int32_t*>(column(STYLE));
+        for (size_t i = begin; i < std::min(end, count); ++i) {
+            if ((types[i] != 0 && types[i] != 1) || (styles[i] != 0 && styles[i] != 1)) {
+                throw std::runtime_error(path + ": invalid type or style for contract " + std::to_string(i));
+            }
+        }
+    }
+}
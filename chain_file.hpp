@@ -0,0 +1,76 @@
+#pragma once
+
+#include "options_classes.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Versioned columnar chain file, loaded with mmap and priced in place
+//
+// Layout: a 128-byte Header followed by one column per field, each starting on a 64-byte
+// boundary. strike, expiry, spot, rate and volatility are doubles, type and style are int32
+// holding the Option::Type / Option::Style values, so the mapped columns are exactly the
+// arrays an OptionBatch points at. Everything is in native byte order, byteOrder rejects
+// files written on a machine of the other endianness
+namespace ChainFile {
+    constexpr char MAGIC[8] = {'O', 'P', 'T', 'C', 'H', 'A', 'I', 'N'};
+    constexpr uint32_t VERSION = 1;
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+    constexpr size_t COLUMN_ALIGNMENT = 64;
+
+    enum Column { STRIKE, EXPIRY, TYPE, STYLE, SPOT, RATE, VOLATILITY, COLUMN_COUNT };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t count;                   // contracts
+        uint64_t fileSize;                // bytes, catches truncated copies
+        uint64_t offsets[COLUMN_COUNT];   // byte offset of each column from the start of the file
+        uint8_t reserved[40];
+    };
+    static_assert(sizeof(Header) == 128, "Header must stay 128 bytes");
+    static_assert(sizeof(Option::Type) == 4 && sizeof(Option::Style) == 4,
+                  "type and style columns are stored as int32");
+    static_assert(static_cast<int>(Option::Type::PUT) == 1 && static_cast<int>(Option::Style::AMERICAN) == 1,
+                  "stored type and style values follow the enum order");
+
+    // True when path starts with the chain file magic
+    bool isChainFile(const std::string& path);
+
+    void write(const std::string& path, const OptionBatch& batch);
+
+    // Streams a CSV or packed record file (see batch_mode.hpp) into a chain file with bounded
+    // memory, returns the number of contracts written
+    size_t convert(const std::string& inputPath, const std::string& outputPath);
+
+    // Read-only mapping of a chain file. Opening checks the header and column bounds only,
+    // so it costs the same for ten contracts or ten million; pages load as they are priced
+    class MappedChain {
+        public:
+            explicit MappedChain(const std::string& path);
+            ~MappedChain();
+
+            MappedChain(const MappedChain&) = delete;
+            MappedChain& operator=(const MappedChain&) = delete;
+
+            size_t size() const { return count; }
+
+            // Columns point straight into the mapping and stay valid while this object lives
+            OptionBatch batch() const;
+
+            // Scans the type and style columns of contracts [begin, end), throws std::runtime_error
+            // on values other than 0 and 1. Cheap enough to run per chunk just ahead of pricing
+            void verify(size_t begin, size_t end) const;
+            void verify() const { verify(0, count); }
+
+        private:
+            const char* column(Column c) const { return data + offsets[c]; }
+
+            std::string path;
+            const char* data = nullptr;
+            size_t mappedSize = 0;
+            size_t count = 0;
+            uint64_t offsets[COLUMN_COUNT] = {};
+    };
+}
@@ -0,0 +1,47 @@
+#include "chain_pricer.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+ChainPricer::ChainPricer(WorkStealingPool& pool, size_t tileSize)
+    : pool(pool), tileSize(tileSize) {
+    if (tileSize == 0) {
+        throw std::invalid_argument("Tile size must be positive");
+    }
+}
+
+void ChainPricer::price(PricingStrategy& strategy, const OptionBatch& batch, double* prices, size_t count) {
+    if (count < batch.size) {
+        throw std::invalid_argument("Output buffer is smaller than the batch");
+    }
+
+    const size_t tiles = (batch.size + tileSize - 1) / tileSize;
+    pool.parallelFor(tiles, [&](size_t t) {
+        const size_t begin = t * tileSize;
+        const size_t end = std::min(batch.size, begin + tileSize);
+        strategy.calculatePrices(batch.slice(begin, end), prices + begin, end - begin);
+    });
+}
+
+void ChainPricer::priceWithGreeks(PricingStrategy& strategy, const OptionBatch& batch, const GreeksBatch& greeks,
+                                  size_t count) {
+    if (count < batch.size) {
+        throw std::invalid_argument("Output buffer is smaller than the batch");
+    }
+
+    const size_t tiles = (batch.size + tileSize - 1) / tileSize;
+    pool.parallelFor(tiles, [&](size_t t) {
+        const size_t begin = t * tileSize;
+        const size_t end = std::min(batch.size, begin + tileSize);
+        const GreeksBatch out{
+            greeks.price + begin, greeks.delta + begin, greeks.gamma + begin,
+            greeks.theta + begin, greeks.vega + begin, greeks.rho + begin
+        };
+        strategy.calculatePricesAndGreeks(batch.slice(begin, end), out, end - begin);
+    });
+}
+
+std::vector<double> ChainPricer::price(PricingStrategy& strategy, const OptionChain& chain) {
+    std::vector<double> prices(chain.size());
+    price(strategy, chain.batch(), prices.data(), prices.size());
+    return prices;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "options_classes.hpp"
+#include "thread_pool.hpp"
+#include <vector>
+
+// Prices large chains with any PricingStrategy on a work-stealing pool
+//
+// The chain is cut into fixed-size tiles and each tile goes through the strategy's batch
+// entry point. Tile boundaries depend only on tileSize and every contract is priced
+// independently, so results are bit-identical for any thread count. Cheap Black-Scholes
+// tiles and expensive American lattice tiles balance through stealing.
+// Strategies must be safe to call concurrently, which the built-in pricers are
+class ChainPricer {
+    public:
+        explicit ChainPricer(WorkStealingPool& pool, size_t tileSize = 256);
+
+        void price(PricingStrategy& strategy, const OptionBatch& batch, double* prices, size_t count);
+        void priceWithGreeks(PricingStrategy& strategy, const OptionBatch& batch, const GreeksBatch& greeks, size_t count);
+
+        std::vector<double> price(PricingStrategy& strategy, const OptionChain& chain);
+
+        size_t getTileSize() const { return tileSize; }
+
+    private:
+        WorkStealingPool& pool;
+        size_t tileSize;
+};
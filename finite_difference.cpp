@@ -0,0 +1,432 @@
+#include "finite_difference.hpp"
+#include "instrumentation.hpp"
+#include "term_structure.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    constexpr int LANES = 4;  // contracts solved side by side in a batch or Greeks pass
+
+    // Per-thread grid and solver buffers, node-major with the lanes of a node adjacent,
+    // grown to the largest grid seen and reused
+    struct Workspace {
+        std::vector<double> spots;
+        std::vector<double> values;
+        std::vector<double> exercise;
+        std::vector<double> rhs;
+        std::vector<double> pivots;  // reciprocal pivots of each lane's current time-stepping matrix
+
+        void reserve(size_t size) {
+            if (values.size() < size) {
+                spots.resize(size);
+                values.resize(size);
+                exercise.resize(size);
+                rhs.resize(size);
+                pivots.resize(size);
+            }
+        }
+    };
+    thread_local Workspace workspace;
+
+    struct Contract {
+        double S, K, r, sigma, T;
+    };
+
+    struct Solution {
+        double price;
+        double delta;
+        double gamma;
+        double theta;
+    };
+
+    void validate(double S, double K, double T, double sigma) {
+        if (S <= 0 || K <= 0 || T <= 0 || sigma <= 0) {
+            throw std::invalid_argument("Invalid parameters: All values must be positive");
+        }
+    }
+
+    // The grid has no dividends or rate term structure, so American contracts need flat market data
+    void validateCarry(bool flat, bool isAmerican) {
+        if (isAmerican && !flat) {
+            throw std::invalid_argument("Finite differences price American contracts only on flat market data, use BinomialPricer under a carry");
+        }
+    }
+
+    // Europeans under a Carry are flat contracts on the prepaid forward with the zero rate to expiry
+    Contract contractFor(const Option& option, const MarketData& marketData) {
+        validateCarry(marketData.isFlat(), option.getStyle() == Option::Style::AMERICAN);
+        const double T = option.getExpiry();
+        const Contract contract{marketData.getPrepaidForward(T), option.getStrike(), marketData.getRiskFreeRate(T),
+                                marketData.getVolatility(option), T};
+        validate(contract.S, contract.K, contract.T, contract.sigma);
+        return contract;
+    }
+
+    // Payoff averaged over the cell [x - h/2, x + h/2] in log spot, removes the strike's
+    // dependence on where it falls between nodes
+    double cellAverage(double x, double h, double K, double logStrike, bool isCall) {
+        const double lo = x - 0.5 * h;
+        const double hi = x + 0.5 * h;
+        if (isCall) {
+            const double a = std::max(lo, logStrike);
+            return a < hi ? (exp(hi) - exp(a) - K * (hi - a)) / h : 0.0;
+        }
+        const double b = std::min(hi, logStrike);
+        return b > lo ? (K * (b - lo) - (exp(b) - exp(lo))) / h : 0.0;
+    }
+
+    // Solves L contracts of one type and style on grids of the same shape. Each Thomas
+    // recurrence is a serial chain of dependent multiply-adds, so one contract leaves the core
+    // waiting on latency; interleaving L independent chains node by node fills that gap
+    template <int L>
+    void solveLanes(const FiniteDifferenceSettings& settings, const Contract* contracts, bool isCall, bool isAmerican,
+                    Solution* out) {
+        const int M = settings.spaceSteps + (settings.spaceSteps & 1);
+        const int center = M / 2;
+
+        workspace.reserve(static_cast<size_t>(M + 1) * L);
+        double* spots = workspace.spots.data();
+        double* values = workspace.values.data();
+        double* exercise = workspace.exercise.data();
+        double* rhs = workspace.rhs.data();
+        double* pivots = workspace.pivots.data();
+
+        // Uniform log-spot grid per lane, wide enough for the strike, with today's spot on the center node
+        double h[L], lower[L], diagonal[L], upper[L];
+        const double sign = isCall ? 1.0 : -1.0;
+        for (int k = 0; k < L; ++k) {
+            const Contract& c = contracts[k];
+            const double logStrike = log(c.K);
+            const double halfWidth = settings.stdDevs * c.sigma * sqrt(c.T) + std::abs(logStrike - log(c.S));
+            h[k] = 2.0 * halfWidth / M;
+
+            // V_tau = a V_xx + b V_x - r V, central differences give a constant three-point stencil
+            const double a = 0.5 * c.sigma * c.sigma / (h[k] * h[k]);
+            const double b = (c.r - 0.5 * c.sigma * c.sigma) / (2.0 * h[k]);
+            lower[k] = a - b;
+            diagonal[k] = -2.0 * a - c.r;
+            upper[k] = a + b;
+
+            const double x0 = log(c.S) - center * h[k];
+            for (int j = 0; j <= M; ++j) {
+                const double x = x0 + j * h[k];
+                spots[j * L + k] = exp(x);
+                exercise[j * L + k] = std::max(0.0, sign * (spots[j * L + k] - c.K));
+                values[j * L + k] = (j == 0 || j == M) ? exercise[j * L + k] : cellAverage(x, h[k], c.K, logStrike, isCall);
+            }
+        }
+
+        // Brennan-Schwartz eliminates away from the exercise region: upward for calls, downward for puts
+        const bool reverse = isAmerican && !isCall;
+
+        double A[L], C[L];
+        auto prepare = [&](double theta, double fraction) {
+            for (int k = 0; k < L; ++k) {
+                const double dt = fraction * contracts[k].T;
+                const double a = -theta * dt * lower[k];
+                const double b = 1.0 - theta * dt * diagonal[k];
+                const double c = -theta * dt * upper[k];
+                A[k] = a;
+                C[k] = c;
+                // The matrix is diagonally dominant, so the pivot recurrence settles to its fixed
+                // point within a few dozen rows and the rest is filled instead of dividing per node
+                if (reverse) {
+                    pivots[(M - 1) * L + k] = 1.0 / b;
+                    for (int j = M - 2; j >= 1; --j) {
+                        const double pivot = 1.0 / (b - c * pivots[(j + 1) * L + k] * a);
+                        pivots[j * L + k] = pivot;
+                        if (std::abs(pivot - pivots[(j + 1) * L + k]) <= 1e-15 * pivot) {
+                            for (int i = j - 1; i >= 1; --i) {
+                                pivots[i * L + k] = pivot;
+                            }
+                            break;
+                        }
+                    }
+                } else {
+                    pivots[L + k] = 1.0 / b;
+                    for (int j = 2; j <= M - 1; ++j) {
+                        const double pivot = 1.0 / (b - a * pivots[(j - 1) * L + k] * c);
+                        pivots[j * L + k] = pivot;
+                        if (std::abs(pivot - pivots[(j - 1) * L + k]) <= 1e-15 * pivot) {
+                            for (int i = j + 1; i <= M - 1; ++i) {
+                                pivots[i * L + k] = pivot;
+                            }
+                            break;
+                        }
+                    }
+                }
+            }
+        };
+
+        // One theta-scheme step of length fraction * T per lane, ending at tau = end * T
+        auto step = [&](double theta, double fraction, double end) {
+            prepare(theta, fraction);
+
+            double l[L], d[L], u[L];
+            for (int k = 0; k < L; ++k) {
+                const double dt = (1.0 - theta) * fraction * contracts[k].T;
+                l[k] = dt * lower[k];
+                d[k] = 1.0 + dt * diagonal[k];
+                u[k] = dt * upper[k];
+            }
+            for (int j = 1; j < M; ++j) {
+                for (int k = 0; k < L; ++k) {
+                    rhs[j * L + k] = l[k] * values[(j - 1) * L + k] + d[k] * values[j * L + k] + u[k] * values[(j + 1) * L + k];
+                }
+            }
+
+            // Dirichlet boundaries at the new time level
+            for (int k = 0; k < L; ++k) {
+                const Contract& c = contracts[k];
+                const double discountedStrike = c.K * exp(-c.r * end * c.T);
+                double& bottom = values[k];
+                double& top = values[M * L + k];
+                if (isCall) {
+                    bottom = 0.0;
+                    top = spots[M * L + k] - discountedStrike;
+                    if (isAmerican) {
+                        top = std::max(top, exercise[M * L + k]);
+                    }
+                } else {
+                    bottom = discountedStrike - spots[k];
+                    if (isAmerican) {
+                        bottom = std::max(bottom, exercise[k]);
+                    }
+                    top = 0.0;
+                }
+                rhs[L + k] -= A[k] * bottom;
+                rhs[(M - 1) * L + k] -= C[k] * top;
+            }
+
+            // Recurrences carry the previous row in registers rather than re-reading the store
+            double carry[L], value[L];
+            if (reverse) {
+                for (int k = 0; k < L; ++k) {
+                    carry[k] = rhs[(M - 1) * L + k];
+                    value[k] = values[k];
+                }
+                for (int j = M - 2; j >= 1; --j) {
+                    for (int k = 0; k < L; ++k) {
+                        carry[k] = rhs[j * L + k] - C[k] * pivots[(j + 1) * L + k] * carry[k];
+                        rhs[j * L + k] = carry[k];
+                    }
+                }
+                for (int j = 1; j < M; ++j) {
+                    for (int k = 0; k < L; ++k) {
+                        const double pivot = pivots[j * L + k];
+                        value[k] = std::max(rhs[j * L + k] * pivot - A[k] * pivot * value[k], exercise[j * L + k]);
+                        values[j * L + k] = value[k];
+                    }
+                }
+            } else {
+                for (int k = 0; k < L; ++k) {
+                    carry[k] = rhs[L + k];
+                    value[k] = values[M * L + k];
+                }
+                for (int j = 2; j < M; ++j) {
+                    for (int k = 0; k < L; ++k) {
+                        carry[k] = rhs[j * L + k] - A[k] * pivots[(j - 1) * L + k] * carry[k];
+                        rhs[j * L + k] = carry[k];
+                    }
+                }
+                for (int j = M - 1; j >= 1; --j) {
+                    for (int k = 0; k < L; ++k) {
+                        const double pivot = pivots[j * L + k];
+                        value[k] = rhs[j * L + k] * pivot - C[k] * pivot * value[k];
+                        if (isAmerican) {
+                            value[k] = std::max(value[k], exercise[j * L + k]);
+                        }
+                        values[j * L + k] = value[k];
+                    }
+                }
+            }
+        };
+
+        // March to expiry on tau_n = T (n / N)^2: the early-exercise boundary moves like sqrt(tau)
+        // near expiry, so uniform steps would leave first-order error in American prices
+        const int steps = settings.timeSteps;
+        const int rannacher = std::min(settings.rannacherSteps, steps);
+        double previous = 0.0;
+        for (int n = 0; n < steps; ++n) {
+            const double next = (n + 1.0) * (n + 1.0) / (static_cast<double>(steps) * steps);
+            const double fraction = next - previous;
+            if (n < rannacher) {
+                step(1.0, 0.5 * fraction, previous + 0.5 * fraction);
+                step(1.0, 0.5 * fraction, next);
+            } else {
+                step(0.5, fraction, next);
+            }
+            previous = next;
+        }
+
+        for (int k = 0; k < L; ++k) {
+            const Contract& c = contracts[k];
+            const double price = values[center * L + k];
+            const double up = values[(center + 1) * L + k];
+            const double down = values[(center - 1) * L + k];
+            const double dx = (up - down) / (2.0 * h[k]);
+            const double dxx = (up - 2.0 * price + down) / (h[k] * h[k]);
+
+            // Theta from the PDE itself where the contract is held, second order like delta and gamma.
+            // Past the early-exercise boundary the value is the payoff, which does not decay
+            double theta = c.r * price - (c.r - 0.5 * c.sigma * c.sigma) * dx - 0.5 * c.sigma * c.sigma * dxx;
+            if (isAmerican && price <= exercise[center * L + k]) {
+                theta = 0.0;
+            }
+            out[k] = Solution{price, dx / c.S, (dxx - dx) / (c.S * c.S), theta};
+        }
+    }
+
+    // Greeks of a solved contract: vega and rho from four bumped re-solves sharing one interleaved
+    // pass, delta and gamma taken in the prepaid forward and restated against the spot by dFdS
+    PriceWithGreeks withGreeks(const FiniteDifferenceSettings& settings, const Contract& base, const Solution& solution,
+                               bool isCall, bool isAmerican, double dFdS) {
+        const double S = base.S;
+        const double K = base.K;
+        const double r = base.r;
+        const double sigma = base.sigma;
+        const double T = base.T;
+
+        const double rateBump = 1e-4;
+        const double volBump = std::min(1e-2, 0.5 * sigma);
+        const Contract bumped[LANES] = {
+            {S, K, r + rateBump, sigma, T}, {S, K, r - rateBump, sigma, T},
+            {S, K, r, sigma + volBump, T}, {S, K, r, sigma - volBump, T}
+        };
+        Solution bumps[LANES];
+        solveLanes<LANES>(settings, bumped, isCall, isAmerican, bumps);
+        const double rho = (bumps[0].price - bumps[1].price) / (2 * rateBump);
+        const double vega = (bumps[2].price - bumps[3].price) / (2 * volBump);
+
+        return PriceWithGreeks{solution.price, Greeks{solution.delta * dFdS, solution.gamma * dFdS * dFdS, solution.theta,
+                                                      vega, rho}};
+    }
+}
+
+FiniteDifferencePricer::FiniteDifferencePricer(const FiniteDifferenceSettings& settings) : settings(settings) {
+    if (settings.spaceSteps < 4 || settings.timeSteps < 1 || settings.rannacherSteps < 0 || !(settings.stdDevs > 0)) {
+        throw std::invalid_argument("Finite difference grid needs at least 4 space steps, 1 time step and a positive width");
+    }
+}
+
+double FiniteDifferencePricer::calculatePrice(const Option& option, const MarketData& marketData) {
+    OPTIONS_TIME_SCOPE(FINITE_DIFFERENCE_PRICE);
+    const Contract contract = contractFor(option, marketData);
+
+    Solution solution;
+    solveLanes<1>(settings, &contract, option.getType() == Option::Type::CALL,
+                  option.getStyle() == Option::Style::AMERICAN, &solution);
+    return solution.price;
+}
+
+// Same-kind contracts go through the grid four at a time, the rest one by one
+void FiniteDifferencePricer::calculatePrices(const OptionBatch& batch, double* prices, size_t count) {
+    OPTIONS_TIME_SCOPE(FINITE_DIFFERENCE_BATCH);
+    if (count < batch.size) {
+        throw std::invalid_argument("Output buffer is smaller than the batch");
+    }
+    for (size_t i = 0; i < batch.size; ++i) {
+        validate(batch.spot[i], batch.strike[i], batch.expiry[i], batch.volatility[i]);
+        validateCarry(batch.isFlat(i), batch.style[i] == Option::Style::AMERICAN);
+    }
+
+    for (const Option::Type type : {Option::Type::CALL, Option::Type::PUT}) {
+        for (const Option::Style style : {Option::Style::EUROPEAN, Option::Style::AMERICAN}) {
+            const bool isCall = type == Option::Type::CALL;
+            const bool isAmerican = style == Option::Style::AMERICAN;
+            Contract contracts[LANES];
+            size_t rows[LANES];
+            int pending = 0;
+            for (size_t i = 0; i < batch.size; ++i) {
+                if (batch.type[i] != type || batch.style[i] != style) {
+                    continue;
+                }
+                contracts[pending] = Contract{batch.spot[i], batch.strike[i], batch.riskFreeRate[i],
+                                              batch.volatility[i], batch.expiry[i]};
+                rows[pending++] = i;
+                if (pending == LANES) {
+                    Solution solutions[LANES];
+                    solveLanes<LANES>(settings, contracts, isCall, isAmerican, solutions);
+                    for (int k = 0; k < LANES; ++k) {
+                        prices[rows[k]] = solutions[k].price;
+                    }
+                    pending = 0;
+                }
+            }
+            for (int k = 0; k < pending; ++k) {
+                Solution solution;
+                solveLanes<1>(settings, &contracts[k], isCall, isAmerican, &solution);
+                prices[rows[k]] = solution.price;
+            }
+        }
+    }
+}
+
+PriceWithGreeks FiniteDifferencePricer::calculatePriceAndGreeks(const Option& option, const MarketData& marketData) {
+    OPTIONS_TIME_SCOPE(FINITE_DIFFERENCE_GREEKS);
+    const Contract base = contractFor(option, marketData);
+    const bool isCall = option.getType() == Option::Type::CALL;
+    const bool isAmerican = option.getStyle() == Option::Style::AMERICAN;
+
+    Solution solution;
+    solveLanes<1>(settings, &base, isCall, isAmerican, &solution);
+    return withGreeks(settings, base, solution, isCall, isAmerican, marketData.getForwardDelta(base.T));
+}
+
+// Base solves four same-kind contracts to a pass as calculatePrices does, then each contract's
+// bumped re-solves take one more pass
+void FiniteDifferencePricer::calculatePricesAndGreeks(const OptionBatch& batch, const GreeksBatch& greeks, size_t count) {
+    OPTIONS_TIME_SCOPE(FINITE_DIFFERENCE_BATCH);
+    if (count < batch.size) {
+        throw std::invalid_argument("Output buffer is smaller than the batch");
+    }
+    for (size_t i = 0; i < batch.size; ++i) {
+        validate(batch.spot[i], batch.strike[i], batch.expiry[i], batch.volatility[i]);
+        validateCarry(batch.isFlat(i), batch.style[i] == Option::Style::AMERICAN);
+    }
+
+    for (const Option::Type type : {Option::Type::CALL, Option::Type::PUT}) {
+        for (const Option::Style style : {Option::Style::EUROPEAN, Option::Style::AMERICAN}) {
+            const bool isCall = type == Option::Type::CALL;
+            const bool isAmerican = style == Option::Style::AMERICAN;
+            Contract contracts[LANES];
+            size_t rows[LANES];
+            int pending = 0;
+            auto store = [&](int k, const Solution& solution) {
+                const size_t i = rows[k];
+                const Carry* carry = batch.carry ? batch.carry[i] : nullptr;
+                const double dFdS = carry ? exp(-carry->dividendYield() * batch.expiry[i]) : 1.0;
+                const PriceWithGreeks result = withGreeks(settings, contracts[k], solution, isCall, isAmerican, dFdS);
+                greeks.price[i] = result.price;
+                greeks.delta[i] = result.greeks.delta;
+                greeks.gamma[i] = result.greeks.gamma;
+                greeks.theta[i] = result.greeks.theta;
+                greeks.vega[i] = result.greeks.vega;
+                greeks.rho[i] = result.greeks.rho;
+            };
+            for (size_t i = 0; i < batch.size; ++i) {
+                if (batch.type[i] != type || batch.style[i] != style) {
+                    continue;
+                }
+                contracts[pending] = Contract{batch.spot[i], batch.strike[i], batch.riskFreeRate[i],
+                                              batch.volatility[i], batch.expiry[i]};
+                rows[pending++] = i;
+                if (pending == LANES) {
+                    Solution solutions[LANES];
+                    solveLanes<LANES>(settings, contracts, isCall, isAmerican, solutions);
+                    for (int k = 0; k < LANES; ++k) {
+                        store(k, solutions[k]);
+                    }
+                    pending = 0;
+                }
+            }
+            for (int k = 0; k < pending; ++k) {
+                Solution solution;
+                solveLanes<1>(settings, &contracts[k], isCall, isAmerican, &solution);
+                store(k, solution);
+            }
+        }
+    }
+}
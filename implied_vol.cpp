@@ -0,0 +1,227 @@
+#include "implied_vol.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    constexpr size_t TILE = 1024;  // contracts inverted in lockstep
+    constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+}
+
+ImpliedVolSolver::ImpliedVolSolver(double tolerance, int maxIterations, bool vectorized)
+    : tolerance(tolerance), maxIterations(maxIterations), blackScholes(vectorized) {
+    if (!(tolerance > 0) || maxIterations <= 0) {
+        throw std::invalid_argument("Tolerance and iteration limit must be positive");
+    }
+}
+
+// Checks the no-arbitrage bounds and seeds the search, false when no volatility can match
+bool ImpliedVolSolver::start(Search& search, Option::Type type, double S, double K, double r, double T,
+                             double price) const {
+    search = Search{price, NaN, MIN_VOLATILITY, MAX_VOLATILITY, 0.0, 0, false};
+    if (!(S > 0 && K > 0 && T > 0) || !std::isfinite(S + K + T + r + price)) {
+        return false;
+    }
+
+    const bool isCall = type == Option::Type::CALL;
+    const double X = K * exp(-r * T);
+    const double lower = isCall ? std::max(S - X, 0.0) : std::max(X - S, 0.0);
+    const double upper = isCall ? S : X;
+    if (!(price > lower && price < upper)) {
+        return false;
+    }
+
+    // Corrado-Miller on the call with the same strike, puts map over by put-call parity
+    const double call = isCall ? price : price + S - X;
+    const double a = call - 0.5 * (S - X);
+    const double radicand = std::max(a * a - (S - X) * (S - X) / M_PI, 0.0);
+    const double guess = sqrt(2.0 * M_PI) / (S + X) * (a + sqrt(radicand)) / sqrt(T);
+
+    search.vol = std::isfinite(guess) ? std::clamp(guess, 1e-4, 5.0) : 0.2;
+    search.logMoneyness = log(S / K) + r * T;
+    return true;
+}
+
+// One step from a fresh model price and vega at search.vol, true once the search is over
+bool ImpliedVolSolver::advance(Search& search, double price, double vega, double T, bool halley) const {
+    ++search.iterations;
+    const double error = price - search.target;
+    if (std::abs(error) <= tolerance) {
+        search.converged = true;
+        return true;
+    }
+
+    // Price rises with volatility, so the sign of the error tightens the bracket
+    if (error > 0) {
+        search.hi = search.vol;
+    } else {
+        search.lo = search.vol;
+    }
+
+    double next = NaN;
+    if (vega > 0) {
+        const double newton = error / vega;
+        next = search.vol - newton;
+        if (halley) {
+            // volga / vega = d1 d2 / sigma, and d1 d2 = x^2 / (sigma^2 T) - sigma^2 T / 4
+            const double variance = search.vol * search.vol * T;
+            const double curvature = (search.logMoneyness * search.logMoneyness / variance - 0.25 * variance) / search.vol;
+            const double denominator = 1.0 - 0.5 * newton * curvature;
+            if (denominator > 0.5) {
+                next = search.vol - newton / denominator;
+            }
+        }
+    }
+    if (!(next > search.lo && next < search.hi)) {
+        next = 0.5 * (search.lo + search.hi);
+    }
+
+    // Bracket narrower than the volatility can resolve, the price is as close as it gets but still
+    // outside tolerance, so the search stops unconverged
+    if (search.hi - search.lo <= 1e-14 * search.hi) {
+        search.vol = next;
+        return true;
+    }
+
+    search.vol = next;
+    return search.iterations >= maxIterations;
+}
+
+ImpliedVolSolver::Result ImpliedVolSolver::solve(const Option& option, const MarketData& marketData, double price) {
+    if (option.getStyle() == Option::Style::AMERICAN) {
+        return solveAmerican(option, marketData, price);
+    }
+
+    // Under a Carry the contract is a flat one on the prepaid forward, as BlackScholesPricer prices it
+    const double T = option.getExpiry();
+    const double S = marketData.getPrepaidForward(T);
+    const double r = marketData.getRiskFreeRate(T);
+    Search search;
+    if (!start(search, option.getType(), S, option.getStrike(), r, T, price)) {
+        return Result{NaN, 0, false};
+    }
+
+    while (true) {
+        const PriceWithGreeks model = blackScholes.calculatePriceAndGreeks(option, MarketData(S, r, search.vol));
+        if (advance(search, model.price, model.greeks.vega, T, true)) {
+            return Result{search.vol, search.iterations, search.converged};
+        }
+    }
+}
+
+ImpliedVolSolver::Result ImpliedVolSolver::solveAmerican(const Option& option, const MarketData& marketData, double price) {
+    const double S = marketData.getSpot();
+    const double K = option.getStrike();
+    const double T = option.getExpiry();
+    const double F = marketData.getPrepaidForward(T);
+    const double r = marketData.getRiskFreeRate(T);
+    if (!(S > 0 && K > 0 && T > 0) || !std::isfinite(S + K + T + r + F + price)) {
+        return Result{NaN, 0, false};
+    }
+
+    // Early exercise lifts the lower bound to intrinsic value, and a put can be worth up to K
+    // The European bound of a call is on the prepaid forward, the spot without a Carry
+    const bool isCall = option.getType() == Option::Type::CALL;
+    const double X = K * exp(-r * T);
+    const double lower = isCall ? std::max({S - K, F - X, 0.0}) : std::max(K - S, 0.0);
+    const double upper = isCall ? S : K;
+    if (!(price > lower && price < upper)) {
+        return Result{NaN, 0, false};
+    }
+
+    // The European volatility for the same price sits at or above the American one
+    const Option european(option.getType(), Option::Style::EUROPEAN, K, T);
+    const Result seed = solve(european, marketData, price);
+
+    Search search{price, seed.converged ? seed.volatility : 0.3, MIN_VOLATILITY, MAX_VOLATILITY, 0.0, 0, false};
+    while (true) {
+        // The tree keeps the Carry, American contracts under dividends exercise around them
+        const PriceWithGreeks model = binomial.calculatePriceAndGreeks(option, marketData.withVolatility(search.vol));
+        if (advance(search, model.price, model.greeks.vega, T, false)) {
+            return Result{search.vol, search.iterations, search.converged};
+        }
+    }
+}
+
+void ImpliedVolSolver::solve(const OptionBatch& batch, const double* prices, const ImpliedVolBatch& out) {
+    for (size_t begin = 0; begin < batch.size; begin += TILE) {
+        solveEuropeanTile(batch, prices, out, begin, std::min(batch.size, begin + TILE));
+    }
+}
+
+// European contracts of [begin, end) iterate together, American ones are solved one at a time
+void ImpliedVolSolver::solveEuropeanTile(const OptionBatch& batch, const double* prices, const ImpliedVolBatch& out,
+                                         size_t begin, size_t end) {
+    strikes.clear(); expiries.clear(); spots.clear(); rates.clear();
+    types.clear(); styles.clear(); searches.clear(); rows.clear();
+
+    for (size_t i = begin; i < end; ++i) {
+        if (batch.style[i] == Option::Style::AMERICAN) {
+            // The row's columns hold only the flat equivalent, the tree would miss the dividends
+            if (!batch.isFlat(i)) {
+                throw std::invalid_argument("Batch implied vols of American contracts need flat market data, solve them one by one under a carry");
+            }
+            const Result result = solveAmerican(Option(batch.type[i], batch.style[i], batch.strike[i], batch.expiry[i]),
+                                                MarketData(batch.spot[i], batch.riskFreeRate[i], 0.0), prices[i]);
+            out.volatility[i] = result.volatility;
+            out.iterations[i] = result.iterations;
+            out.converged[i] = result.converged;
+            continue;
+        }
+
+        Search search;
+        if (!start(search, batch.type[i], batch.spot[i], batch.strike[i], batch.riskFreeRate[i], batch.expiry[i], prices[i])) {
+            out.volatility[i] = NaN;
+            out.iterations[i] = 0;
+            out.converged[i] = 0;
+            continue;
+        }
+        strikes.push_back(batch.strike[i]);
+        expiries.push_back(batch.expiry[i]);
+        spots.push_back(batch.spot[i]);
+        rates.push_back(batch.riskFreeRate[i]);
+        types.push_back(batch.type[i]);
+        styles.push_back(batch.style[i]);
+        searches.push_back(search);
+        rows.push_back(i);
+    }
+
+    while (!searches.empty()) {
+        const size_t n = searches.size();
+        vols.resize(n);
+        for (size_t k = 0; k < n; ++k) {
+            vols[k] = searches[k].vol;
+        }
+        work.resize(6 * n);
+        double* w = work.data();
+        const GreeksBatch model{w, w + n, w + 2 * n, w + 3 * n, w + 4 * n, w + 5 * n};
+        const OptionBatch active{strikes.data(), expiries.data(), types.data(), styles.data(),
+                                 spots.data(), rates.data(), vols.data(), n};
+        blackScholes.calculatePricesAndGreeks(active, model, n);
+
+        // Finished contracts report their result, the rest are packed to the front
+        size_t kept = 0;
+        for (size_t k = 0; k < n; ++k) {
+            Search& search = searches[k];
+            if (advance(search, model.price[k], model.vega[k], expiries[k], true)) {
+                out.volatility[rows[k]] = search.vol;
+                out.iterations[rows[k]] = search.iterations;
+                out.converged[rows[k]] = search.converged;
+                continue;
+            }
+            strikes[kept] = strikes[k];
+            expiries[kept] = expiries[k];
+            spots[kept] = spots[k];
+            rates[kept] = rates[k];
+            types[kept] = types[k];
+            styles[kept] = styles[k];
+            searches[kept] = search;
+            rows[kept] = rows[k];
+            ++kept;
+        }
+
+        strikes.resize(kept); expiries.resize(kept); spots.resize(kept); rates.resize(kept);
+        types.resize(kept); styles.resize(kept); searches.resize(kept); rows.resize(kept);
+    }
+}
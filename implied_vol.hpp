@@ -0,0 +1,74 @@
+#pragma once
+
+#include "options_classes.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Output columns for a batch inversion, one entry per contract
+struct ImpliedVolBatch {
+    double* volatility;   // NaN when the price is outside the no-arbitrage bounds
+    int* iterations;      // pricer evaluations spent on the contract
+    uint8_t* converged;   // 1 when the price was matched within tolerance
+};
+
+// Inverts option prices to volatilities
+//
+// European contracts start from the Corrado-Miller closed-form guess and refine with Halley
+// steps built from the analytic Black-Scholes vega and volga. American contracts start from
+// the European answer and take Newton steps on the binomial price with the lattice vega.
+// Every step is kept inside a shrinking [lo, hi] bracket and falls back to bisection when
+// it would leave it, so flat-vega wings still converge.
+// Batch inversion runs all European contracts of a tile in lockstep through
+// BlackScholesPricer::calculatePricesAndGreeks, so each iteration is one SIMD pass over
+// the contracts that are still searching
+class ImpliedVolSolver {
+    public:
+        struct Result {
+            double volatility;
+            int iterations;
+            bool converged;
+        };
+
+        // tolerance is on the price, |model - target| <= tolerance stops the search
+        explicit ImpliedVolSolver(double tolerance = 1e-10, int maxIterations = 32, bool vectorized = true);
+
+        // marketData's volatility is ignored
+        Result solve(const Option& option, const MarketData& marketData, double price);
+
+        // batch.volatility is ignored, prices holds one target per contract
+        void solve(const OptionBatch& batch, const double* prices, const ImpliedVolBatch& out);
+
+        static constexpr double MIN_VOLATILITY = 1e-6;
+        static constexpr double MAX_VOLATILITY = 10.0;
+
+    private:
+        // Bracketed search state for one contract
+        struct Search {
+            double target;
+            double vol;
+            double lo;
+            double hi;
+            double logMoneyness;  // ln(S/K) + rT, feeds the Halley curvature
+            int iterations;
+            bool converged;
+        };
+
+        bool start(Search& search, Option::Type type, double S, double K, double r, double T, double price) const;
+        bool advance(Search& search, double price, double vega, double T, bool halley) const;
+        Result solveAmerican(const Option& option, const MarketData& marketData, double price);
+        void solveEuropeanTile(const OptionBatch& batch, const double* prices, const ImpliedVolBatch& out,
+                               size_t begin, size_t end);
+
+        double tolerance;
+        int maxIterations;
+        BlackScholesPricer blackScholes;
+        BinomialPricer binomial;
+
+        // Lockstep working set, compacted as contracts converge
+        std::vector<double> strikes, expiries, spots, rates, vols, work;
+        std::vector<Option::Type> types;
+        std::vector<Option::Style> styles;
+        std::vector<Search> searches;
+        std::vector<size_t> rows;
+};
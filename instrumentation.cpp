@@ -0,0 +1,365 @@
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+namespace Instrumentation {
+
+namespace {
+    const char* const STAGE_NAMES[STAGE_COUNT] = {
+        "black_scholes.price",
+        "black_scholes.greeks",
+        "black_scholes.batch",
+        "black_scholes.batch_greeks",
+        "binomial.price",
+        "binomial.greeks",
+        "binomial.batch",
+        "monte_carlo.price",
+        "quasi_monte_carlo.price",
+        "finite_difference.price",
+        "finite_difference.greeks",
+        "finite_difference.batch",
+        "barone_adesi_whaley.price",
+        "barone_adesi_whaley.batch",
+        "bjerksund_stensland.price",
+        "bjerksund_stensland.batch",
+        "cache.price",
+        "cache.greeks",
+        "cache.batch",
+        "cache.batch_greeks",
+        "strategy.batch",
+        "strategy.bumped_greeks",
+        "decision",
+        "decision.scenarios",
+        "decision.strategy1",
+        "decision.strategy2",
+        "decision.analysis",
+        "decision.screen",
+        "batch.read",
+        "batch.price",
+        "batch.write",
+        "scenario.block",
+    };
+
+    const char* const COUNTER_NAMES[COUNTER_COUNT] = {
+        "tree_steps",
+        "rng_draws",
+        "cache_hits",
+        "cache_taylor_hits",
+        "cache_misses",
+    };
+
+    // Only the owning thread writes, so plain load-and-store replaces read-modify-write
+    inline void add(std::atomic<uint64_t>& value, uint64_t amount) {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    struct StageData {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> total;
+        std::atomic<uint64_t> min;
+        std::atomic<uint64_t> max;
+        std::atomic<uint64_t> buckets[HistogramLayout::BUCKETS];
+
+        void clear() {
+            count.store(0, std::memory_order_relaxed);
+            total.store(0, std::memory_order_relaxed);
+            min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+            max.store(0, std::memory_order_relaxed);
+            for (std::atomic<uint64_t>& bucket : buckets) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    struct TraceEvent {
+        uint64_t start;
+        uint64_t duration;
+        Stage stage;
+    };
+
+    // One per thread that ever recorded, kept after the thread exits
+    struct ThreadData {
+        explicit ThreadData(size_t id) : id(id) {
+            for (StageData& stage : stages) {
+                stage.clear();
+            }
+            for (std::atomic<uint64_t>& counter : counters) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        const size_t id;
+        StageData stages[STAGE_COUNT];
+        std::atomic<uint64_t> counters[COUNTER_COUNT];
+
+        // Allocated by the owner on its first traced event, published with release
+        std::unique_ptr<TraceEvent[]> traceStorage;
+        std::atomic<TraceEvent*> trace{nullptr};
+        std::atomic<size_t> traceSize{0};
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadData>> threads;
+        const uint64_t origin = now();
+    };
+
+    // Constant-initialized, so the hot path reads it without a static guard
+    std::atomic<bool> tracing{false};
+
+    Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    ThreadData& local() {
+        thread_local ThreadData* data = nullptr;
+        if (!data) {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.threads.push_back(std::make_unique<ThreadData>(r.threads.size() + 1));
+            data = r.threads.back().get();
+        }
+        return *data;
+    }
+
+    void appendTrace(ThreadData& data, Stage stage, uint64_t start, uint64_t duration) {
+        TraceEvent* events = data.trace.load(std::memory_order_relaxed);
+        if (!events) {
+            data.traceStorage.reset(new TraceEvent[TRACE_CAPACITY]);
+            events = data.traceStorage.get();
+            data.trace.store(events, std::memory_order_release);
+        }
+        const size_t size = data.traceSize.load(std::memory_order_relaxed);
+        if (size == TRACE_CAPACITY) {
+            add(data.dropped, 1);
+            return;
+        }
+        events[size] = TraceEvent{start, duration, stage};
+        data.traceSize.store(size + 1, std::memory_order_release);
+    }
+
+    // Midpoint of the bucket holding the q-th recorded latency, clamped to the observed range
+    double percentile(const uint64_t* buckets, uint64_t count, double q, uint64_t minNs, uint64_t maxNs) {
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * count)));
+        uint64_t seen = 0;
+        for (size_t b = 0; b < HistogramLayout::BUCKETS; ++b) {
+            seen += buckets[b];
+            if (seen >= rank) {
+                const double mid = HistogramLayout::lowerBound(b) + 0.5 * (HistogramLayout::width(b) - 1);
+                return std::min<double>(std::max<double>(mid, minNs), maxNs);
+            }
+        }
+        return static_cast<double>(maxNs);
+    }
+}
+
+size_t HistogramLayout::bucket(uint64_t ns) {
+    if (ns < SUB_BUCKETS) {
+        return static_cast<size_t>(ns);
+    }
+    int exponent = 63 - __builtin_clzll(ns);
+    if (exponent > MAX_EXPONENT) {
+        return BUCKETS - 1;
+    }
+    const uint64_t sub = (ns >> (exponent - 4)) & (SUB_BUCKETS - 1);
+    return static_cast<size_t>((exponent - 3) * SUB_BUCKETS + sub);
+}
+
+uint64_t HistogramLayout::lowerBound(size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    const int exponent = static_cast<int>(bucket / SUB_BUCKETS) + 3;
+    return (SUB_BUCKETS + bucket % SUB_BUCKETS) << (exponent - 4);
+}
+
+uint64_t HistogramLayout::width(size_t bucket) {
+    return bucket < SUB_BUCKETS ? 1 : uint64_t(1) << (bucket / SUB_BUCKETS - 1);
+}
+
+const char* name(Stage stage) {
+    return STAGE_NAMES[static_cast<size_t>(stage)];
+}
+
+const char* name(Counter counter) {
+    return COUNTER_NAMES[static_cast<size_t>(counter)];
+}
+
+void record(Stage stage, uint64_t start, uint64_t end) {
+    ThreadData& data = local();
+    StageData& s = data.stages[static_cast<size_t>(stage)];
+    const uint64_t ns = end - start;
+    add(s.count, 1);
+    add(s.total, ns);
+    add(s.buckets[HistogramLayout::bucket(ns)], 1);
+    if (ns < s.min.load(std::memory_order_relaxed)) {
+        s.min.store(ns, std::memory_order_relaxed);
+    }
+    if (ns > s.max.load(std::memory_order_relaxed)) {
+        s.max.store(ns, std::memory_order_relaxed);
+    }
+    if (tracing.load(std::memory_order_relaxed)) {
+        appendTrace(data, stage, start, ns);
+    }
+}
+
+void count(Counter counter, uint64_t amount) {
+    add(local().counters[static_cast<size_t>(counter)], amount);
+}
+
+Snapshot snapshot() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    Snapshot result;
+    result.threads = r.threads.size();
+    std::vector<uint64_t> buckets(HistogramLayout::BUCKETS);
+    for (size_t st = 0; st < STAGE_COUNT; ++st) {
+        StageSummary summary{static_cast<Stage>(st), 0, 0, std::numeric_limits<uint64_t>::max(), 0, 0, 0, 0, 0};
+        std::fill(buckets.begin(), buckets.end(), 0);
+        for (const std::unique_ptr<ThreadData>& thread : r.threads) {
+            const StageData& s = thread->stages[st];
+            summary.count += s.count.load(std::memory_order_relaxed);
+            summary.totalNs += s.total.load(std::memory_order_relaxed);
+            summary.minNs = std::min(summary.minNs, s.min.load(std::memory_order_relaxed));
+            summary.maxNs = std::max(summary.maxNs, s.max.load(std::memory_order_relaxed));
+            for (size_t b = 0; b < HistogramLayout::BUCKETS; ++b) {
+                buckets[b] += s.buckets[b].load(std::memory_order_relaxed);
+            }
+        }
+        if (summary.count == 0) {
+            continue;
+        }
+        summary.p50Ns = percentile(buckets.data(), summary.count, 0.50, summary.minNs, summary.maxNs);
+        summary.p90Ns = percentile(buckets.data(), summary.count, 0.90, summary.minNs, summary.maxNs);
+        summary.p99Ns = percentile(buckets.data(), summary.count, 0.99, summary.minNs, summary.maxNs);
+        summary.p999Ns = percentile(buckets.data(), summary.count, 0.999, summary.minNs, summary.maxNs);
+        result.stages.push_back(summary);
+    }
+    for (const std::unique_ptr<ThreadData>& thread : r.threads) {
+        for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+            result.counters[c] += thread->counters[c].load(std::memory_order_relaxed);
+        }
+        result.droppedTraceEvents += thread->dropped.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+void reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const std::unique_ptr<ThreadData>& thread : r.threads) {
+        for (StageData& stage : thread->stages) {
+            stage.clear();
+        }
+        for (std::atomic<uint64_t>& counter : thread->counters) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+        thread->traceSize.store(0, std::memory_order_relaxed);
+        thread->dropped.store(0, std::memory_order_relaxed);
+    }
+}
+
+void startTrace() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const std::unique_ptr<ThreadData>& thread : r.threads) {
+        thread->traceSize.store(0, std::memory_order_relaxed);
+        thread->dropped.store(0, std::memory_order_relaxed);
+    }
+    tracing.store(true, std::memory_order_relaxed);
+}
+
+void stopTrace() {
+    tracing.store(false, std::memory_order_relaxed);
+}
+
+void writeText(const Snapshot& snapshot, std::ostream& out) {
+    const std::ios::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << std::left << std::setw(30) << "Stage" << std::right << std::setw(12) << "Count" << std::setw(14) << "Total ms"
+        << std::setw(12) << "Mean ns" << std::setw(12) << "p50 ns" << std::setw(12) << "p90 ns" << std::setw(12)
+        << "p99 ns" << std::setw(12) << "p99.9 ns" << std::setw(12) << "Max ns" << "\n";
+    out << std::fixed;
+    for (const StageSummary& s : snapshot.stages) {
+        out << std::left << std::setw(30) << name(s.stage) << std::right << std::setw(12) << s.count
+            << std::setprecision(3) << std::setw(14) << s.totalNs * 1e-6 << std::setprecision(0) << std::setw(12)
+            << static_cast<double>(s.totalNs) / s.count << std::setw(12) << s.p50Ns << std::setw(12) << s.p90Ns
+            << std::setw(12) << s.p99Ns << std::setw(12) << s.p999Ns << std::setw(12) << s.maxNs << "\n";
+    }
+    out << "\n" << std::left << std::setw(30) << "Counter" << std::right << std::setw(16) << "Value" << "\n";
+    for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+        out << std::left << std::setw(30) << COUNTER_NAMES[c] << std::right << std::setw(16) << snapshot.counters[c] << "\n";
+    }
+    out << snapshot.threads << " threads";
+    if (snapshot.droppedTraceEvents) {
+        out << ", " << snapshot.droppedTraceEvents << " trace events dropped";
+    }
+    out << "\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void writeJson(const Snapshot& snapshot, std::ostream& out) {
+    const std::ios::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+    out << "{\n  \"enabled\": " << (enabled() ? "true" : "false") << ",\n"
+        << "  \"threads\": " << snapshot.threads << ",\n"
+        << "  \"dropped_trace_events\": " << snapshot.droppedTraceEvents << ",\n"
+        << "  \"stages\": [";
+    for (size_t i = 0; i < snapshot.stages.size(); ++i) {
+        const StageSummary& s = snapshot.stages[i];
+        out << (i ? ",\n" : "\n") << "    {\"name\": \"" << name(s.stage) << "\", \"count\": " << s.count
+            << ", \"total_ns\": " << s.totalNs << ", \"mean_ns\": " << static_cast<double>(s.totalNs) / s.count
+            << ", \"min_ns\": " << s.minNs << ", \"p50_ns\": " << s.p50Ns << ", \"p90_ns\": " << s.p90Ns
+            << ", \"p99_ns\": " << s.p99Ns << ", \"p999_ns\": " << s.p999Ns << ", \"max_ns\": " << s.maxNs << "}";
+    }
+    out << (snapshot.stages.empty() ? "],\n" : "\n  ],\n") << "  \"counters\": {";
+    for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+        out << (c ? ", " : "") << "\"" << COUNTER_NAMES[c] << "\": " << snapshot.counters[c];
+    }
+    out << "}\n}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void writeChromeTrace(std::ostream& out) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    const std::ios::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+
+    // Timestamps in microseconds from the first record, the first scope itself starts slightly before
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    bool first = true;
+    for (const std::unique_ptr<ThreadData>& thread : r.threads) {
+        const TraceEvent* events = thread->trace.load(std::memory_order_acquire);
+        const size_t size = thread->traceSize.load(std::memory_order_acquire);
+        if (!events || size == 0) {
+            continue;
+        }
+        out << (first ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread->id
+            << ", \"args\": {\"name\": \"thread " << thread->id << "\"}}";
+        first = false;
+        for (size_t e = 0; e < size; ++e) {
+            const TraceEvent& event = events[e];
+            out << ",\n{\"name\": \"" << name(event.stage) << "\", \"cat\": \"options\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+                << thread->id << ", \"ts\": " << static_cast<int64_t>(event.start - r.origin) * 1e-3 << ", \"dur\": " << event.duration * 1e-3
+                << "}";
+        }
+    }
+    out << "\n]}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+}
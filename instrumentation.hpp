@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Hot-path timers and counters. Compiled in only when OPTIONS_INSTRUMENT is defined (CMake option
+// OPTIONS_INSTRUMENTATION), otherwise the macros below expand to nothing and snapshots are empty.
+//
+// Every thread records into its own histograms and counters, so recording takes no locks. A
+// snapshot merges all threads, including finished ones. Numbers are exact when the snapshot is
+// taken while nothing is being priced, and may lag by a few records otherwise.
+namespace Instrumentation {
+    enum class Stage : uint8_t {
+        BLACK_SCHOLES_PRICE,
+        BLACK_SCHOLES_GREEKS,
+        BLACK_SCHOLES_BATCH,
+        BLACK_SCHOLES_BATCH_GREEKS,
+        BINOMIAL_PRICE,
+        BINOMIAL_GREEKS,
+        BINOMIAL_BATCH,
+        MONTE_CARLO,
+        QUASI_MONTE_CARLO,
+        FINITE_DIFFERENCE_PRICE,
+        FINITE_DIFFERENCE_GREEKS,
+        FINITE_DIFFERENCE_BATCH,
+        BARONE_ADESI_WHALEY_PRICE,
+        BARONE_ADESI_WHALEY_BATCH,
+        BJERKSUND_STENSLAND_PRICE,
+        BJERKSUND_STENSLAND_BATCH,
+        CACHE_PRICE,
+        CACHE_GREEKS,
+        CACHE_BATCH,
+        CACHE_BATCH_GREEKS,
+        STRATEGY_BATCH,           // PricingStrategy's per-contract batch loop
+        STRATEGY_BUMPED_GREEKS,   // PricingStrategy's bump-and-reprice Greeks
+        DECISION,                 // TradingDecision::evaluate end to end
+        DECISION_SCENARIOS,       // building the volatility scenario chain
+        DECISION_STRATEGY_1,      // strategies[0] over the scenarios (per tile when pooled)
+        DECISION_STRATEGY_2,      // strategies[1] over the scenarios (per tile when pooled)
+        DECISION_ANALYSIS,        // analyzePricingDifference
+        DECISION_SCREEN,          // TradingDecision::screen, screening plus any refinement
+        BATCH_READ,               // batch mode, one chunk parsed or mapped
+        BATCH_PRICE,              // batch mode, one chunk priced
+        BATCH_WRITE,              // batch mode, one chunk written
+        SCENARIO_BLOCK,           // ScenarioEngine, one run of spot shifts at a (vol, rate, time) point
+        COUNT
+    };
+
+    enum class Counter : uint8_t {
+        TREE_STEPS,           // lattice time steps swept, per lane
+        RNG_DRAWS,            // normal draws in Monte Carlo and quasi-Monte Carlo paths
+        CACHE_HITS,
+        CACHE_TAYLOR_HITS,
+        CACHE_MISSES,
+        COUNT
+    };
+
+    constexpr size_t STAGE_COUNT = static_cast<size_t>(Stage::COUNT);
+    constexpr size_t COUNTER_COUNT = static_cast<size_t>(Counter::COUNT);
+
+    const char* name(Stage stage);
+    const char* name(Counter counter);
+
+    constexpr bool enabled() {
+#ifdef OPTIONS_INSTRUMENT
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Nanoseconds on the steady clock
+    inline uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Adds one latency to the calling thread's histogram of the stage, and a trace event when tracing
+    void record(Stage stage, uint64_t start, uint64_t end);
+    void count(Counter counter, uint64_t amount);
+
+    class ScopedTimer {
+        public:
+            explicit ScopedTimer(Stage stage) : stage(stage), start(now()) {}
+            ~ScopedTimer() { record(stage, start, now()); }
+
+            ScopedTimer(const ScopedTimer&) = delete;
+            ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        private:
+            Stage stage;
+            uint64_t start;
+    };
+
+    // Log-linear latency buckets in the HDR histogram layout: exact below 16 ns, then 16 buckets
+    // per power of two, so a reported percentile is within 1/16 of the recorded latency
+    struct HistogramLayout {
+        static constexpr int SUB_BUCKETS = 16;
+        static constexpr int MAX_EXPONENT = 43;   // ~2.4 hours, longer latencies land in the top bucket
+        static constexpr size_t BUCKETS = SUB_BUCKETS * (MAX_EXPONENT - 2);
+
+        static size_t bucket(uint64_t ns);
+        static uint64_t lowerBound(size_t bucket);
+        static uint64_t width(size_t bucket);
+    };
+
+    struct StageSummary {
+        Stage stage;
+        uint64_t count;
+        uint64_t totalNs;
+        uint64_t minNs;
+        uint64_t maxNs;
+        double p50Ns;
+        double p90Ns;
+        double p99Ns;
+        double p999Ns;
+    };
+
+    struct Snapshot {
+        std::vector<StageSummary> stages;                  // stages recorded at least once
+        std::array<uint64_t, COUNTER_COUNT> counters{};
+        size_t threads = 0;                                // threads that recorded anything
+        uint64_t droppedTraceEvents = 0;                   // events past a thread's trace buffer
+    };
+
+    Snapshot snapshot();
+
+    // Zeroes every histogram, counter and trace buffer
+    void reset();
+
+    // Trace events are kept only between startTrace and stopTrace, up to TRACE_CAPACITY per thread
+    constexpr size_t TRACE_CAPACITY = size_t(1) << 18;
+    void startTrace();
+    void stopTrace();
+
+    void writeText(const Snapshot& snapshot, std::ostream& out);
+    void writeJson(const Snapshot& snapshot, std::ostream& out);
+
+    // Chrome trace event format, for chrome://tracing or Perfetto: one complete event per timed scope
+    void writeChromeTrace(std::ostream& out);
+}
+
+// OPTIONS_TIME_SCOPE(DECISION) times the rest of the enclosing scope, OPTIONS_TIME_STAGE takes a
+// Stage expression chosen at run time. Disabled builds evaluate neither the stage nor the amount
+#ifdef OPTIONS_INSTRUMENT
+#define OPTIONS_INSTRUMENT_CONCAT_(a, b) a##b
+#define OPTIONS_INSTRUMENT_CONCAT(a, b) OPTIONS_INSTRUMENT_CONCAT_(a, b)
+#define OPTIONS_TIME_STAGE(stage) \
+    const Instrumentation::ScopedTimer OPTIONS_INSTRUMENT_CONCAT(scopedTimer, __LINE__)(stage)
+#define OPTIONS_TIME_SCOPE(stage) OPTIONS_TIME_STAGE(Instrumentation::Stage::stage)
+#define OPTIONS_COUNT(counter, amount) Instrumentation::count(Instrumentation::Counter::counter, (amount))
+#else
+#define OPTIONS_TIME_STAGE(stage) static_cast<void>(0)
+#define OPTIONS_TIME_SCOPE(stage) static_cast<void>(0)
+#define OPTIONS_COUNT(counter, amount) static_cast<void>(0)
+#endif
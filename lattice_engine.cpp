@@ -0,0 +1,206 @@
+#include "lattice_engine.hpp"
+#include "instrumentation.hpp"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+namespace Lattice {
+
+Arena& threadArena() {
+    thread_local Arena arena;
+    return arena;
+}
+
+Greeks levelGreeks(const Levels& levels, double price, double S, double u, double dt, double drift) {
+    const double d = 1.0/u;
+    const double s1 = S * exp(drift);
+    const double s2 = S * exp(2 * drift);
+    const double delta = (levels.level1[1] - levels.level1[0]) / (s1 * (u - d));
+    const double deltaUp = (levels.level2[2] - levels.level2[1]) / (s2 * (u*u - 1));
+    const double deltaDown = (levels.level2[1] - levels.level2[0]) / (s2 * (1 - d*d));
+    const double gamma = (deltaUp - deltaDown) / (0.5 * s2 * (u*u - d*d));
+    const double theta = (levels.level2[1] - price) / (2 * dt);
+    return Greeks{delta, gamma, theta, 0.0, 0.0};
+}
+
+Geometry crrGeometry(double r, double sigma, double T, int steps) {
+    const double dt = T/steps;
+    const double u = exp(sigma * sqrt(dt));
+    const double d = 1.0/u;
+    const double p = (exp(r * dt) - d)/(u - d);
+    const double discount = exp(-r * dt);
+    return Geometry{steps, u, discount * p, discount * (1 - p)};
+}
+
+Geometry leisenReimerGeometry(double S, double K, double r, double sigma, double T, int steps) {
+    if (steps % 2 == 0) {
+        throw std::invalid_argument("Leisen-Reimer trees need an odd number of steps");
+    }
+
+    // Peizer-Pratt method 2 inversion of the normal CDF onto a binomial probability
+    const double n = steps;
+    auto inversion = [n](double z) {
+        const double ratio = z / (n + 1.0/3.0 + 0.1/(n + 1.0));
+        const double root = 0.5 * sqrt(1.0 - exp(-ratio * ratio * (n + 1.0/6.0)));
+        return z < 0 ? 0.5 - root : 0.5 + root;
+    };
+
+    const double dt = T/steps;
+    const double d1 = (log(S/K) + (r + 0.5*sigma*sigma)*T) / (sigma*sqrt(T));
+    const double d2 = d1 - sigma*sqrt(T);
+    const double p = inversion(d2);
+    const double growth = exp(r * dt);
+    const double up = growth * inversion(d1) / p;
+    const double down = (growth - p * up) / (1 - p);
+    const double discount = 1.0/growth;
+    return Geometry{steps, sqrt(up/down), discount * p, discount * (1 - p), 0.5 * log(up * down)};
+}
+
+const double* buildSpots(double S, const Geometry& geometry, Arena& arena) {
+    const int N = geometry.steps;
+    const double d = 1.0/geometry.u;
+    double* spots = arena.take(2 * N + 1);
+
+    spots[N] = S;
+    for (int k = 1; k <= N; ++k) {
+        spots[N + k] = spots[N + k - 1] * geometry.u;
+        spots[N - k] = spots[N - k + 1] * d;
+    }
+    return spots;
+}
+
+template <Option::Type TYPE>
+ExerciseTable buildExercise(const double* spots, int steps, double K, Arena& arena) {
+    double* even = arena.take(steps + 1);
+    double* odd = arena.take(steps + 1);
+
+    for (int m = 0; m <= steps; ++m) {
+        even[m] = Payoff::Vanilla<TYPE>::exercise(spots[2 * m], K);
+    }
+    for (int m = 0; m < steps; ++m) {
+        odd[m] = Payoff::Vanilla<TYPE>::exercise(spots[2 * m + 1], K);
+    }
+    return ExerciseTable{even, odd};
+}
+
+namespace {
+    // Level i of an N-step tree starts at power N - i of the spot table
+    inline const double* exerciseRow(const ExerciseTable& exercise, int N, int i) {
+        const int base = N - i;
+        return ((base & 1) ? exercise.odd : exercise.even) + (base >> 1);
+    }
+
+    inline void keepLevels(const double* values, int i, Levels* levels) {
+        if (levels && i == 2) {
+            std::copy(values, values + 3, levels->level2);
+        } else if (levels && i == 1) {
+            std::copy(values, values + 2, levels->level1);
+        }
+    }
+}
+
+template <Option::Style STYLE>
+void sweep(Lane* lanes, int laneCount, Levels* levels) {
+    const int N = lanes[0].geometry.steps;
+    OPTIONS_COUNT(TREE_STEPS, static_cast<uint64_t>(N) * laneCount);
+
+    // Terminal level is the even row itself
+    for (int k = 0; k < laneCount; ++k) {
+        std::copy(lanes[k].exercise.even, lanes[k].exercise.even + N + 1, lanes[k].values);
+    }
+
+    for (int i = N - 1; i >= 0; --i) {
+        for (int k = 0; k < laneCount; ++k) {
+            double* values = lanes[k].values;
+            const double up = lanes[k].geometry.up;
+            const double down = lanes[k].geometry.down;
+
+            if (Payoff::Exercise<STYLE>::EARLY) {
+                const double* exercise = exerciseRow(lanes[k].exercise, N, i);
+                for (int j = 0; j <= i; ++j) {
+                    values[j] = std::max(up * values[j+1] + down * values[j], exercise[j]);
+                }
+            } else {
+                for (int j = 0; j <= i; ++j) {
+                    values[j] = up * values[j+1] + down * values[j];
+                }
+            }
+        }
+        keepLevels(lanes[0].values, i, levels);
+    }
+}
+
+template <Option::Type TYPE, Option::Style STYLE>
+void sweepFrom(const Geometry& geometry, const double* spots, const double* terminal, double K,
+               double* values, Levels* levels) {
+    const int N = geometry.steps;
+    const double up = geometry.up;
+    const double down = geometry.down;
+    OPTIONS_COUNT(TREE_STEPS, N);
+    std::copy(terminal, terminal + N + 1, values);
+
+    for (int i = N - 1; i >= 0; --i) {
+        if (Payoff::Exercise<STYLE>::EARLY) {
+            // Node (i, j) sits at spots[N - i + 2j] scaled by the level's centre
+            const double* row = spots + (N - i);
+            const double centre = exp(i * geometry.drift);
+            for (int j = 0; j <= i; ++j) {
+                values[j] = std::max(up * values[j+1] + down * values[j],
+                                     Payoff::Vanilla<TYPE>::intrinsic(row[2 * j] * centre, K));
+            }
+        } else {
+            for (int j = 0; j <= i; ++j) {
+                values[j] = up * values[j+1] + down * values[j];
+            }
+        }
+        keepLevels(values, i, levels);
+    }
+}
+
+template <Option::Type TYPE, Option::Style STYLE>
+void sweepLevels(const Geometry& geometry, const double* spots, const LevelTable& table, double K,
+                 double* values, Levels* levels) {
+    const int N = geometry.steps;
+    constexpr double sign = Payoff::Vanilla<TYPE>::SIGN;
+    OPTIONS_COUNT(TREE_STEPS, N);
+
+    for (int j = 0; j <= N; ++j) {
+        values[j] = Payoff::Vanilla<TYPE>::exercise(spots[2 * j] * table.scale[N] + table.shift[N], K);
+    }
+
+    for (int i = N - 1; i >= 0; --i) {
+        const double up = table.up[i];
+        const double down = table.down[i];
+        if (Payoff::Exercise<STYLE>::EARLY) {
+            // The payoff's sign folded into the level's scale and shift
+            const double* row = spots + (N - i);
+            const double scale = sign * table.scale[i];
+            const double shift = sign * (table.shift[i] - K);
+            for (int j = 0; j <= i; ++j) {
+                values[j] = std::max(up * values[j+1] + down * values[j], row[2 * j] * scale + shift);
+            }
+        } else {
+            for (int j = 0; j <= i; ++j) {
+                values[j] = up * values[j+1] + down * values[j];
+            }
+        }
+        keepLevels(values, i, levels);
+    }
+}
+
+// Every type and style the pricers dispatch to
+#define LATTICE_INSTANTIATE(TYPE, STYLE) \
+    template void sweepFrom<TYPE, STYLE>(const Geometry&, const double*, const double*, double, double*, Levels*); \
+    template void sweepLevels<TYPE, STYLE>(const Geometry&, const double*, const LevelTable&, double, double*, Levels*);
+LATTICE_INSTANTIATE(Option::Type::CALL, Option::Style::EUROPEAN)
+LATTICE_INSTANTIATE(Option::Type::CALL, Option::Style::AMERICAN)
+LATTICE_INSTANTIATE(Option::Type::PUT, Option::Style::EUROPEAN)
+LATTICE_INSTANTIATE(Option::Type::PUT, Option::Style::AMERICAN)
+#undef LATTICE_INSTANTIATE
+
+template ExerciseTable buildExercise<Option::Type::CALL>(const double*, int, double, Arena&);
+template ExerciseTable buildExercise<Option::Type::PUT>(const double*, int, double, Arena&);
+template void sweep<Option::Style::EUROPEAN>(Lane*, int, Levels*);
+template void sweep<Option::Style::AMERICAN>(Lane*, int, Levels*);
+
+}
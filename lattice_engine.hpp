@@ -0,0 +1,118 @@
+#pragma once
+
+#include "payoff.hpp"
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+
+// Allocation-free, pow-free CRR lattice kernels shared by the binomial pricers
+//
+// Node (i, j) of an N-step tree sits at spot S*u^(2j-i), so every spot of the tree
+// lives in one table of 2N+1 powers built by recurrence. Exercise values are split by
+// parity of the power so each level of the backward induction reads one contiguous run
+//
+// Payoff and exercise style are template arguments, instantiated in lattice_engine.cpp for both
+// types and styles: Payoff::dispatch picks the tree once, the node loops never test them
+namespace Lattice {
+    // Per-thread scratch memory, grows to the largest tree seen and is reused across calls
+    class Arena {
+        public:
+            // Starts a new call with room for `total` doubles, earlier slices become invalid
+            void reset(size_t total) {
+                if (buffer.size() < total) {
+                    buffer.resize(total);
+                }
+                used = 0;
+            }
+
+            double* take(size_t n) {
+                if (used + n > buffer.size()) {
+                    throw std::logic_error("Lattice arena exhausted, reset with a larger size");
+                }
+                double* slice = buffer.data() + used;
+                used += n;
+                return slice;
+            }
+
+        private:
+            std::vector<double> buffer;
+            size_t used = 0;
+    };
+
+    Arena& threadArena();
+
+    // Step count and CRR parameters, up/down are the discounted branch probabilities
+    // Level i of the tree is centred on S*exp(i*drift), zero for CRR where u*d = 1
+    struct Geometry {
+        int steps;
+        double u;
+        double up;
+        double down;
+        double drift = 0.0;
+    };
+
+    Geometry crrGeometry(double r, double sigma, double T, int steps);
+
+    // Leisen-Reimer tree (Peizer-Pratt inversion of d1 and d2), steps must be odd. Its up and
+    // down moves do not multiply to one, so they are stored as u = sqrt(u/d) and a drift
+    Geometry leisenReimerGeometry(double S, double K, double r, double sigma, double T, int steps);
+
+    // Exercise values at every node spot, even[m] = payoff(S*u^(2m-N)), odd[m] = payoff(S*u^(2m+1-N))
+    struct ExerciseTable {
+        const double* even;
+        const double* odd;
+    };
+
+    // Doubles taken from the arena by buildSpots + buildExercise for an N-step tree
+    inline size_t tableSize(int steps) { return 4 * static_cast<size_t>(steps) + 3; }
+
+    // Node spots S*u^k for k = -N..N (2N+1 entries), by multiplication outward from S
+    const double* buildSpots(double S, const Geometry& geometry, Arena& arena);
+    template <Option::Type TYPE>
+    ExerciseTable buildExercise(const double* spots, int steps, double K, Arena& arena);
+
+    // Option values on the first levels of a tree, for delta, gamma and theta
+    struct Levels {
+        double level1[2];  // spots S*d, S*u
+        double level2[3];  // spots S*d^2, S, S*u^2
+    };
+
+    // Delta, gamma and theta of a tree on spot S read off its first levels, level i centred on
+    // S*exp(i*drift) and dt apart. Vega and rho are left zero for the caller's bumped trees
+    Greeks levelGreeks(const Levels& levels, double price, double S, double u, double dt, double drift = 0.0);
+
+    // One tree of a sweep, values needs steps + 1 entries and holds the price in values[0]
+    struct Lane {
+        Geometry geometry;
+        ExerciseTable exercise;
+        double* values;
+    };
+
+    // Backward induction of several same-N lanes level by level, so lanes that share an
+    // exercise table read each level's row while it is hot in cache. Levels come from lane 0
+    template <Option::Style STYLE>
+    void sweep(Lane* lanes, int laneCount, Levels* levels = nullptr);
+
+    // Backward induction of one tree from caller-supplied values at its last level, for trees the
+    // shared exercise tables cannot serve: drifting Leisen-Reimer levels and Black-Scholes-smoothed
+    // last steps. spots comes from buildSpots, exercise values are formed level by level from it.
+    // values needs steps + 1 entries and holds the price in values[0]
+    template <Option::Type TYPE, Option::Style STYLE>
+    void sweepFrom(const Geometry& geometry, const double* spots, const double* terminal, double K,
+                   double* values, Levels* levels = nullptr);
+
+    // Per-level inputs of a tree under term-structure rates and escrowed dividends: level i
+    // branches with up[i] / down[i] and a node at table spot s exercises at s * scale[i] + shift[i]
+    struct LevelTable {
+        const double* up;
+        const double* down;
+        const double* scale;
+        const double* shift;
+    };
+
+    // Backward induction of one tree whose probabilities and exercise spots vary by level,
+    // geometry.up/down are ignored. No transcendental calls per node
+    template <Option::Type TYPE, Option::Style STYLE>
+    void sweepLevels(const Geometry& geometry, const double* spots, const LevelTable& table, double K,
+                     double* values, Levels* levels = nullptr);
+}
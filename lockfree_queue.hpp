@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+// Bounded lock-free queues for handing events between threads without a mutex
+// Capacities are rounded up to a power of two, push returns false instead of blocking when full
+
+namespace LockFree {
+    constexpr size_t CACHE_LINE = 64;
+
+    inline size_t roundCapacity(size_t capacity) {
+        if (capacity < 2) {
+            throw std::invalid_argument("Queue capacity must be at least 2");
+        }
+        size_t p = 1;
+        while (p < capacity) {
+            p <<= 1;
+        }
+        return p;
+    }
+}
+
+// Single producer, single consumer ring
+// Each side owns one index and caches the other's, so the common case touches no shared line
+template <typename T>
+class SpscQueue {
+    public:
+        explicit SpscQueue(size_t capacity)
+            : mask(LockFree::roundCapacity(capacity) - 1), slots(new T[mask + 1]) {}
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        // Producer thread only
+        bool push(const T& value) {
+            const size_t tail = producer.index.load(std::memory_order_relaxed);
+            if (tail - producer.cached > mask) {
+                producer.cached = consumer.index.load(std::memory_order_acquire);
+                if (tail - producer.cached > mask) {
+                    return false;
+                }
+            }
+            slots[tail & mask] = value;
+            producer.index.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer thread only
+        bool pop(T& value) {
+            const size_t head = consumer.index.load(std::memory_order_relaxed);
+            if (head == consumer.cached) {
+                consumer.cached = producer.index.load(std::memory_order_acquire);
+                if (head == consumer.cached) {
+                    return false;
+                }
+            }
+            value = slots[head & mask];
+            consumer.index.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        size_t capacity() const { return mask + 1; }
+
+    private:
+        struct alignas(LockFree::CACHE_LINE) Side {
+            std::atomic<size_t> index{0};
+            size_t cached = 0;   // last seen value of the other side's index
+        };
+
+        const size_t mask;
+        std::unique_ptr<T[]> slots;
+        Side producer;
+        Side consumer;
+};
+
+// Multiple producers, single consumer, Vyukov's bounded queue
+// Every cell carries a sequence number, so producers claim cells with one CAS on the tail and
+// the consumer learns a cell is published from its sequence alone
+template <typename T>
+class MpscQueue {
+    public:
+        explicit MpscQueue(size_t capacity)
+            : mask(LockFree::roundCapacity(capacity) - 1), cells(new Cell[mask + 1]) {
+            for (size_t i = 0; i <= mask; ++i) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        // Any thread
+        bool push(const T& value) {
+            size_t position = tail.load(std::memory_order_relaxed);
+            while (true) {
+                Cell& cell = cells[position & mask];
+                const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if (lag == 0) {
+                    if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        cell.value = value;
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (lag < 0) {
+                    return false;
+                } else {
+                    position = tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Consumer thread only
+        bool pop(T& value) {
+            Cell& cell = cells[head & mask];
+            if (cell.sequence.load(std::memory_order_acquire) != head + 1) {
+                return false;
+            }
+            value = cell.value;
+            cell.sequence.store(head + mask + 1, std::memory_order_release);
+            ++head;
+            return true;
+        }
+
+        size_t capacity() const { return mask + 1; }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        const size_t mask;
+        std::unique_ptr<Cell[]> cells;
+        alignas(LockFree::CACHE_LINE) std::atomic<size_t> tail{0};
+        alignas(LockFree::CACHE_LINE) size_t head = 0;
+};
@@ -1,7 +1,12 @@
 #include "options_classes.hpp"
+#include "batch_mode.hpp"
+#include "monte_carlo.hpp"
+#include "finite_difference.hpp"
+#include "thread_pool.hpp"
 #include <iostream>
 #include <iomanip>
 #include <limits>
+#include <sstream>
 
 // Utility function to clear input buffering
 void clearInputBuffer() {
@@ -64,7 +69,7 @@ std::string getDecisionMessage(TradingDecision::Action action, const Option& opt
     // Getters 
     double spot = marketData.getSpot();
     double strike = option.getStrike();
-    double vol = marketData.getVolatility();
+    double vol = marketData.getVolatility(option);
     double expiry = option.getExpiry();
     bool isCall = option.getType() == Option::Type::CALL;
     
@@ -151,103 +156,105 @@ void printDecision(TradingDecision::Action action, const Option& option, const M
     std::cout << getDecisionMessage(action, option, marketData, analysis) << std::endl;
 }
 
-int main() {
+int main(int argc, char** argv) {
+    // Non-interactive batch mode when invoked with --batch
+    try {
+        BatchMode::Config config;
+        if (BatchMode::parseArguments(argc, argv, config)) {
+            const BatchMode::Summary summary = BatchMode::run(config);
+            std::cerr << (config.convertPath.empty() ? "Priced " : "Converted ") << summary.contracts << " contracts (" << summary.errors << " errors) in "
+                      << std::fixed << std::setprecision(3) << summary.seconds << " s\n";
+            return summary.errors == 0 ? 0 : 2;
+        }
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Error: " << e.what() << "\n" << BatchMode::usage();
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
     // Main with new error handling and detailed errors
     try {
         std::cout << "=== Options Pricing Calculator ===\n\n";
 
-        // Get market data from user
-        std::cout << "Enter Market Data:\n";
-        double spot = getNumericInput("Spot Price: ", 0.01);
-        double rate = getNumericInput("Risk-free Rate (as decimal, e.g., 0.05 for 5%): ", 0.0, 1.0);
-        double vol = getNumericInput("Volatility (as decimal, e.g., 0.2 for 20%): ", 0.0, 1.0);
+        // Shared by every calculation in the session
+        WorkStealingPool pool;
 
-        // Create market data object
-        MarketData marketData(spot, rate, vol);
+        // Loop rather than restarting main, so long sessions keep a flat stack
+        bool calculateAnother = true;
+        while (calculateAnother) {
+            // Get market data from user
+            std::cout << "Enter Market Data:\n";
+            double spot = getNumericInput("Spot Price: ", 0.01);
+            double rate = getNumericInput("Risk-free Rate (as decimal, e.g., 0.05 for 5%): ", 0.0, 1.0);
+            double vol = getNumericInput("Volatility (as decimal, e.g., 0.2 for 20%): ", 0.0, 1.0);
 
-        // Get option parameters from user
-        Option::Type type = getOptionType();
-        Option::Style style = getOptionStyle();
+            // Create market data object
+            MarketData marketData(spot, rate, vol);
+
+            // Get option parameters from user
+            Option::Type type = getOptionType();
+            Option::Style style = getOptionStyle();
         
-        double strike = getNumericInput("Strike Price: ", 0.01);
-        double expiry = getNumericInput("Time to Expiry (in years): ", 0.0, 100.0);
+            double strike = getNumericInput("Strike Price: ", 0.01);
+            double expiry = getNumericInput("Time to Expiry (in years): ", 0.0, 100.0);
+
+            // Create option object
+            Option option(type, style, strike, expiry);
 
-        // Create option object
-        Option option(type, style, strike, expiry);
+            // Create pricing strategies
+            std::vector<std::unique_ptr<PricingStrategy>> strategies;
+            strategies.push_back(std::make_unique<BlackScholesPricer>());
+            strategies.push_back(std::make_unique<BinomialPricer>());
+            // Priced and shown alongside, the decision compares the first two
+            strategies.push_back(std::make_unique<MonteCarloPricer>(MonteCarloSettings(), &pool));
+            strategies.push_back(std::make_unique<FiniteDifferencePricer>());
 
-        // Create pricing strategies
-        std::vector<std::unique_ptr<PricingStrategy>> strategies;
-        strategies.push_back(std::make_unique<BlackScholesPricer>());
-        strategies.push_back(std::make_unique<BinomialPricer>());
+            // Create analyzer and trading decision maker, the scenario sweep runs on every core
+            StatisticalAnalyzer analyzer;
+            TradingDecision trader(&pool);
 
-        // Create analyzer and trading decision maker
-        StatisticalAnalyzer analyzer;
-        TradingDecision trader;
+            // Print parameters
+            std::cout << "\n=== Parameters ===\n";
+            std::cout << std::fixed << std::setprecision(4);
+            std::cout << "Spot Price: " << spot << "\n"
+                      << "Strike Price: " << strike << "\n"
+                      << "Risk-free Rate: " << (rate * 100) << "%\n"
+                      << "Volatility: " << (vol * 100) << "%\n"
+                      << "Time to Expiry: " << expiry << " years\n"
+                      << "Option Type: " << (type == Option::Type::CALL ? "Call" : "Put") << "\n"
+                      << "Option Style: " << (style == Option::Style::EUROPEAN ? "European" : "American") << "\n";
 
-        // Print parameters
-        std::cout << "\n=== Parameters ===\n";
-        std::cout << std::fixed << std::setprecision(4);
-        std::cout << "Spot Price: " << spot << "\n"
-                  << "Strike Price: " << strike << "\n"
-                  << "Risk-free Rate: " << (rate * 100) << "%\n"
-                  << "Volatility: " << (vol * 100) << "%\n"
-                  << "Time to Expiry: " << expiry << " years\n"
-                  << "Option Type: " << (type == Option::Type::CALL ? "Call" : "Put") << "\n"
-                  << "Option Style: " << (style == Option::Style::EUROPEAN ? "European" : "American") << "\n";
+            // Calculate and display prices
+            std::cout << "\n=== Pricing Results ===\n";
+            for (const auto& strategy : strategies) {
+                try {
+                    double price = strategy->calculatePrice(option, marketData);
+                    std::cout << strategy->getStrategyName() << " Price: " << price << "\n";
+                } catch (const std::exception& e) {
+                    std::cerr << "Error in " << strategy->getStrategyName() << ": " << e.what() << "\n";
+                }
+            }
 
-        // Calculate and display prices
-        std::cout << "\n=== Pricing Results ===\n";
-        for (const auto& strategy : strategies) {
+            // Get trading decision
             try {
-                double price = strategy->calculatePrice(option, marketData);
-                std::cout << strategy->getStrategyName() << " Price: " << price << "\n";
+                // One sweep yields both the action and the analysis behind it
+                auto decision = trader.evaluate(option, strategies, marketData, analyzer);
+                printDecision(decision.action, option, marketData, decision.analysis);
             } catch (const std::exception& e) {
-                std::cerr << "Error in " << strategy->getStrategyName() << ": " << e.what() << "\n";
+                std::cerr << "Error in trading decision: " << e.what() << "\n";
             }
-        }
 
-        // Get trading decision
-        try {
-            // Redo for analysis
-            std::vector<double> prices1, prices2;
-            const int num_samples = 30;
-            prices1.reserve(num_samples);
-            prices2.reserve(num_samples);
-            
-            // Generate prices using same logic as in TradingDecision::makeDecision
-            for (int i = 0; i < num_samples; i++) {
-                double vol_adjustment = 0.95 + (i * 0.01);
-                MarketData adjusted_data(
-                    marketData.getSpot(),
-                    marketData.getRiskFreeRate(),
-                    marketData.getVolatility() * vol_adjustment
-                );
-                
-                prices1.push_back(strategies[0]->calculatePrice(option, adjusted_data));
-                prices2.push_back(strategies[1]->calculatePrice(option, adjusted_data));
+            // Ask if user wants to try another calculation
+            char again;
+            std::cout << "\nCalculate another option? (y/n): ";
+            std::cin >> again;
+            calculateAnother = again == 'y' || again == 'Y';
+            if (calculateAnother) {
+                clearInputBuffer();
             }
-
-            // Get the analysis result
-            auto analysis = analyzer.analyzePricingDifference(prices1, prices2);
-            
-            // Get the trading decision
-            auto action = trader.makeDecision(option, strategies, marketData, analyzer);
-            
-            // Now we have both action and analysis defined
-            printDecision(action, option, marketData, analysis);
-        } catch (const std::exception& e) {
-            std::cerr << "Error in trading decision: " << e.what() << "\n";
         }
-
-        // Ask if user wants to try another calculation
-        char again;
-        std::cout << "\nCalculate another option? (y/n): ";
-        std::cin >> again;
-        if (again == 'y' || again == 'Y') {
-            clearInputBuffer();
-            return main(); // Restart the program
-        }
-
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
@@ -0,0 +1,219 @@
+#include "monte_carlo.hpp"
+#include "thread_pool.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    constexpr size_t BLOCK = 1024;  // samples whose moments are accumulated together
+    constexpr size_t LANES = 64;    // samples advanced side by side through the time steps
+    constexpr double TWO_PI = 6.283185307179586;
+
+    // Running means and co-moments of (payoff, control), blocks merge with Chan's pairwise update
+    struct Moments {
+        double count = 0.0;
+        double meanY = 0.0, meanX = 0.0;
+        double m2y = 0.0, m2x = 0.0, cxy = 0.0;
+
+        void add(double y, double x) {
+            count += 1.0;
+            const double dy = y - meanY;
+            const double dx = x - meanX;
+            meanY += dy / count;
+            meanX += dx / count;
+            m2y += dy * (y - meanY);
+            m2x += dx * (x - meanX);
+            cxy += dx * (y - meanY);
+        }
+
+        void merge(const Moments& other) {
+            if (other.count == 0.0) {
+                return;
+            }
+            const double total = count + other.count;
+            const double dy = other.meanY - meanY;
+            const double dx = other.meanX - meanX;
+            const double weight = count * other.count / total;
+            m2y += other.m2y + dy * dy * weight;
+            m2x += other.m2x + dx * dx * weight;
+            cxy += other.cxy + dx * dy * weight;
+            meanY += dy * other.count / total;
+            meanX += dx * other.count / total;
+            count = total;
+        }
+    };
+
+    // Per-thread buffers, sized once per thread and reused by every block
+    struct Scratch {
+        std::vector<double> normals;   // steps x LANES, step-major
+        std::vector<double> logPlus;
+        std::vector<double> logMinus;
+        std::vector<double> paths;     // 2 x LANES paths of steps + 1 spots, only for path payoffs
+    };
+    thread_local Scratch scratch;
+
+    struct Contract {
+        const Option* option;
+        double S, K, r, sigma, T;
+        bool isCall;
+    };
+
+    double vanilla(const Contract& c, double terminal) {
+        return c.isCall ? std::max(terminal - c.K, 0.0) : std::max(c.K - terminal, 0.0);
+    }
+
+    Moments simulateBlock(const Contract& c, const MonteCarloSettings& settings, const PathPayoff* payoff,
+                          size_t begin, size_t end) {
+        const int steps = settings.steps;
+        const size_t pathLength = static_cast<size_t>(steps) + 1;
+        const double dt = c.T / steps;
+        const double drift = (c.r - 0.5 * c.sigma * c.sigma) * dt;
+        const double diffusion = c.sigma * sqrt(dt);
+        const double discount = exp(-c.r * c.T);
+        const double logSpot = log(c.S);
+        const Philox4x32::Key key{static_cast<uint32_t>(settings.seed), static_cast<uint32_t>(settings.seed >> 32)};
+
+        scratch.normals.resize(static_cast<size_t>(steps) * LANES);
+        scratch.logPlus.resize(LANES);
+        scratch.logMinus.resize(LANES);
+        if (payoff) {
+            scratch.paths.resize(2 * LANES * pathLength);
+        }
+        double* logPlus = scratch.logPlus.data();
+        double* logMinus = scratch.logMinus.data();
+        double* paths = scratch.paths.data();
+
+        Moments moments;
+        for (size_t first = begin; first < end; first += LANES) {
+            const size_t lanes = std::min(LANES, end - first);
+
+            // Box-Muller on Philox output, one generator call covers two steps of one sample
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                const uint64_t sample = first + lane;
+                for (int k = 0; k < steps; k += 2) {
+                    const Philox4x32::Counter bits = Philox4x32::generate(
+                        {static_cast<uint32_t>(k / 2), static_cast<uint32_t>(sample), static_cast<uint32_t>(sample >> 32), 0},
+                        key);
+                    const double radius = sqrt(-2.0 * log(Philox4x32::toUniform(bits[0], bits[1])));
+                    const double angle = TWO_PI * Philox4x32::toUniform(bits[2], bits[3]);
+                    scratch.normals[k * LANES + lane] = radius * cos(angle);
+                    if (k + 1 < steps) {
+                        scratch.normals[(k + 1) * LANES + lane] = radius * sin(angle);
+                    }
+                }
+            }
+
+            // Log-spot recurrence across lanes, contiguous rows the compiler vectorizes
+            std::fill(logPlus, logPlus + lanes, logSpot);
+            std::fill(logMinus, logMinus + lanes, logSpot);
+            if (payoff) {
+                for (size_t lane = 0; lane < 2 * lanes; ++lane) {
+                    paths[lane * pathLength] = c.S;
+                }
+            }
+            for (int k = 0; k < steps; ++k) {
+                const double* z = scratch.normals.data() + k * LANES;
+                for (size_t lane = 0; lane < lanes; ++lane) {
+                    logPlus[lane] += drift + diffusion * z[lane];
+                    logMinus[lane] += drift - diffusion * z[lane];
+                }
+                if (payoff) {
+                    for (size_t lane = 0; lane < lanes; ++lane) {
+                        paths[lane * pathLength + k + 1] = exp(logPlus[lane]);
+                        paths[(lanes + lane) * pathLength + k + 1] = exp(logMinus[lane]);
+                    }
+                }
+            }
+
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                const double terminal = exp(logPlus[lane]);
+                double y = payoff ? payoff->evaluate(*c.option, paths + lane * pathLength, steps) : vanilla(c, terminal);
+                double x = payoff ? vanilla(c, terminal) : terminal;
+                if (settings.antithetic) {
+                    const double mirror = exp(logMinus[lane]);
+                    y = 0.5 * (y + (payoff ? payoff->evaluate(*c.option, paths + (lanes + lane) * pathLength, steps)
+                                           : vanilla(c, mirror)));
+                    x = 0.5 * (x + (payoff ? vanilla(c, mirror) : mirror));
+                }
+                moments.add(discount * y, discount * x);
+            }
+        }
+        return moments;
+    }
+}
+
+double ArithmeticAsianPayoff::evaluate(const Option& option, const double* path, int steps) const {
+    double sum = 0.0;
+    for (int k = 1; k <= steps; ++k) {
+        sum += path[k];
+    }
+    const double average = sum / steps;
+    return option.getType() == Option::Type::CALL ? std::max(average - option.getStrike(), 0.0)
+                                                  : std::max(option.getStrike() - average, 0.0);
+}
+
+MonteCarloPricer::MonteCarloPricer(const MonteCarloSettings& settings, WorkStealingPool* pool,
+                                   std::shared_ptr<const PathPayoff> payoff)
+    : settings(settings), pool(pool), payoff(std::move(payoff)) {
+    if (settings.paths == 0 || settings.steps <= 0) {
+        throw std::invalid_argument("Monte Carlo needs at least one path and one time step");
+    }
+}
+
+double MonteCarloPricer::calculatePrice(const Option& option, const MarketData& marketData) {
+    return estimate(option, marketData).price;
+}
+
+MonteCarloPricer::Estimate MonteCarloPricer::estimate(const Option& option, const MarketData& marketData) {
+    OPTIONS_TIME_SCOPE(MONTE_CARLO);
+    if (option.getStyle() != Option::Style::EUROPEAN) {
+        throw std::invalid_argument("Monte Carlo pricer only handles European exercise");
+    }
+    // Vanilla contracts under a Carry are flat contracts on the prepaid forward, path payoffs
+    // would need the dividends on the path
+    if (payoff && !marketData.isFlat()) {
+        throw std::invalid_argument("Monte Carlo path payoffs need flat market data, without dividends or a yield curve");
+    }
+    const double T = option.getExpiry();
+    const Contract contract{&option, marketData.getPrepaidForward(T), option.getStrike(), marketData.getRiskFreeRate(T),
+                            marketData.getVolatility(option), T, option.getType() == Option::Type::CALL};
+    if (contract.S <= 0 || contract.K <= 0 || contract.T <= 0 || contract.sigma <= 0) {
+        throw std::invalid_argument("Invalid parameters: All values must be positive");
+    }
+
+    const size_t samples = settings.antithetic ? (settings.paths + 1) / 2 : settings.paths;
+    const size_t blocks = (samples + BLOCK - 1) / BLOCK;
+    OPTIONS_COUNT(RNG_DRAWS, static_cast<uint64_t>(samples) * settings.steps);
+    std::vector<Moments> results(blocks);
+    auto simulate = [&](size_t b) {
+        results[b] = simulateBlock(contract, settings, payoff.get(), b * BLOCK, std::min(samples, (b + 1) * BLOCK));
+    };
+    if (pool) {
+        pool->parallelFor(blocks, simulate);
+    } else {
+        for (size_t b = 0; b < blocks; ++b) {
+            simulate(b);
+        }
+    }
+
+    // Fixed merge order keeps the sum independent of which thread ran which block
+    Moments total;
+    for (const Moments& block : results) {
+        total.merge(block);
+    }
+
+    double price = total.meanY;
+    double residual = total.m2y;
+    if (settings.controlVariate && total.m2x > 0.0) {
+        const double expected = payoff ? BlackScholesPricer(false).calculatePrice(option, marketData) : contract.S;
+        const double beta = total.cxy / total.m2x;
+        price -= beta * (total.meanX - expected);
+        residual = std::max(total.m2y - beta * total.cxy, 0.0);
+    }
+
+    const double variance = samples > 1 ? residual / static_cast<double>(samples - 1) : 0.0;
+    return Estimate{price, sqrt(variance / static_cast<double>(samples)),
+                    settings.antithetic ? 2 * samples : samples};
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "options_classes.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Philox4x32-10 counter-based generator (Salmon et al., SC11)
+// Output is a pure function of (counter, key), so any draw can be produced on any thread
+// without sharing state, and a stream is reproduced exactly from its seed
+struct Philox4x32 {
+    using Counter = std::array<uint32_t, 4>;
+    using Key = std::array<uint32_t, 2>;
+
+    static Counter generate(Counter counter, Key key) {
+        for (int round = 0; round < 10; ++round) {
+            if (round > 0) {
+                key[0] += 0x9E3779B9u;
+                key[1] += 0xBB67AE85u;
+            }
+            const uint64_t product0 = uint64_t{0xD2511F53u} * counter[0];
+            const uint64_t product1 = uint64_t{0xCD9E8D57u} * counter[2];
+            counter = Counter{
+                static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                static_cast<uint32_t>(product1),
+                static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                static_cast<uint32_t>(product0)
+            };
+        }
+        return counter;
+    }
+
+    // Uniform in (0, 1] from 53 bits of two outputs
+    static double toUniform(uint32_t high, uint32_t low) {
+        const uint64_t bits = (uint64_t{high} << 21) ^ (low >> 11);
+        return (static_cast<double>(bits) + 1.0) * (1.0 / 9007199254740992.0);
+    }
+};
+
+// Payoff evaluated on a whole simulated path, the extension point for path-dependent contracts
+class PathPayoff {
+    public:
+        virtual ~PathPayoff() = default;
+
+        // path holds steps + 1 spots from today to expiry, returns the undiscounted payoff
+        virtual double evaluate(const Option& option, const double* path, int steps) const = 0;
+        virtual std::string getName() const = 0;
+};
+
+// Call or put on the arithmetic average of the path, today's spot excluded
+class ArithmeticAsianPayoff : public PathPayoff {
+    public:
+        double evaluate(const Option& option, const double* path, int steps) const override;
+        std::string getName() const override { return "Arithmetic Asian"; }
+};
+
+struct MonteCarloSettings {
+    size_t paths = 100000;
+    int steps = 1;                // time steps per path, path payoffs usually want more
+    uint64_t seed = 42;
+    bool antithetic = true;       // pair every path with its mirror image
+    bool controlVariate = true;
+};
+
+// Monte Carlo pricing strategy for European-exercise payoffs
+//
+// Draw k of sample g comes from Philox(counter = {k / 2, g, g >> 32, 0}, key = seed), so every
+// sample owns its random numbers regardless of which thread simulates it. Samples are
+// simulated in fixed blocks whose moments are merged in block order, which makes results
+// bit-identical for a given seed on any number of threads.
+// The control variate is the vanilla European payoff on the terminal spot, whose mean is the
+// Black-Scholes price. When pricing the vanilla payoff itself that control would be the
+// estimator, so the discounted terminal spot (mean = today's spot) is used instead
+class MonteCarloPricer : public PricingStrategy {
+    public:
+        struct Estimate {
+            double price;
+            double standardError;
+            size_t paths;
+        };
+
+        // Without a pool, blocks run on the calling thread. payoff = nullptr prices the vanilla option
+        explicit MonteCarloPricer(const MonteCarloSettings& settings = MonteCarloSettings(),
+                                  WorkStealingPool* pool = nullptr,
+                                  std::shared_ptr<const PathPayoff> payoff = nullptr);
+
+        double calculatePrice(const Option& option, const MarketData& marketData) override;
+
+        // Price with its standard error, ready for StatisticalAnalyzer::analyzeEstimate
+        Estimate estimate(const Option& option, const MarketData& marketData);
+
+        std::string getStrategyName() const override {
+            return payoff ? "Monte Carlo (" + payoff->getName() + ")" : "Monte Carlo";
+        }
+
+    private:
+        MonteCarloSettings settings;
+        WorkStealingPool* pool;
+        std::shared_ptr<const PathPayoff> payoff;
+};
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <vector>
 #include <string>
 #include <memory>
@@ -5,6 +7,32 @@
 // Forward declarations of classes
 class Option;
 class MarketData;
+class VolSurface;
+class Carry;
+class WorkStealingPool;
+struct OptionBatch;
+struct GreeksBatch;
+
+// Price sensitivities, theta is per year and vega/rho are per unit (1.0 = 100 points) change
+struct Greeks {
+    double delta;
+    double gamma;
+    double theta;
+    double vega;
+    double rho;
+};
+
+// Price and Greeks produced by a single evaluation
+struct PriceWithGreeks {
+    double price;
+    Greeks greeks;
+};
+
+// Standard normal cdf and density shared by the closed-form pricers
+namespace Utils {
+    double normalCDF(double x);
+    double normalPDF(double x);
+}
 
 // Abstract base class for option pricing strategies
 class PricingStrategy {
@@ -12,6 +40,15 @@ class PricingStrategy {
         virtual ~PricingStrategy() = default;
         virtual double calculatePrice(const Option& option, const MarketData& marketData) = 0;
         virtual std::string getStrategyName() const = 0;
+
+        // Prices a whole chain in one call, writing batch.size prices into the caller-owned buffer
+        // Default loops over calculatePrice with each row's Carry, strategies override it with tighter kernels
+        virtual void calculatePrices(const OptionBatch& batch, double* prices, size_t count);
+
+        // Price plus Greeks, default bumps each input and re-prices with central differences
+        // The batch form writes batch.size entries into each of greeks' count-long arrays
+        virtual PriceWithGreeks calculatePriceAndGreeks(const Option& option, const MarketData& marketData);
+        virtual void calculatePricesAndGreeks(const OptionBatch& batch, const GreeksBatch& greeks, size_t count);
 };
 
 
@@ -22,21 +59,60 @@ class PricingStrategy {
 // Remember BS only works on European style options
 class BlackScholesPricer : public PricingStrategy {
     public:
+        // Batch pricing runs the widest SIMD kernel the CPU supports unless vectorized is false
+        explicit BlackScholesPricer(bool vectorized = true) : vectorized(vectorized) {}
+
         double calculatePrice(const Option& option, const MarketData& marketData);
+        void calculatePrices(const OptionBatch& batch, double* prices, size_t count) override;
+
+        // Price and all five Greeks from one shared evaluation of d1, d2, N(d1) and n(d1)
+        PriceWithGreeks calculatePriceAndGreeks(const Option& option, const MarketData& marketData) override;
+        void calculatePricesAndGreeks(const OptionBatch& batch, const GreeksBatch& greeks, size_t count) override;
         
         std::string getStrategyName() const override {
             return "Black-Scholes";
         }
+
+    private:
+        bool vectorized;
+};
+
+// Lattice scheme and step selection for BinomialPricer, the defaults reproduce the plain CRR tree
+struct BinomialSettings {
+    // SMOOTHED is CRR with the last step priced by Black-Scholes, which removes the strike-driven
+    // oscillation. LEISEN_REIMER centres the tree on the strike and converges in 1/N^2 for Europeans
+    enum class Scheme { CRR, LEISEN_REIMER, SMOOTHED };
+
+    Scheme scheme = Scheme::CRR;
+    // richardson and tolerance need a non-oscillating scheme, CRR rejects both
+    bool richardson = false;   // two-point extrapolation from N and N/2 steps
+    int steps = 0;             // 0 keeps the expiry rule, T * 365 clamped to 100-1000
+    double tolerance = 0.0;    // > 0 picks the smallest N whose estimated error meets it, steps is ignored
+    int maxSteps = 10000;      // ceiling for the tolerance search
 };
 
 // Binomial Pricing strategy
 class BinomialPricer : public PricingStrategy {
     public:
+        explicit BinomialPricer(const BinomialSettings& settings = BinomialSettings());
+
         double calculatePrice(const Option& option, const MarketData& marketData);
+        void calculatePrices(const OptionBatch& batch, double* prices, size_t count) override;
+
+        // Delta, gamma and theta from the lattice itself, vega and rho from bumped lanes
+        // swept alongside it, two tree passes in total
+        PriceWithGreeks calculatePriceAndGreeks(const Option& option, const MarketData& marketData) override;
+        void calculatePricesAndGreeks(const OptionBatch& batch, const GreeksBatch& greeks, size_t count) override;
         
         std::string getStrategyName() const override {
             return "Binomial";
         }
+
+        // Tree size the settings select for this contract, the finer tree when extrapolating
+        int selectSteps(const Option& option, const MarketData& marketData) const;
+
+    private:
+        BinomialSettings settings;
 };
 
 // Other pricing methods to come
@@ -80,16 +156,158 @@ class MarketData {
         MarketData(double spot, double riskFreeRate, double volatility)
             : spot(spot), riskFreeRate(riskFreeRate), volatility(volatility) {}
 
+        // Vol per (strike, expiry) from the surface, getVolatility() is its at-the-money one-year level
+        MarketData(double spot, double riskFreeRate, std::shared_ptr<const VolSurface> surface);
+
+        // Copy with a yield curve and dividends, getRiskFreeRate() becomes the curve's one-year zero rate
+        MarketData withCarry(std::shared_ptr<const Carry> carry) const;
+        // Copy with a flat vol, keeping spot, rates and dividends
+        MarketData withVolatility(double volatility) const {
+            MarketData copy(*this);
+            copy.volatility = volatility;
+            copy.surface.reset();
+            return copy;
+        }
+
         // getter methods
         double getSpot() const { return spot; }
         double getRiskFreeRate() const { return riskFreeRate; }
         double getVolatility() const { return volatility; }
+        const std::shared_ptr<const VolSurface>& getSurface() const { return surface; }
+        const std::shared_ptr<const Carry>& getCarry() const { return carry; }
+
+        // Inputs of the equivalent flat contract to an expiry: the zero rate to it, and the spot
+        // less the present value of dividends paid before it. Plain spot and rate without a Carry
+        double getRiskFreeRate(double expiry) const { return carry ? carryRate(expiry) : riskFreeRate; }
+        double getPrepaidForward(double expiry) const { return carry ? carryForward(expiry) : spot; }
+        // dF/dS of the prepaid forward, e^(-yield T) under a dividend yield and 1 otherwise
+        double getForwardDelta(double expiry) const { return carry ? carryForwardDelta(expiry) : 1.0; }
+        // No Carry, or one without a term structure, dividends or yield. Pricers that model only
+        // a flat rate price American contracts and path payoffs exactly only on flat market data
+        bool isFlat() const { return !carry || carryFlat(); }
+
+        // The vol a contract is priced at, the flat vol when there is no surface
+        double getVolatility(double strike, double expiry) const {
+            return surface ? surfaceVolatility(strike, expiry) : volatility;
+        }
+        double getVolatility(const Option& option) const {
+            return getVolatility(option.getStrike(), option.getExpiry());
+        }
 
     private:
+        double surfaceVolatility(double strike, double expiry) const;
+        double carryRate(double expiry) const;
+        double carryForward(double expiry) const;
+        double carryForwardDelta(double expiry) const;
+        bool carryFlat() const;
+
         // private data members
         double spot;
         double riskFreeRate;
         double volatility;
+        std::shared_ptr<const VolSurface> surface;
+        std::shared_ptr<const Carry> carry;
+};
+
+
+
+// Structure-of-arrays view over a chain of contracts and their market inputs
+// Buffers are owned by the caller and every array holds `size` entries
+struct OptionBatch {
+    const double* strike;
+    const double* expiry;
+    const Option::Type* type;
+    const Option::Style* style;
+    const double* spot;
+    const double* riskFreeRate;
+    const double* volatility;
+    size_t size;
+    // Per-contract Carry, null rows (or a null array) are flat. A row with a Carry holds its
+    // prepaid forward in spot and its zero rate in riskFreeRate, which prices Europeans exactly.
+    // Batch Greeks are restated against the spot, as the single-contract ones are. The binomial
+    // lattice reads the Carry itself for American rows, other American pricers reject rows whose
+    // Carry is not flat
+    const Carry* const* carry = nullptr;
+
+    // Row i has no Carry or a flat one, see MarketData::isFlat
+    bool isFlat(size_t i) const;
+
+    // View of contracts [begin, end) of this batch
+    OptionBatch slice(size_t begin, size_t end) const {
+        return OptionBatch{
+            strike + begin, expiry + begin, type + begin, style + begin,
+            spot + begin, riskFreeRate + begin, volatility + begin, end - begin,
+            carry ? carry + begin : nullptr
+        };
+    }
+};
+
+// Caller-owned SoA output buffers for batch Greeks, each array holds the count entries passed with it
+struct GreeksBatch {
+    double* price;
+    double* delta;
+    double* gamma;
+    double* theta;
+    double* vega;
+    double* rho;
+};
+
+// Owning SoA storage for a chain, hands out OptionBatch views for the batch pricers
+class OptionChain {
+    public:
+        void reserve(size_t n) {
+            strikes.reserve(n); expiries.reserve(n); types.reserve(n); styles.reserve(n);
+            spots.reserve(n); rates.reserve(n); volatilities.reserve(n);
+        }
+
+        void add(const Option& option, const MarketData& marketData) {
+            strikes.push_back(option.getStrike());
+            expiries.push_back(option.getExpiry());
+            types.push_back(option.getType());
+            styles.push_back(option.getStyle());
+            spots.push_back(marketData.getPrepaidForward(option.getExpiry()));
+            rates.push_back(marketData.getRiskFreeRate(option.getExpiry()));
+            volatilities.push_back(marketData.getVolatility(option));
+            if (marketData.getCarry() || !carries.empty()) {
+                addCarry(marketData.getCarry());
+            }
+        }
+
+        // Copies row i of a batch as it stands, its Carry (if any) must outlive this chain
+        void addRow(const OptionBatch& batch, size_t i);
+
+        // Overwrites the volatility column with the surface's vol for each contract
+        void applySurface(const VolSurface& surface);
+
+        void clear() {
+            strikes.clear(); expiries.clear(); types.clear(); styles.clear();
+            spots.clear(); rates.clear(); volatilities.clear();
+            carries.clear(); carryOwners.clear();
+        }
+
+        size_t size() const { return strikes.size(); }
+
+        OptionBatch batch() const {
+            return OptionBatch{
+                strikes.data(), expiries.data(), types.data(), styles.data(),
+                spots.data(), rates.data(), volatilities.data(), strikes.size(),
+                carries.empty() ? nullptr : carries.data()
+            };
+        }
+
+    private:
+        void addCarry(const std::shared_ptr<const Carry>& carry);
+
+        std::vector<double> strikes;
+        std::vector<double> expiries;
+        std::vector<Option::Type> types;
+        std::vector<Option::Style> styles;
+        std::vector<double> spots;
+        std::vector<double> rates;
+        std::vector<double> volatilities;
+        // Empty until the first contract with a Carry, then one entry per contract
+        std::vector<const Carry*> carries;
+        std::vector<std::shared_ptr<const Carry>> carryOwners;
 };
 
 
@@ -105,7 +323,44 @@ class StatisticalAnalyzer {
             double standard_deviation;
         };
 
+        // Price series of many contracts, sample-major: sample k of contract c sits at
+        // [k * contracts + c], so the moment updates run along contiguous rows
+        struct SeriesBatch {
+            const double* prices1;
+            const double* prices2;
+            size_t contracts;
+            size_t samples;
+        };
+
+        // One entry per contract, any pointer may be null to skip that output. Without pValue
+        // the scan never evaluates the t distribution, significance compares |t| to the critical value
+        struct ResultBatch {
+            double* pValue;
+            double* confidenceInterval;
+            bool* isSignificant;
+            double* meanDifference;
+            double* standardDeviation;
+        };
+
+        // Two-sided tests at this confidence level, the confidence interval is its half-width
+        explicit StatisticalAnalyzer(double confidenceLevel = 0.95);
+
+        double getConfidenceLevel() const { return confidenceLevel; }
+
+        // Paired t-test on prices1 - prices2: one pass of Welford moments, exact Student-t with n - 1
+        // degrees of freedom, no allocation
         AnalysisResult analyzePricingDifference(const std::vector<double>& prices1, const std::vector<double>& prices2) const;
+
+        // The same test for every contract of a batch in one vectorized pass
+        void analyzePricingDifferences(const SeriesBatch& series, const ResultBatch& results) const;
+
+        // Tests a sampled estimate (e.g. Monte Carlo) against a reference price using the estimate's
+        // own standard error, standard_deviation reports that standard error
+        AnalysisResult analyzeEstimate(double estimate, double standardError, double reference) const;
+
+    private:
+        double confidenceLevel;
+        double normalCritical;   // two-sided normal critical value at the confidence level
 };
 
 
@@ -115,6 +370,18 @@ class TradingDecision {
     public:
         // Types of actions to be made
         enum class Action { BUY, SELL, HOLD };
+
+        // Action together with the scenario prices and analysis behind it, so callers never re-price
+        struct Decision {
+            Action action;
+            StatisticalAnalyzer::AnalysisResult analysis;
+            std::vector<double> prices1;  // strategies[0] across the volatility sweep
+            std::vector<double> prices2;  // strategies[1] across the volatility sweep
+            bool refined = false;         // screen() fell back to the full strategies
+        };
+
+        // Without a pool the volatility sweep runs on the calling thread
+        explicit TradingDecision(WorkStealingPool* pool = nullptr) : pool(pool) {}
         
         // Function to make descision based on data, strategies, market data, and statistical analysis
         Action makeDecision(
@@ -123,6 +390,39 @@ class TradingDecision {
             const MarketData& marketData,
             const StatisticalAnalyzer& analyzer
         );
+
+        // Same decision, also returning the sweep and its analysis
+        Decision evaluate(
+            const Option& option,
+            const std::vector<std::unique_ptr<PricingStrategy>>& strategies,
+            const MarketData& marketData,
+            const StatisticalAnalyzer& analyzer
+        );
+
+        // Hybrid decision for screening American contracts: the sweep runs on the cheap screeners
+        // (e.g. the closed-form approximations) and their decision is kept when it is clear. That is
+        // an edge more than band inside the threshold (HOLD for any pricing error up to band), or
+        // more than band outside it with the screened difference significant by margin times its
+        // critical value (BUY or SELL). band is the screeners' error as a fraction of spot. The
+        // second case is a proxy for the full strategies' test, so it can differ from evaluate() on
+        // a few contracts. Every other contract is re-run on strategies. European contracts go
+        // straight to strategies
+        Decision screen(
+            const Option& option,
+            const std::vector<std::unique_ptr<PricingStrategy>>& screeners,
+            const std::vector<std::unique_ptr<PricingStrategy>>& strategies,
+            const MarketData& marketData,
+            const StatisticalAnalyzer& analyzer,
+            double band = 0.005,
+            double margin = 2.0
+        );
+
+    private:
+        // Edge of the theoretical price over spot, and the volatility-adjusted edge that triggers a trade
+        static double edge(const Decision& decision, const MarketData& marketData);
+        static double threshold(const Option& option, const MarketData& marketData);
+
+        WorkStealingPool* pool;
 };
 
 
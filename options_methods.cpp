@@ -1,4 +1,11 @@
 #include "options_classes.hpp"
+#include "simd_kernels.hpp"
+#include "lattice_engine.hpp"
+#include "payoff.hpp"
+#include "thread_pool.hpp"
+#include "vol_surface.hpp"
+#include "term_structure.hpp"
+#include "instrumentation.hpp"
 #include <vector>
 #include <memory>
 #include <cmath>
@@ -6,6 +13,7 @@
 #include <numeric>
 #include <algorithm>
 #include <iostream>
+#include <limits>
 
 // Enhanced utility functions
 namespace Utils {
@@ -19,190 +27,1252 @@ namespace Utils {
         return (1.0 / sqrt(2.0 * M_PI)) * exp(-0.5 * x * x);
     }
 
-    // Added for Greeks calculations
-    struct Greeks {
-        double delta;
-        double gamma;
-        double theta;
-        double vega;
-        double rho;
+    // Continued fraction of the regularized incomplete beta (modified Lentz), converges for
+    // x < (a + 1) / (a + b + 2) in O(sqrt(max(a, b))) terms
+    double betaContinuedFraction(double a, double b, double x) {
+        const double tiny = 1e-300;
+        const int maxTerms = 200 + static_cast<int>(10 * sqrt(std::max(a, b)));
+        double c = 1.0;
+        double d = 1.0 - (a + b) * x / (a + 1);
+        d = 1.0 / (std::abs(d) < tiny ? tiny : d);
+        double h = d;
+        for (int m = 1; m <= maxTerms; ++m) {
+            const double even = m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+            d = 1.0 + even * d;
+            d = 1.0 / (std::abs(d) < tiny ? tiny : d);
+            c = 1.0 + even / c;
+            c = std::abs(c) < tiny ? tiny : c;
+            h *= d * c;
+
+            const double odd = -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+            d = 1.0 + odd * d;
+            d = 1.0 / (std::abs(d) < tiny ? tiny : d);
+            c = 1.0 + odd / c;
+            c = std::abs(c) < tiny ? tiny : c;
+            const double step = d * c;
+            h *= step;
+            if (std::abs(step - 1.0) < 1e-15) {
+                break;
+            }
+        }
+        return h;
+    }
+
+    // Student's t with df degrees of freedom, df = infinity being the standard normal. The
+    // log-gamma terms depend on df alone and are computed once
+    class StudentT {
+        public:
+            explicit StudentT(double df)
+                : df(df), a(0.5 * df),
+                  logBeta(std::isinf(df) ? 0.0 : std::lgamma(a) + std::lgamma(0.5) - std::lgamma(a + 0.5)),
+                  logDensityScale(std::isinf(df) ? -0.5 * log(2.0 * M_PI) : -logBeta - 0.5 * log(df)) {
+                // Integer df: P(|T| < t) is a polynomial in cos^2 of atan(t / sqrt(df)) (A&S 26.7.3-4),
+                // coefficients (k-1)/k products over k of the parity of df, highest power first
+                if (df == std::floor(df) && df >= 2 && df <= MAX_SERIES_DF) {
+                    double term = 1.0;
+                    series.push_back(term);
+                    for (int k = static_cast<int>(df) % 2 == 0 ? 2 : 3; k <= df - 2; k += 2) {
+                        term *= (k - 1.0) / k;
+                        series.push_back(term);
+                    }
+                    std::reverse(series.begin(), series.end());
+                }
+            }
+
+            double degreesOfFreedom() const { return df; }
+
+            // P(|T| > |t|) = I_x(df/2, 1/2) with x = df / (df + t^2)
+            double twoSidedTail(double t) const {
+                if (std::isinf(df)) {
+                    return erfc(std::abs(t) / sqrt(2.0));
+                }
+                if (std::isinf(t)) {
+                    return 0.0;
+                }
+                const double t2 = t * t;
+                const double x = df / (df + t2);
+                const double y = t2 / (df + t2);   // 1 - x without cancellation
+                if (y == 0.0) {
+                    return 1.0;
+                }
+
+                // The closed form subtracts from 1, kept while the tail is large enough to lose
+                // no more than three digits
+                if (!series.empty()) {
+                    double sum = 0.0;
+                    for (const double c : series) {
+                        sum = sum * x + c;
+                    }
+                    const double sine = sqrt(y);
+                    const double inside = static_cast<int>(df) % 2 == 0
+                        ? sine * sum
+                        : (2.0 / M_PI) * (atan(std::abs(t) / sqrt(df)) + sine * sqrt(x) * sum);
+                    if (inside < 0.999) {
+                        return 1.0 - inside;
+                    }
+                }
+
+                const double front = exp(a * log(x) + 0.5 * log(y) - logBeta);
+                return x < (a + 1) / (a + 2.5) ? front * betaContinuedFraction(a, 0.5, x) / a
+                                               : 1.0 - front * betaContinuedFraction(0.5, a, y) / 0.5;
+            }
+
+            double density(double t) const {
+                if (std::isinf(df)) {
+                    return exp(logDensityScale - 0.5 * t * t);
+                }
+                return exp(logDensityScale - (a + 0.5) * log1p(t * t / df));
+            }
+
+            // t > 0 with P(|T| > t) = alpha: Newton on log P, started from the normal quantile
+            // with the Cornish-Fisher correction for df
+            double criticalValue(double alpha) const {
+                const double q = 0.5 * alpha;
+                const double w = sqrt(-2.0 * log(q));
+                const double z = w - (2.515517 + w * (0.802853 + w * 0.010328)) /
+                                     (1.0 + w * (1.432788 + w * (0.189269 + w * 0.001308)));
+                double t = z;
+                if (!std::isinf(df)) {
+                    const double z2 = z * z;
+                    t += z * (z2 + 1) / (4 * df) + z * (5 * z2 * z2 + 16 * z2 + 3) / (96 * df * df) +
+                         z * (3 * z2 * z2 * z2 + 19 * z2 * z2 + 17 * z2 - 15) / (384 * df * df * df);
+                }
+
+                const double logAlpha = log(alpha);
+                for (int i = 0; i < 100; ++i) {
+                    const double tail = twoSidedTail(t);
+                    const double next = t + (log(tail) - logAlpha) * tail / (2 * density(t));
+                    const double moved = next > 0 ? next : 0.5 * t;
+                    if (std::abs(moved - t) <= 1e-14 * t) {
+                        return moved;
+                    }
+                    t = moved;
+                }
+                return t;
+            }
+
+        private:
+            static constexpr double MAX_SERIES_DF = 256;
+
+            double df;
+            double a;
+            double logBeta;           // log B(df/2, 1/2)
+            double logDensityScale;   // log of the density at 0
+            std::vector<double> series;
+    };
+
+    // Distribution and critical value of the last (df, alpha) asked for on this thread, analyzers
+    // test many series of the same length
+    struct TTest {
+        StudentT distribution{INFINITY};
+        double alpha = -1.0;
+        double critical = 0.0;
+    };
+
+    const TTest& tTest(double df, double alpha) {
+        thread_local TTest cached;
+        if (df != cached.distribution.degreesOfFreedom() || alpha != cached.alpha) {
+            cached.distribution = StudentT(df);
+            cached.alpha = alpha;
+            cached.critical = cached.distribution.criticalValue(alpha);
+        }
+        return cached;
+    }
+
+    // Welford update with the sample's reciprocal count, shared by the scalar and batch tests
+    inline void welford(double x, double inverseCount, double& mean, double& m2) {
+        const double delta = x - mean;
+        mean += delta * inverseCount;
+        m2 += delta * (x - mean);
+    }
+
+    // t statistic of a mean with standard error, a zero error gives 0 for a zero mean and
+    // an infinite t otherwise
+    inline double tStatistic(double mean, double standardError) {
+        if (standardError > 0) {
+            return mean / standardError;
+        }
+        return mean == 0 ? 0.0 : std::copysign(INFINITY, mean);
+    }
+}
+
+// Shared pricing kernels, used by both the single-contract and batch entry points
+namespace Utils {
+    void validateInputs(double S, double K, double T, double sigma) {
+        if (S <= 0 || K <= 0 || T <= 0 || sigma <= 0) {
+            throw std::invalid_argument("Invalid parameters: All values must be positive");
+        }
+    }
+
+    template <Option::Type TYPE>
+    double blackScholesPrice(double S, double K, double r, double sigma, double T) {
+        const double d1 = (log(S/K) + (r + sigma*sigma/2)*T) / (sigma*sqrt(T));
+        const double d2 = d1 - sigma*sqrt(T);
+
+        // Both types as sgn * (S N(sgn d1) - K e^-rT N(sgn d2)), sgn known at compile time
+        constexpr double sgn = Payoff::Vanilla<TYPE>::SIGN;
+        return sgn * (S * normalCDF(sgn * d1) - K * exp(-r*T) * normalCDF(sgn * d2));
+    }
+
+    // Closed-form Greeks sharing d1, d2, N(.) and n(d1) with the price
+    // Put terms use sgn = -1 so both types share price = sgn * (S N(sgn d1) - K e^-rT N(sgn d2))
+    template <Option::Type TYPE>
+    PriceWithGreeks blackScholesGreeks(double S, double K, double r, double sigma, double T) {
+        const double sqrtT = sqrt(T);
+        const double d1 = (log(S/K) + (r + sigma*sigma/2)*T) / (sigma*sqrtT);
+        const double d2 = d1 - sigma*sqrtT;
+        constexpr double sgn = Payoff::Vanilla<TYPE>::SIGN;
+
+        const double nd1 = normalCDF(sgn * d1);
+        const double discountedK = K * exp(-r*T);
+        const double kd2 = discountedK * normalCDF(sgn * d2);
+        const double pdf = normalPDF(d1);
+
+        PriceWithGreeks result;
+        result.price = sgn * (S * nd1 - kd2);
+        result.greeks.delta = sgn * nd1;
+        result.greeks.gamma = pdf / (S * sigma * sqrtT);
+        result.greeks.theta = -S * pdf * sigma / (2 * sqrtT) - sgn * r * kd2;
+        result.greeks.vega = S * pdf * sqrtT;
+        result.greeks.rho = sgn * T * kd2;
+        return result;
+    }
+
+    // Greeks taken against the prepaid forward F = (S - PV(dividends)) e^(-qT) restated against
+    // the spot, dF/dS = e^(-qT). Theta and rho stay those of the equivalent flat contract
+    void spotGreeks(const Carry& carry, double T, Greeks& greeks) {
+        if (carry.dividendYield() == 0) {
+            return;
+        }
+        const double dFdS = exp(-carry.dividendYield() * T);
+        greeks.delta *= dFdS;
+        greeks.gamma *= dFdS * dFdS;
+    }
+
+    // The same for the rows of a batch priced on their prepaid-forward column, except those in
+    // skip (the carry trees, already against the spot), so batch Greeks match the scalar ones
+    void spotGreeks(const OptionBatch& batch, const GreeksBatch& greeks, const Carry* const* skip = nullptr) {
+        if (!batch.carry) {
+            return;
+        }
+        for (size_t i = 0; i < batch.size; ++i) {
+            const Carry* carry = batch.carry[i];
+            if (!carry || (skip && skip[i])) {
+                continue;
+            }
+            Greeks row{greeks.delta[i], greeks.gamma[i], 0.0, 0.0, 0.0};
+            spotGreeks(*carry, batch.expiry[i], row);
+            greeks.delta[i] = row.delta;
+            greeks.gamma[i] = row.gamma;
+        }
+    }
+
+    // Row i of a batch as the single-contract pricers take it. A row with a Carry gets its spot back
+    // from the prepaid-forward column and the Carry itself, which the batch keeps alive, so each
+    // pricer applies or rejects the Carry exactly as it does for one contract
+    MarketData rowMarketData(const OptionBatch& batch, size_t i) {
+        const Carry* carry = batch.carry ? batch.carry[i] : nullptr;
+        if (!carry) {
+            return MarketData(batch.spot[i], batch.riskFreeRate[i], batch.volatility[i]);
+        }
+        const std::shared_ptr<const Carry> borrowed(std::shared_ptr<const Carry>(), carry);
+        return MarketData(carry->spotFor(batch.spot[i], batch.expiry[i]), batch.riskFreeRate[i], batch.volatility[i])
+            .withCarry(borrowed);
+    }
+
+    // Adaptive time steps based on option expiry
+    int binomialSteps(double T) {
+        return static_cast<int>(std::min(1000.0, std::max(100.0, T * 365)));
+    }
+
+    // Pow-free lattice on the calling thread's arena, no heap allocation once the arena has grown
+    template <Option::Type TYPE, Option::Style STYLE>
+    double binomialPrice(int N, double S, double K, double r, double sigma, double T) {
+        const Lattice::Geometry geometry = Lattice::crrGeometry(r, sigma, T, N);
+
+        Lattice::Arena& arena = Lattice::threadArena();
+        arena.reset(Lattice::tableSize(N) + N + 1);
+        const double* spots = Lattice::buildSpots(S, geometry, arena);
+
+        Lattice::Lane lane{geometry, Lattice::buildExercise<TYPE>(spots, N, K, arena), arena.take(N + 1)};
+        Lattice::sweep<STYLE>(&lane, 1);
+        return lane.values[0];
+    }
+
+    // Delta, gamma and theta are read off the first lattice levels of the pricing sweep
+    // Rho comes from rate-bumped lanes sharing that sweep's exercise table, vega from one
+    // more sweep carrying both volatility bumps, so a full Greeks set costs two passes
+    template <Option::Type TYPE, Option::Style STYLE>
+    PriceWithGreeks binomialGreeks(int N, double S, double K, double r, double sigma, double T) {
+        const double dt = T/N;
+        const double rateBump = 1e-4;
+        const double volBump = std::min(1e-2, 0.5 * sigma);  // sigma - volBump stays positive at low vols
+
+        Lattice::Arena& arena = Lattice::threadArena();
+        arena.reset(3 * Lattice::tableSize(N) + 3 * (N + 1));
+
+        const Lattice::Geometry geometry = Lattice::crrGeometry(r, sigma, T, N);
+        const Lattice::ExerciseTable exercise =
+            Lattice::buildExercise<TYPE>(Lattice::buildSpots(S, geometry, arena), N, K, arena);
+
+        Lattice::Levels levels;
+        Lattice::Lane rateLanes[3] = {
+            {geometry, exercise, arena.take(N + 1)},
+            {Lattice::crrGeometry(r + rateBump, sigma, T, N), exercise, arena.take(N + 1)},
+            {Lattice::crrGeometry(r - rateBump, sigma, T, N), exercise, arena.take(N + 1)}
+        };
+        Lattice::sweep<STYLE>(rateLanes, 3, &levels);
+        const double price = rateLanes[0].values[0];
+        const double rho = (rateLanes[1].values[0] - rateLanes[2].values[0]) / (2 * rateBump);
+
+        Lattice::Lane volLanes[2];
+        const double bumpedVols[2] = {sigma + volBump, sigma - volBump};
+        for (int k = 0; k < 2; ++k) {
+            const Lattice::Geometry bumped = Lattice::crrGeometry(r, bumpedVols[k], T, N);
+            const double* spots = Lattice::buildSpots(S, bumped, arena);
+            volLanes[k] = Lattice::Lane{bumped, Lattice::buildExercise<TYPE>(spots, N, K, arena), rateLanes[k].values};
+        }
+        Lattice::sweep<STYLE>(volLanes, 2);
+        const double vega = (volLanes[0].values[0] - volLanes[1].values[0]) / (2 * volBump);
+
+        Greeks greeks = Lattice::levelGreeks(levels, price, S, geometry.u, dt);
+        greeks.vega = vega;
+        greeks.rho = rho;
+        return PriceWithGreeks{price, greeks};
+    }
+
+    using Scheme = BinomialSettings::Scheme;
+
+    // Leading order of a scheme's error in 1/N, for extrapolation and the tolerance search.
+    // Early exercise leaves every scheme first order, Leisen-Reimer Europeans converge in 1/N^2
+    int schemeOrder(Scheme scheme, bool isAmerican) {
+        return scheme == Scheme::LEISEN_REIMER && !isAmerican ? 2 : 1;
+    }
+
+    // Leisen-Reimer trees must be odd, and every tree keeps two lattice levels for the Greeks
+    int schemeSteps(Scheme scheme, int N) {
+        N = std::max(N, 4);
+        return scheme == Scheme::LEISEN_REIMER ? (N | 1) : N;
+    }
+
+    struct SchemeTree {
+        double price;
+        Lattice::Geometry geometry;
+        Lattice::Levels levels;
     };
+
+    // One Leisen-Reimer or smoothed tree, the schemes whose levels need sweepFrom
+    template <Option::Type TYPE, Option::Style STYLE>
+    SchemeTree schemeTree(Scheme scheme, int N, double S, double K, double r, double sigma, double T) {
+        Lattice::Arena& arena = Lattice::threadArena();
+        arena.reset(Lattice::tableSize(N) + 2 * (N + 1));
+
+        SchemeTree tree;
+        const double* spots;
+        double* terminal;
+        if (scheme == Scheme::LEISEN_REIMER) {
+            tree.geometry = Lattice::leisenReimerGeometry(S, K, r, sigma, T, N);
+            spots = Lattice::buildSpots(S, tree.geometry, arena);
+            terminal = arena.take(N + 1);
+            const double centre = exp(N * tree.geometry.drift);
+            for (int j = 0; j <= N; ++j) {
+                terminal[j] = Payoff::Vanilla<TYPE>::exercise(spots[2 * j] * centre, K);
+            }
+        } else {
+            // The last step in closed form: leaves of the (N-1)-step tree hold a European with dt to run
+            tree.geometry = Lattice::crrGeometry(r, sigma, T, N);
+            tree.geometry.steps = N - 1;
+            spots = Lattice::buildSpots(S, tree.geometry, arena);
+            terminal = arena.take(N);
+            const double dt = T/N;
+            for (int j = 0; j < N; ++j) {
+                terminal[j] = blackScholesPrice<TYPE>(spots[2 * j], K, r, sigma, dt);
+                if (Payoff::Exercise<STYLE>::EARLY) {
+                    terminal[j] = std::max(terminal[j], Payoff::Vanilla<TYPE>::intrinsic(spots[2 * j], K));
+                }
+            }
+        }
+
+        double* values = arena.take(N + 1);
+        Lattice::sweepFrom<TYPE, STYLE>(tree.geometry, spots, terminal, K, values, &tree.levels);
+        tree.price = values[0];
+        return tree;
+    }
+
+    // American contracts under a Carry need its dividend dates in the tree, everything else
+    // prices exactly from the prepaid forward and zero rate alone
+    const Carry* latticeCarry(const Carry* carry, bool isAmerican) {
+        return carry && isAmerican && !carry->isFlat() ? carry : nullptr;
+    }
+
+    // Level tables of the carry tree, built once per (carry, T, N) on each thread. A few slots
+    // replaced round robin, so a chain interleaving its listed expiries keeps reusing them
+    struct CarrySteps {
+        uint64_t carry = 0;
+        double T = 0.0;
+        int N = 0;
+        std::vector<double> growth, scale, shift;
+    };
+
+    const CarrySteps& carrySteps(const Carry& carry, double T, int N) {
+        constexpr size_t slotCount = 16;
+        thread_local CarrySteps slots[slotCount];
+        thread_local size_t nextSlot = 0;
+        for (const CarrySteps& steps : slots) {
+            if (steps.carry == carry.id() && steps.T == T && steps.N == N) {
+                return steps;
+            }
+        }
+
+        CarrySteps& steps = slots[nextSlot];
+        nextSlot = (nextSlot + 1) % slotCount;
+        steps.growth.resize(N);
+        steps.scale.resize(N + 1);
+        steps.shift.resize(N + 1);
+        carry.fillSteps(T, N, steps.growth.data(), steps.scale.data(), steps.shift.data());
+        steps.carry = carry.id();
+        steps.T = T;
+        steps.N = N;
+        return steps;
+    }
+
+    struct CarryTree {
+        double price;
+        double u;
+        Lattice::Levels levels;
+    };
+
+    // CRR tree on the prepaid forward F, branching with each level's forward rate. Exercise adds
+    // back the yield and the dividends still ahead, so early exercise sees the real spot
+    template <Option::Type TYPE, Option::Style STYLE>
+    CarryTree carryTree(int N, double F, double K, const Carry& carry, double sigma, double T) {
+        const CarrySteps& steps = carrySteps(carry, T, N);
+        const double u = exp(sigma * sqrt(T/N));
+        const double d = 1.0/u;
+
+        Lattice::Arena& arena = Lattice::threadArena();
+        arena.reset(2 * N + 1 + 2 * N + N + 1);
+        const Lattice::Geometry geometry{N, u, 0.0, 0.0};
+        const double* spots = Lattice::buildSpots(F, geometry, arena);
+        double* up = arena.take(N);
+        double* down = arena.take(N);
+        for (int i = 0; i < N; ++i) {
+            const double p = (steps.growth[i] - d)/(u - d);
+            up[i] = p / steps.growth[i];
+            down[i] = (1 - p) / steps.growth[i];
+        }
+
+        CarryTree tree;
+        tree.u = u;
+        double* values = arena.take(N + 1);
+        Lattice::sweepLevels<TYPE, STYLE>(geometry, spots, Lattice::LevelTable{up, down, steps.scale.data(), steps.shift.data()},
+                             K, values, &tree.levels);
+        tree.price = values[0];
+        return tree;
+    }
+
+    // The curve shifted up and down by BUMP for carry rho, kept per thread and per Carry. Their ids
+    // then stay the same across a chain's contracts, so carrySteps reuses their tables too
+    struct ShiftedCarries {
+        static constexpr double BUMP = 1e-4;
+        uint64_t base = 0;
+        std::unique_ptr<const Carry> higher, lower;
+    };
+
+    const ShiftedCarries& shiftedCarries(const Carry& carry) {
+        constexpr size_t slotCount = 4;
+        thread_local ShiftedCarries slots[slotCount];
+        thread_local size_t nextSlot = 0;
+        for (const ShiftedCarries& shifted : slots) {
+            if (shifted.base == carry.id()) {
+                return shifted;
+            }
+        }
+
+        ShiftedCarries& shifted = slots[nextSlot];
+        nextSlot = (nextSlot + 1) % slotCount;
+        shifted.higher = std::make_unique<const Carry>(carry.shifted(ShiftedCarries::BUMP));
+        shifted.lower = std::make_unique<const Carry>(carry.shifted(-ShiftedCarries::BUMP));
+        shifted.base = carry.id();
+        return shifted;
+    }
+
+    // Level Greeks as in binomialGreeks, taken in F and restated against the spot. Vega from
+    // bumped trees on the same tables, rho from trees on the curve shifted in parallel
+    template <Option::Type TYPE, Option::Style STYLE>
+    PriceWithGreeks carryGreeks(int N, double F, double K, const Carry& carry, double sigma, double T) {
+        const double volBump = std::min(1e-2, 0.5 * sigma);
+        const CarryTree tree = carryTree<TYPE, STYLE>(N, F, K, carry, sigma, T);
+
+        // The root's exercise spot is today's spot, and dF/dS = 1/scale[0]
+        const CarrySteps& steps = carrySteps(carry, T, N);
+        const double dFdS = 1.0 / steps.scale[0];
+        const double S = F * steps.scale[0] + steps.shift[0];
+
+        const double vega = (carryTree<TYPE, STYLE>(N, F, K, carry, sigma + volBump, T).price -
+                             carryTree<TYPE, STYLE>(N, F, K, carry, sigma - volBump, T).price) / (2 * volBump);
+        const ShiftedCarries& shifted = shiftedCarries(carry);
+        const Carry& higher = *shifted.higher;
+        const Carry& lower = *shifted.lower;
+        const double rho = (carryTree<TYPE, STYLE>(N, higher.prepaidForward(S, T), K, higher, sigma, T).price -
+                            carryTree<TYPE, STYLE>(N, lower.prepaidForward(S, T), K, lower, sigma, T).price) /
+                           (2 * ShiftedCarries::BUMP);
+
+        const Greeks level = Lattice::levelGreeks(tree.levels, tree.price, F, tree.u, T/N);
+        return PriceWithGreeks{tree.price, Greeks{level.delta * dFdS, level.gamma * dFdS * dFdS, level.theta, vega, rho}};
+    }
+
+    void requireCrr(Scheme scheme) {
+        if (scheme != Scheme::CRR) {
+            throw std::invalid_argument("Rate curves and dividends on American contracts need the CRR scheme");
+        }
+    }
+
+    // With a lattice carry, S is the prepaid forward and r is unused
+    template <Option::Type TYPE, Option::Style STYLE>
+    double schemePrice(Scheme scheme, int N, double S, double K, double r, double sigma, double T,
+                       const Carry* carry = nullptr) {
+        if (carry) {
+            requireCrr(scheme);
+            return carryTree<TYPE, STYLE>(N, S, K, *carry, sigma, T).price;
+        }
+        return scheme == Scheme::CRR ? binomialPrice<TYPE, STYLE>(N, S, K, r, sigma, T)
+                                     : schemeTree<TYPE, STYLE>(scheme, N, S, K, r, sigma, T).price;
+    }
+
+    // Same level-based Greeks as binomialGreeks, with the level spots of a drifting tree
+    template <Option::Type TYPE, Option::Style STYLE>
+    PriceWithGreeks schemeGreeks(Scheme scheme, int N, double S, double K, double r, double sigma, double T,
+                                 const Carry* carry = nullptr) {
+        if (carry) {
+            requireCrr(scheme);
+            return carryGreeks<TYPE, STYLE>(N, S, K, *carry, sigma, T);
+        }
+        if (scheme == Scheme::CRR) {
+            return binomialGreeks<TYPE, STYLE>(N, S, K, r, sigma, T);
+        }
+        const double rateBump = 1e-4;
+        const double volBump = std::min(1e-2, 0.5 * sigma);
+        const SchemeTree tree = schemeTree<TYPE, STYLE>(scheme, N, S, K, r, sigma, T);
+        const double rho = (schemePrice<TYPE, STYLE>(scheme, N, S, K, r + rateBump, sigma, T) -
+                            schemePrice<TYPE, STYLE>(scheme, N, S, K, r - rateBump, sigma, T)) / (2 * rateBump);
+        const double vega = (schemePrice<TYPE, STYLE>(scheme, N, S, K, r, sigma + volBump, T) -
+                             schemePrice<TYPE, STYLE>(scheme, N, S, K, r, sigma - volBump, T)) / (2 * volBump);
+
+        Greeks greeks = Lattice::levelGreeks(tree.levels, tree.price, S, tree.geometry.u, T/N, tree.geometry.drift);
+        greeks.vega = vega;
+        greeks.rho = rho;
+        return PriceWithGreeks{tree.price, greeks};
+    }
+
+    // Two-point Richardson extrapolation for an error ~ C / N^order
+    double extrapolate(double fine, int fineSteps, double coarse, int coarseSteps, int order) {
+        const double fineWeight = pow(fineSteps, order);
+        const double coarseWeight = pow(coarseSteps, order);
+        return (fineWeight * fine - coarseWeight * coarse) / (fineWeight - coarseWeight);
+    }
+
+    int coarseSteps(Scheme scheme, int N) {
+        return schemeSteps(scheme, N / 2);
+    }
+
+    template <Option::Type TYPE, Option::Style STYLE>
+    double settingsPrice(const BinomialSettings& settings, int N, double S, double K, double r, double sigma, double T,
+                         const Carry* carry = nullptr) {
+        const double fine = schemePrice<TYPE, STYLE>(settings.scheme, N, S, K, r, sigma, T, carry);
+        if (!settings.richardson) {
+            return fine;
+        }
+        const int coarse = coarseSteps(settings.scheme, N);
+        return extrapolate(fine, N, schemePrice<TYPE, STYLE>(settings.scheme, coarse, S, K, r, sigma, T, carry),
+                           coarse, schemeOrder(settings.scheme, Payoff::Exercise<STYLE>::EARLY));
+    }
+
+    // Tolerance mode: trees of 25, 50, 100, ... steps until the change between the last two, scaled
+    // by the scheme's order, estimates an error within tolerance. The change before it must agree
+    // with that rate too, so two trees landing close by accident do not stop the search early.
+    // Returns the N reached, with its price in *price
+    template <Option::Type TYPE, Option::Style STYLE>
+    int targetSteps(const BinomialSettings& settings, double S, double K, double r, double sigma, double T,
+                    double* price, const Carry* carry = nullptr) {
+        const double rate = pow(2.0, schemeOrder(settings.scheme, Payoff::Exercise<STYLE>::EARLY));
+        int N = schemeSteps(settings.scheme, 25);
+        double estimate = settingsPrice<TYPE, STYLE>(settings, N, S, K, r, sigma, T, carry);
+        double previousError = std::numeric_limits<double>::infinity();
+        while (N < settings.maxSteps) {
+            const int next = schemeSteps(settings.scheme, std::min(2 * N, settings.maxSteps));
+            const double refined = settingsPrice<TYPE, STYLE>(settings, next, S, K, r, sigma, T, carry);
+            const double error = std::abs(refined - estimate) / (rate - 1);
+            N = next;
+            estimate = refined;
+            if (error <= settings.tolerance && previousError <= 2 * rate * settings.tolerance) {
+                break;
+            }
+            previousError = error;
+        }
+        *price = estimate;
+        return N;
+    }
+
+    int selectedSteps(const BinomialSettings& settings, double T) {
+        return schemeSteps(settings.scheme, settings.steps > 0 ? settings.steps : binomialSteps(T));
+    }
+
+    template <Option::Type TYPE, Option::Style STYLE>
+    double binomialPrice(const BinomialSettings& settings, double S, double K, double r, double sigma, double T,
+                         const Carry* carry = nullptr) {
+        if (settings.tolerance > 0) {
+            double price;
+            targetSteps<TYPE, STYLE>(settings, S, K, r, sigma, T, &price, carry);
+            return price;
+        }
+        return settingsPrice<TYPE, STYLE>(settings, selectedSteps(settings, T), S, K, r, sigma, T, carry);
+    }
+
+    // Greeks at the selected N, every sensitivity extrapolated alongside the price
+    template <Option::Type TYPE, Option::Style STYLE>
+    PriceWithGreeks binomialGreeks(const BinomialSettings& settings, double S, double K, double r, double sigma,
+                                   double T, const Carry* carry = nullptr) {
+        double unused;
+        const int N = settings.tolerance > 0 ? targetSteps<TYPE, STYLE>(settings, S, K, r, sigma, T, &unused, carry)
+                                             : selectedSteps(settings, T);
+        PriceWithGreeks fine = schemeGreeks<TYPE, STYLE>(settings.scheme, N, S, K, r, sigma, T, carry);
+        if (!settings.richardson) {
+            return fine;
+        }
+
+        const int coarseN = coarseSteps(settings.scheme, N);
+        const PriceWithGreeks coarse = schemeGreeks<TYPE, STYLE>(settings.scheme, coarseN, S, K, r, sigma, T, carry);
+        const int order = schemeOrder(settings.scheme, Payoff::Exercise<STYLE>::EARLY);
+        auto combine = [&](double fineValue, double coarseValue) {
+            return extrapolate(fineValue, N, coarseValue, coarseN, order);
+        };
+        fine.price = combine(fine.price, coarse.price);
+        fine.greeks = Greeks{combine(fine.greeks.delta, coarse.greeks.delta), combine(fine.greeks.gamma, coarse.greeks.gamma),
+                             combine(fine.greeks.theta, coarse.greeks.theta), combine(fine.greeks.vega, coarse.greeks.vega),
+                             combine(fine.greeks.rho, coarse.greeks.rho)};
+        return fine;
+    }
+}
+
+MarketData::MarketData(double spot, double riskFreeRate, std::shared_ptr<const VolSurface> surface)
+    : spot(spot), riskFreeRate(riskFreeRate), volatility(0.0), surface(std::move(surface)) {
+    if (!this->surface) {
+        throw std::invalid_argument("Market data needs a vol surface");
+    }
+    volatility = this->surface->volatility(spot, 1.0);
+}
+
+double MarketData::surfaceVolatility(double strike, double expiry) const {
+    return surface->volatility(strike, expiry);
+}
+
+MarketData MarketData::withCarry(std::shared_ptr<const Carry> carry) const {
+    if (!carry) {
+        throw std::invalid_argument("Market data needs a carry");
+    }
+    MarketData copy(*this);
+    copy.riskFreeRate = carry->zeroRate(1.0);
+    copy.carry = std::move(carry);
+    return copy;
+}
+
+double MarketData::carryRate(double expiry) const {
+    return carry->zeroRate(expiry);
+}
+
+double MarketData::carryForward(double expiry) const {
+    return carry->prepaidForward(spot, expiry);
+}
+
+double MarketData::carryForwardDelta(double expiry) const {
+    return exp(-carry->dividendYield() * expiry);
+}
+
+bool MarketData::carryFlat() const {
+    return carry->isFlat();
+}
+
+bool OptionBatch::isFlat(size_t i) const {
+    return !carry || !carry[i] || carry[i]->isFlat();
+}
+
+void OptionChain::addCarry(const std::shared_ptr<const Carry>& carry) {
+    // Rows before the first Carry are flat
+    carries.resize(strikes.size() - 1, nullptr);
+    carries.push_back(carry.get());
+    if (carry && (carryOwners.empty() || carryOwners.back() != carry)) {
+        carryOwners.push_back(carry);
+    }
+}
+
+void OptionChain::addRow(const OptionBatch& batch, size_t i) {
+    strikes.push_back(batch.strike[i]);
+    expiries.push_back(batch.expiry[i]);
+    types.push_back(batch.type[i]);
+    styles.push_back(batch.style[i]);
+    spots.push_back(batch.spot[i]);
+    rates.push_back(batch.riskFreeRate[i]);
+    volatilities.push_back(batch.volatility[i]);
+    const Carry* carry = batch.carry ? batch.carry[i] : nullptr;
+    if (carry || !carries.empty()) {
+        carries.resize(strikes.size() - 1, nullptr);
+        carries.push_back(carry);
+    }
+}
+
+void OptionChain::applySurface(const VolSurface& surface) {
+    surface.volatilities(strikes.data(), expiries.data(), volatilities.data(), strikes.size());
+}
+
+// Generic batch pricing, one virtual call per contract but no heap allocation
+void PricingStrategy::calculatePrices(const OptionBatch& batch, double* prices, size_t count) {
+    OPTIONS_TIME_SCOPE(STRATEGY_BATCH);
+    if (count < batch.size) {
+        throw std::invalid_argument("Output buffer is smaller than the batch");
+    }
+
+    for (size_t i = 0; i < batch.size; ++i) {
+        const Option option(batch.type[i], batch.style[i], batch.strike[i], batch.expiry[i]);
+        const MarketData marketData = Utils::rowMarketData(batch, i);
+        prices[i] = calculatePrice(option, marketData);
+    }
+}
+
+// Generic Greeks by bumping inputs and re-pricing with central differences
+// Under a Carry every bumped repricing keeps it, the rate bump shifts its whole curve
+PriceWithGreeks PricingStrategy::calculatePriceAndGreeks(const Option& option, const MarketData& marketData) {
+    OPTIONS_TIME_SCOPE(STRATEGY_BUMPED_GREEKS);
+    const double S = marketData.getSpot();
+    const double r = marketData.getRiskFreeRate();
+    const double sigma = marketData.getVolatility(option);
+    const double T = option.getExpiry();
+
+    const double spotBump = 1e-2 * S;
+    const double rateBump = 1e-4;
+    const double volBump = std::min(1e-4, 0.5 * sigma);
+    const double timeBump = std::min(1.0 / 365, 0.5 * T);
+
+    const std::shared_ptr<const Carry>& carry = marketData.getCarry();
+    std::shared_ptr<const Carry> higher, lower;
+    if (carry) {
+        higher = std::make_shared<const Carry>(carry->shifted(rateBump));
+        lower = std::make_shared<const Carry>(carry->shifted(-rateBump));
+    }
+
+    // rateStep is -1, 0 or +1 rate bumps
+    const auto priceAt = [&](double spot, int rateStep, double vol, double expiry) {
+        MarketData bumped(spot, r + rateStep * rateBump, vol);
+        if (carry) {
+            bumped = bumped.withCarry(rateStep > 0 ? higher : rateStep < 0 ? lower : carry);
+        }
+        return calculatePrice(Option(option.getType(), option.getStyle(), option.getStrike(), expiry), bumped);
+    };
+
+    const double price = priceAt(S, 0, sigma, T);
+    const double up = priceAt(S + spotBump, 0, sigma, T);
+    const double down = priceAt(S - spotBump, 0, sigma, T);
+
+    Greeks greeks;
+    greeks.delta = (up - down) / (2 * spotBump);
+    greeks.gamma = (up - 2 * price + down) / (spotBump * spotBump);
+    greeks.theta = -(priceAt(S, 0, sigma, T + timeBump) - priceAt(S, 0, sigma, T - timeBump)) / (2 * timeBump);
+    greeks.vega = (priceAt(S, 0, sigma + volBump, T) - priceAt(S, 0, sigma - volBump, T)) / (2 * volBump);
+    greeks.rho = (priceAt(S, 1, sigma, T) - priceAt(S, -1, sigma, T)) / (2 * rateBump);
+    return PriceWithGreeks{price, greeks};
+}
+
+// Generic batch Greeks, loops over calculatePriceAndGreeks
+void PricingStrategy::calculatePricesAndGreeks(const OptionBatch& batch, const GreeksBatch& greeks, size_t count) {
+    OPTIONS_TIME_SCOPE(STRATEGY_BATCH);
+    if (count < batch.size) {
+        throw std::invalid_argument("Output buffer is smaller than the batch");
+    }
+
+    for (size_t i = 0; i < batch.size; ++i) {
+        const Option option(batch.type[i], batch.style[i], batch.strike[i], batch.expiry[i]);
+        const MarketData marketData = Utils::rowMarketData(batch, i);
+        const PriceWithGreeks result = calculatePriceAndGreeks(option, marketData);
+        greeks.price[i] = result.price;
+        greeks.delta[i] = result.greeks.delta;
+        greeks.gamma[i] = result.greeks.gamma;
+        greeks.theta[i] = result.greeks.theta;
+        greeks.vega[i] = result.greeks.vega;
+        greeks.rho[i] = result.greeks.rho;
+    }
 }
 
 // Improved Black-Scholes with Greeks calculation
 double BlackScholesPricer::calculatePrice(const Option& option, const MarketData& marketData) {
-    // Extract parameters
-    const double S = marketData.getSpot();           
-    const double K = option.getStrike();             
-    const double r = marketData.getRiskFreeRate();   
-    const double sigma = marketData.getVolatility(); 
-    const double T = option.getExpiry();             
+    OPTIONS_TIME_SCOPE(BLACK_SCHOLES_PRICE);
+    // Extract parameters, dividends and the rate curve fold into the prepaid forward and the zero rate to T
+    const double T = option.getExpiry();
+    const double S = marketData.getPrepaidForward(T);
+    const double K = option.getStrike();
+    const double r = marketData.getRiskFreeRate(T);
+    const double sigma = marketData.getVolatility(option);
     
     if (option.getStyle() != Option::Style::EUROPEAN) {
         throw std::invalid_argument("Black-Scholes model only works for European options");
     }
 
     // Added validation checks
-    if (S <= 0 || K <= 0 || T <= 0 || sigma <= 0) {
-        throw std::invalid_argument("Invalid parameters: All values must be positive");
+    Utils::validateInputs(S, K, T, sigma);
+
+    return Payoff::dispatch(option.getType(), [&](auto type) {
+        return Utils::blackScholesPrice<decltype(type)::value>(S, K, r, sigma, T);
+    });
+}
+
+// Batch Black-Scholes, validates the whole chain up front then runs the SIMD or scalar kernel without virtual dispatch
+void BlackScholesPricer::calculatePrices(const OptionBatch& batch, double* prices, size_t count) {
+    OPTIONS_TIME_SCOPE(BLACK_SCHOLES_BATCH);
+    if (count < batch.size) {
+        throw std::invalid_argument("Output buffer is smaller than the batch");
     }
 
-    const double d1 = (log(S/K) + (r + sigma*sigma/2)*T) / (sigma*sqrt(T));
-    const double d2 = d1 - sigma*sqrt(T);
-    
-    double price = 0.0;
-    const bool isCall = option.getType() == Option::Type::CALL;
-    
-    // More efficient calculation using conditional operator
-    price = isCall 
-        ? S * Utils::normalCDF(d1) - K * exp(-r*T) * Utils::normalCDF(d2)
-        : K * exp(-r*T) * Utils::normalCDF(-d2) - S * Utils::normalCDF(-d1);
-    
-    return price;
+    for (size_t i = 0; i < batch.size; ++i) {
+        if (batch.style[i] != Option::Style::EUROPEAN) {
+            throw std::invalid_argument("Black-Scholes model only works for European options");
+        }
+        Utils::validateInputs(batch.spot[i], batch.strike[i], batch.expiry[i], batch.volatility[i]);
+    }
+
+    const Simd::Isa isa = Simd::detectIsa();
+    if (vectorized && isa != Simd::Isa::SCALAR) {
+        Simd::blackScholesBatch(isa, batch, prices);
+        return;
+    }
+
+    // Scalar kernel one type at a time
+    thread_local Payoff::Groups groups;
+    groups.assign(batch);
+    groups.forEach([&](auto type, auto, const size_t* rows, size_t rowCount) {
+        for (size_t k = 0; k < rowCount; ++k) {
+            const size_t i = rows[k];
+            prices[i] = Utils::blackScholesPrice<decltype(type)::value>(batch.spot[i], batch.strike[i],
+                                                                        batch.riskFreeRate[i], batch.volatility[i],
+                                                                        batch.expiry[i]);
+        }
+    });
+}
+
+PriceWithGreeks BlackScholesPricer::calculatePriceAndGreeks(const Option& option, const MarketData& marketData) {
+    OPTIONS_TIME_SCOPE(BLACK_SCHOLES_GREEKS);
+    if (option.getStyle() != Option::Style::EUROPEAN) {
+        throw std::invalid_argument("Black-Scholes model only works for European options");
+    }
+    const double T = option.getExpiry();
+    const double F = marketData.getPrepaidForward(T);
+    Utils::validateInputs(F, option.getStrike(), T, marketData.getVolatility(option));
+
+    PriceWithGreeks result = Payoff::dispatch(option.getType(), [&](auto type) {
+        return Utils::blackScholesGreeks<decltype(type)::value>(F, option.getStrike(), marketData.getRiskFreeRate(T),
+                                                                marketData.getVolatility(option), T);
+    });
+    if (marketData.getCarry()) {
+        Utils::spotGreeks(*marketData.getCarry(), T, result.greeks);
+    }
+    return result;
+}
+
+// Batch risk pass, one evaluation per contract yields price and all Greeks
+void BlackScholesPricer::calculatePricesAndGreeks(const OptionBatch& batch, const GreeksBatch& greeks, size_t count) {
+    OPTIONS_TIME_SCOPE(BLACK_SCHOLES_BATCH_GREEKS);
+    if (count < batch.size) {
+        throw std::invalid_argument("Output buffer is smaller than the batch");
+    }
+
+    for (size_t i = 0; i < batch.size; ++i) {
+        if (batch.style[i] != Option::Style::EUROPEAN) {
+            throw std::invalid_argument("Black-Scholes model only works for European options");
+        }
+        Utils::validateInputs(batch.spot[i], batch.strike[i], batch.expiry[i], batch.volatility[i]);
+    }
+
+    const Simd::Isa isa = Simd::detectIsa();
+    if (vectorized && isa != Simd::Isa::SCALAR) {
+        Simd::blackScholesGreeksBatch(isa, batch, greeks);
+    } else {
+        thread_local Payoff::Groups groups;
+        groups.assign(batch);
+        groups.forEach([&](auto type, auto, const size_t* rows, size_t rowCount) {
+            for (size_t k = 0; k < rowCount; ++k) {
+                const size_t i = rows[k];
+                const PriceWithGreeks result = Utils::blackScholesGreeks<decltype(type)::value>(
+                    batch.spot[i], batch.strike[i], batch.riskFreeRate[i], batch.volatility[i], batch.expiry[i]);
+                greeks.price[i] = result.price;
+                greeks.delta[i] = result.greeks.delta;
+                greeks.gamma[i] = result.greeks.gamma;
+                greeks.theta[i] = result.greeks.theta;
+                greeks.vega[i] = result.greeks.vega;
+                greeks.rho[i] = result.greeks.rho;
+            }
+        });
+    }
+    Utils::spotGreeks(batch, greeks);
+}
+
+BinomialPricer::BinomialPricer(const BinomialSettings& settings) : settings(settings) {
+    if (settings.steps < 0 || (settings.steps > 0 && settings.steps < 4) || settings.tolerance < 0 ||
+        settings.maxSteps < 100) {
+        throw std::invalid_argument("Binomial steps must be 0 or at least 4, tolerance non-negative and maxSteps at least 100");
+    }
+    // Plain CRR error oscillates between odd and even N, so neither a two-tree extrapolation nor
+    // the change between two trees estimates it
+    if (settings.scheme == BinomialSettings::Scheme::CRR && (settings.richardson || settings.tolerance > 0)) {
+        throw std::invalid_argument("Richardson extrapolation and tolerance mode need the Leisen-Reimer or smoothed scheme");
+    }
+}
+
+int BinomialPricer::selectSteps(const Option& option, const MarketData& marketData) const {
+    const double T = option.getExpiry();
+    const double S = marketData.getPrepaidForward(T);
+    const double K = option.getStrike();
+    const double sigma = marketData.getVolatility(option);
+    const bool isAmerican = option.getStyle() == Option::Style::AMERICAN;
+    Utils::validateInputs(S, K, T, sigma);
+
+    if (settings.tolerance > 0) {
+        const Carry* carry = Utils::latticeCarry(marketData.getCarry().get(), isAmerican);
+        return Payoff::dispatch(option.getType(), option.getStyle(), [&](auto type, auto style) {
+            double price;
+            return Utils::targetSteps<decltype(type)::value, decltype(style)::value>(
+                settings, S, K, marketData.getRiskFreeRate(T), sigma, T, &price, carry);
+        });
+    }
+    return Utils::selectedSteps(settings, T);
 }
 
 // Improved Binomial with enhanced efficiency
+// Under a Carry the tree runs on the prepaid forward, Americans on the carry lattice
 double BinomialPricer::calculatePrice(const Option& option, const MarketData& marketData) {
-    const double S = marketData.getSpot();
-    const double K = option.getStrike();
-    const double r = marketData.getRiskFreeRate();
-    const double sigma = marketData.getVolatility();
+    OPTIONS_TIME_SCOPE(BINOMIAL_PRICE);
     const double T = option.getExpiry();
+    const double S = marketData.getPrepaidForward(T);
+    const double K = option.getStrike();
+    const double r = marketData.getRiskFreeRate(T);
+    const double sigma = marketData.getVolatility(option);
+    const bool isAmerican = option.getStyle() == Option::Style::AMERICAN;
 
     // Added validation
-    if (S <= 0 || K <= 0 || T <= 0 || sigma <= 0) {
-        throw std::invalid_argument("Invalid parameters: All values must be positive");
-    }
+    Utils::validateInputs(S, K, T, sigma);
 
-    // Adaptive time steps based on option expiry
-    const int N = static_cast<int>(std::min(1000.0, std::max(100.0, T * 365))); 
-    const double dt = T/N;
+    const Carry* carry = Utils::latticeCarry(marketData.getCarry().get(), isAmerican);
+    return Payoff::dispatch(option.getType(), option.getStyle(), [&](auto type, auto style) {
+        return Utils::binomialPrice<decltype(type)::value, decltype(style)::value>(settings, S, K, r, sigma, T, carry);
+    });
+}
 
-    // Precompute constants
-    const double u = exp(sigma * sqrt(dt));
-    const double d = 1.0/u;
-    const double p = (exp(r * dt) - d)/(u - d);
-    const double discount = exp(-r * dt);
+// Lattice Greeks in two sweeps instead of a bump-and-reprice per sensitivity
+PriceWithGreeks BinomialPricer::calculatePriceAndGreeks(const Option& option, const MarketData& marketData) {
+    OPTIONS_TIME_SCOPE(BINOMIAL_GREEKS);
+    const double T = option.getExpiry();
+    const double S = marketData.getPrepaidForward(T);
+    const double sigma = marketData.getVolatility(option);
+    const bool isAmerican = option.getStyle() == Option::Style::AMERICAN;
+    Utils::validateInputs(S, option.getStrike(), T, sigma);
 
-    // Using single vector for efficiency (avoided 2D vector)
-    std::vector<double> values(N + 1);
-    const bool isCall = option.getType() == Option::Type::CALL;
+    const Carry* carry = Utils::latticeCarry(marketData.getCarry().get(), isAmerican);
+    PriceWithGreeks result = Payoff::dispatch(option.getType(), option.getStyle(), [&](auto type, auto style) {
+        return Utils::binomialGreeks<decltype(type)::value, decltype(style)::value>(
+            settings, S, option.getStrike(), marketData.getRiskFreeRate(T), sigma, T, carry);
+    });
+    if (marketData.getCarry() && !carry) {
+        Utils::spotGreeks(*marketData.getCarry(), T, result.greeks);
+    }
+    return result;
+}
 
-    // Initialize terminal values
-    for(int j = 0; j <= N; ++j) {
-        double spot = S * pow(u, j) * pow(d, N-j);
-        values[j] = isCall ? std::max(0.0, spot - K) : std::max(0.0, K - spot);
+// Batch binomial, validates the chain up front and prices each (type, style) group with its own
+// instantiation, without virtual dispatch
+void BinomialPricer::calculatePrices(const OptionBatch& batch, double* prices, size_t count) {
+    OPTIONS_TIME_SCOPE(BINOMIAL_BATCH);
+    if (count < batch.size) {
+        throw std::invalid_argument("Output buffer is smaller than the batch");
     }
 
-    // Backward induction with early exercise check
-    for(int i = N-1; i >= 0; --i) {
-        for(int j = 0; j <= i; ++j) {
-            double holding_value = discount * (p * values[j+1] + (1-p) * values[j]);
-            
-            if(option.getStyle() == Option::Style::AMERICAN) {
-                double spot = S * pow(u, j) * pow(d, i-j);
-                double exercise_value = isCall ? std::max(0.0, spot - K) : std::max(0.0, K - spot);
-                values[j] = std::max(holding_value, exercise_value);
-            } else {
-                values[j] = holding_value;
-            }
+    for (size_t i = 0; i < batch.size; ++i) {
+        Utils::validateInputs(batch.spot[i], batch.strike[i], batch.expiry[i], batch.volatility[i]);
+    }
+
+    thread_local Payoff::Groups groups;
+    groups.assign(batch);
+    groups.forEach([&](auto type, auto style, const size_t* rows, size_t rowCount) {
+        constexpr Option::Type TYPE = decltype(type)::value;
+        constexpr Option::Style STYLE = decltype(style)::value;
+        for (size_t k = 0; k < rowCount; ++k) {
+            const size_t i = rows[k];
+            const Carry* carry = Utils::latticeCarry(batch.carry ? batch.carry[i] : nullptr, Payoff::Exercise<STYLE>::EARLY);
+            prices[i] = Utils::binomialPrice<TYPE, STYLE>(settings, batch.spot[i], batch.strike[i], batch.riskFreeRate[i],
+                                                          batch.volatility[i], batch.expiry[i], carry);
         }
+    });
+}
+
+// Batch lattice Greeks, each row as calculatePriceAndGreeks takes it: American rows under a Carry
+// that is not flat on the carry tree, every other row on its prepaid-forward and zero-rate columns
+void BinomialPricer::calculatePricesAndGreeks(const OptionBatch& batch, const GreeksBatch& greeks, size_t count) {
+    OPTIONS_TIME_SCOPE(BINOMIAL_BATCH);
+    if (count < batch.size) {
+        throw std::invalid_argument("Output buffer is smaller than the batch");
+    }
+
+    for (size_t i = 0; i < batch.size; ++i) {
+        Utils::validateInputs(batch.spot[i], batch.strike[i], batch.expiry[i], batch.volatility[i]);
     }
 
-    return values[0];
+    thread_local std::vector<const Carry*> trees;
+    trees.assign(batch.size, nullptr);
+    thread_local Payoff::Groups groups;
+    groups.assign(batch);
+    groups.forEach([&](auto type, auto style, const size_t* rows, size_t rowCount) {
+        constexpr Option::Type TYPE = decltype(type)::value;
+        constexpr Option::Style STYLE = decltype(style)::value;
+        for (size_t k = 0; k < rowCount; ++k) {
+            const size_t i = rows[k];
+            trees[i] = Utils::latticeCarry(batch.carry ? batch.carry[i] : nullptr, Payoff::Exercise<STYLE>::EARLY);
+            const PriceWithGreeks result = Utils::binomialGreeks<TYPE, STYLE>(
+                settings, batch.spot[i], batch.strike[i], batch.riskFreeRate[i], batch.volatility[i], batch.expiry[i],
+                trees[i]);
+            greeks.price[i] = result.price;
+            greeks.delta[i] = result.greeks.delta;
+            greeks.gamma[i] = result.greeks.gamma;
+            greeks.theta[i] = result.greeks.theta;
+            greeks.vega[i] = result.greeks.vega;
+            greeks.rho[i] = result.greeks.rho;
+        }
+    });
+    Utils::spotGreeks(batch, greeks, trees.data());
+}
+
+StatisticalAnalyzer::StatisticalAnalyzer(double confidenceLevel) : confidenceLevel(confidenceLevel) {
+    if (!(confidenceLevel > 0 && confidenceLevel < 1)) {
+        throw std::invalid_argument("Confidence level must be between 0 and 1");
+    }
+    normalCritical = Utils::StudentT(INFINITY).criticalValue(1 - confidenceLevel);
 }
 
-// Enhanced Statistical Analyzer with more robust calculations
+// Paired t-test in one pass, Welford moments keep the variance accurate for long series
 StatisticalAnalyzer::AnalysisResult StatisticalAnalyzer::analyzePricingDifference(const std::vector<double>& prices1, const std::vector<double>& prices2) const
 {
-    if (prices1.size() != prices2.size() || prices1.empty()) {
-        throw std::invalid_argument("Price vectors must be of equal non-zero length");
+    if (prices1.size() != prices2.size() || prices1.size() < 2) {
+        throw std::invalid_argument("Price vectors must be of equal length with at least two prices");
     }
 
     const size_t n = prices1.size();
-    std::vector<double> differences(n);
-    std::transform(prices1.begin(), prices1.end(), prices2.begin(), 
-                  differences.begin(), std::minus<double>());
+    double mean_diff = 0.0;
+    double m2 = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        Utils::welford(prices1[i] - prices2[i], 1.0 / (i + 1), mean_diff, m2);
+    }
 
-    // Welch's t-test calculations
-    const double mean_diff = std::accumulate(differences.begin(), differences.end(), 0.0) / n;
-    
-    const double sq_sum = std::transform_reduce(
-        differences.begin(), differences.end(), 
-        differences.begin(), 0.0,
-        std::plus<double>(),
-        [mean_diff](double x, double y) { return (x - mean_diff) * (y - mean_diff); }
-    );
-
-    const double std_dev = std::sqrt(sq_sum / (n - 1));  // Using n-1 for sample variance
+    const double std_dev = std::sqrt(m2 / (n - 1));  // Using n-1 for sample variance
     const double std_error = std_dev / std::sqrt(n);
-    const double t_stat = mean_diff / std_error;
+    const double t_stat = Utils::tStatistic(mean_diff, std_error);
+
+    // Exact Student's t with n - 1 degrees of freedom for both the p-value and the interval
+    const Utils::TTest& test = Utils::tTest(n - 1, 1 - confidenceLevel);
+    const double p_value = test.distribution.twoSidedTail(t_stat);
+    const double critical_value = test.critical;
 
-    // More accurate p-value calculation for different degrees of freedom
+    return AnalysisResult{
+        p_value,
+        critical_value * std_error,
+        std::abs(t_stat) > critical_value,
+        mean_diff,
+        std_dev
+    };
+}
+
+// Contracts go through in tiles whose running moments stay in registers and L1, each sample row
+// of a tile is one vectorizable update
+void StatisticalAnalyzer::analyzePricingDifferences(const SeriesBatch& series, const ResultBatch& results) const {
+    if (series.samples < 2) {
+        throw std::invalid_argument("Each series needs at least two prices");
+    }
+
+    const size_t n = series.samples;
+    const size_t contracts = series.contracts;
     const double df = n - 1;
-    const double p_value = 2.0 * (1.0 - Utils::normalCDF(std::abs(t_stat)));
+    const Utils::TTest test = Utils::tTest(df, 1 - confidenceLevel);
+    const double critical = test.critical;
+    const double inverseSqrtN = 1.0 / std::sqrt(static_cast<double>(n));
 
-    // Calculate confidence interval using Student's t-distribution critical value
-    const double confidence_level = 0.95;
-    const double critical_value = 1.96; // For large samples
-    const double margin_of_error = critical_value * std_error;
+    constexpr size_t TILE = 256;
+    double mean[TILE];
+    double m2[TILE];
+    for (size_t first = 0; first < contracts; first += TILE) {
+        const size_t width = std::min(TILE, contracts - first);
+        std::fill(mean, mean + width, 0.0);
+        std::fill(m2, m2 + width, 0.0);
+        for (size_t k = 0; k < n; ++k) {
+            const double* a = series.prices1 + k * contracts + first;
+            const double* b = series.prices2 + k * contracts + first;
+            const double inverseCount = 1.0 / (k + 1);
+            for (size_t j = 0; j < width; ++j) {
+                Utils::welford(a[j] - b[j], inverseCount, mean[j], m2[j]);
+            }
+        }
+
+        for (size_t j = 0; j < width; ++j) {
+            const size_t c = first + j;
+            const double deviation = std::sqrt(m2[j] / df);
+            const double error = deviation * inverseSqrtN;
+            const double t = Utils::tStatistic(mean[j], error);
+            if (results.pValue) {
+                results.pValue[c] = test.distribution.twoSidedTail(t);
+            }
+            if (results.confidenceInterval) {
+                results.confidenceInterval[c] = critical * error;
+            }
+            if (results.isSignificant) {
+                results.isSignificant[c] = std::abs(t) > critical;
+            }
+            if (results.meanDifference) {
+                results.meanDifference[c] = mean[j];
+            }
+            if (results.standardDeviation) {
+                results.standardDeviation[c] = deviation;
+            }
+        }
+    }
+}
+
+StatisticalAnalyzer::AnalysisResult StatisticalAnalyzer::analyzeEstimate(double estimate, double standardError,
+                                                                      double reference) const {
+    if (!(standardError >= 0)) {
+        throw std::invalid_argument("Standard error must be non-negative");
+    }
+
+    // Sample counts are large, so the estimate's error is normal
+    const double difference = estimate - reference;
+    const double z = Utils::tStatistic(difference, standardError);
+    const double p_value = erfc(std::abs(z) / std::sqrt(2.0));
 
     return AnalysisResult{
         p_value,
-        margin_of_error,
-        p_value < 0.05,
-        mean_diff,    
-        std_dev      
+        normalCritical * standardError,
+        std::abs(z) > normalCritical,
+        difference,
+        standardError
     };
 }
 
 // Enhanced Trading Decision with risk management
 TradingDecision::Action TradingDecision::makeDecision(const Option& option, const std::vector<std::unique_ptr<PricingStrategy>>& strategies, const MarketData& marketData, const StatisticalAnalyzer& analyzer)
 {
+    return evaluate(option, strategies, marketData, analyzer).action;
+}
+
+TradingDecision::Decision TradingDecision::evaluate(const Option& option, const std::vector<std::unique_ptr<PricingStrategy>>& strategies, const MarketData& marketData, const StatisticalAnalyzer& analyzer)
+{
+    OPTIONS_TIME_SCOPE(DECISION);
     if (strategies.size() < 2) {
         throw std::invalid_argument("Need at least two pricing strategies for comparison");
     }
 
-    // Generate a series of prices by varying volatility slightly
-    const int num_samples = 30;  
-    std::vector<double> prices1, prices2;
-    prices1.reserve(num_samples);
-    prices2.reserve(num_samples);
-    
-    for (int i = 0; i < num_samples; i++) {
-        // Create slightly different market conditions for each sample
-        double vol_adjustment = 0.95 + (i * 0.01);  // Vary volatility from 95% to 124% of original
-        MarketData adjusted_data(
-            marketData.getSpot(),
-            marketData.getRiskFreeRate(),
-            marketData.getVolatility() * vol_adjustment
-        );
-        
-        prices1.push_back(strategies[0]->calculatePrice(option, adjusted_data));
-        prices2.push_back(strategies[1]->calculatePrice(option, adjusted_data));
+    // Generate a series of prices by varying volatility slightly, built once as a chain
+    const size_t num_samples = 30;
+    // With a surface the scenarios scale the contract's own vol, rates and dividends carry over
+    const double volatility = marketData.getVolatility(option);
+    OptionChain scenarios;
+    {
+        OPTIONS_TIME_SCOPE(DECISION_SCENARIOS);
+        scenarios.reserve(num_samples);
+        for (size_t i = 0; i < num_samples; i++) {
+            double vol_adjustment = 0.95 + (i * 0.01);  // Vary volatility from 95% to 124% of original
+            scenarios.add(option, marketData.withVolatility(volatility * vol_adjustment));
+        }
+    }
+    const OptionBatch batch = scenarios.batch();
+
+    Decision decision;
+    decision.prices1.resize(num_samples);
+    decision.prices2.resize(num_samples);
+    double* outputs[2] = {decision.prices1.data(), decision.prices2.data()};
+
+    if (pool) {
+        // Tiles of both strategies share the pool, so expensive lattice tiles get stolen by idle threads
+        const size_t tile = std::max<size_t>(1, num_samples / pool->threadCount());
+        const size_t tilesPerStrategy = (num_samples + tile - 1) / tile;
+        pool->parallelFor(2 * tilesPerStrategy, [&](size_t t) {
+            const size_t s = t / tilesPerStrategy;
+            const size_t begin = (t % tilesPerStrategy) * tile;
+            const size_t end = std::min(num_samples, begin + tile);
+            OPTIONS_TIME_STAGE(s == 0 ? Instrumentation::Stage::DECISION_STRATEGY_1 : Instrumentation::Stage::DECISION_STRATEGY_2);
+            strategies[s]->calculatePrices(batch.slice(begin, end), outputs[s] + begin, end - begin);
+        });
+    } else {
+        for (size_t s = 0; s < 2; s++) {
+            OPTIONS_TIME_STAGE(s == 0 ? Instrumentation::Stage::DECISION_STRATEGY_1 : Instrumentation::Stage::DECISION_STRATEGY_2);
+            strategies[s]->calculatePrices(batch, outputs[s], num_samples);
+        }
     }
     
-    auto analysis = analyzer.analyzePricingDifference(prices1, prices2);
+    {
+        OPTIONS_TIME_SCOPE(DECISION_ANALYSIS);
+        decision.analysis = analyzer.analyzePricingDifference(decision.prices1, decision.prices2);
+    }
+    decision.action = Action::HOLD;
 
     // Risk-adjusted decision making
-    if (!analysis.isSignificant) {
-        return Action::HOLD;
+    if (!decision.analysis.isSignificant) {
+        return decision;
     }
 
-    const double market_price = marketData.getSpot();
-    const double theoretical_price = prices1[prices1.size() / 2];  // Use middle price as reference
-    const double edge = (theoretical_price - market_price) / market_price;
+    const double price_edge = edge(decision, marketData);
+    const double adjusted_threshold = threshold(option, marketData);
 
-    // Dynamic thresholds based on volatility
-    const double vol_adjustment = marketData.getVolatility() / 0.2; // Normalize to 20% vol
-    const double BASE_THRESHOLD = 0.02;
-    const double adjusted_threshold = BASE_THRESHOLD * vol_adjustment;
+    if (price_edge > adjusted_threshold) {
+        decision.action = Action::BUY;
+    } else if (price_edge < -adjusted_threshold) {
+        decision.action = Action::SELL;
+    }
+
+    return decision;
+}
+
+TradingDecision::Decision TradingDecision::screen(const Option& option, const std::vector<std::unique_ptr<PricingStrategy>>& screeners, const std::vector<std::unique_ptr<PricingStrategy>>& strategies, const MarketData& marketData, const StatisticalAnalyzer& analyzer, double band, double margin)
+{
+    OPTIONS_TIME_SCOPE(DECISION_SCREEN);
+    if (!(band >= 0)) {
+        throw std::invalid_argument("Screening band must be non-negative");
+    }
+    if (!(margin >= 1)) {
+        throw std::invalid_argument("Screening margin must be at least 1");
+    }
+    if (option.getStyle() != Option::Style::AMERICAN) {
+        return evaluate(option, strategies, marketData, analyzer);
+    }
 
-    if (edge > adjusted_threshold) {
-        return Action::BUY;
-    } else if (edge < -adjusted_threshold) {
-        return Action::SELL;
+    // The decision thresholds the edge and gates it on the significance test. Well inside the
+    // threshold the action is HOLD whatever the test says. Well outside it, a screened difference
+    // significant by margin times its critical value stands in for the full pair's test
+    Decision screened = evaluate(option, screeners, marketData, analyzer);
+    const double screenedEdge = std::abs(edge(screened, marketData));
+    const double limit = threshold(option, marketData);
+    const StatisticalAnalyzer::AnalysisResult& test = screened.analysis;
+    const bool clearlySignificant = test.isSignificant
+        && std::abs(test.mean_difference) > margin * test.confidenceInterval;
+    if (screenedEdge < limit - band || (screenedEdge > limit + band && clearlySignificant)) {
+        return screened;
     }
 
-    return Action::HOLD;
-}
\ No newline at end of file
+    Decision refined = evaluate(option, strategies, marketData, analyzer);
+    refined.refined = true;
+    return refined;
+}
+
+double TradingDecision::edge(const Decision& decision, const MarketData& marketData) {
+    const double market_price = marketData.getSpot();
+    const double theoretical_price = decision.prices1[decision.prices1.size() / 2];  // Use middle price as reference
+    return (theoretical_price - market_price) / market_price;
+}
+
+// Dynamic thresholds based on volatility
+double TradingDecision::threshold(const Option& option, const MarketData& marketData) {
+    const double vol_adjustment = marketData.getVolatility(option) / 0.2; // Normalize to 20% vol
+    const double BASE_THRESHOLD = 0.02;
+    return BASE_THRESHOLD * vol_adjustment;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "options_classes.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// Compile-time payoffs and exercise policies for the pricing kernels
+//
+// Kernels templated on <Option::Type, Option::Style> resolve the call/put sign and the early
+// exercise test when they are compiled, so no node or contract loop tests them. dispatch() turns
+// the runtime type and style into the matching instantiation once per contract, Groups once per
+// run of same-kind contracts of a batch
+namespace Payoff {
+    template <Option::Type TYPE>
+    struct Vanilla {
+        static constexpr bool IS_CALL = TYPE == Option::Type::CALL;
+        static constexpr double SIGN = IS_CALL ? 1.0 : -1.0;
+
+        // Value of exercising at spot, before the floor at zero
+        static constexpr double intrinsic(double spot, double K) { return IS_CALL ? spot - K : K - spot; }
+        static constexpr double exercise(double spot, double K) { return std::max(0.0, intrinsic(spot, K)); }
+    };
+
+    template <Option::Style STYLE>
+    struct Exercise {
+        static constexpr bool EARLY = STYLE == Option::Style::AMERICAN;
+    };
+
+    template <Option::Type TYPE>
+    using TypeTag = std::integral_constant<Option::Type, TYPE>;
+    template <Option::Style STYLE>
+    using StyleTag = std::integral_constant<Option::Style, STYLE>;
+
+    // fn(TypeTag<TYPE>{}), the kernel reads the type back as decltype(tag)::value
+    template <typename Fn>
+    decltype(auto) dispatch(Option::Type type, Fn&& fn) {
+        if (type == Option::Type::CALL) {
+            return fn(TypeTag<Option::Type::CALL>{});
+        }
+        return fn(TypeTag<Option::Type::PUT>{});
+    }
+
+    // fn(TypeTag<TYPE>{}, StyleTag<STYLE>{})
+    template <typename Fn>
+    decltype(auto) dispatch(Option::Type type, Option::Style style, Fn&& fn) {
+        return dispatch(type, [&](auto typeTag) -> decltype(auto) {
+            if (style == Option::Style::AMERICAN) {
+                return fn(typeTag, StyleTag<Option::Style::AMERICAN>{});
+            }
+            return fn(typeTag, StyleTag<Option::Style::EUROPEAN>{});
+        });
+    }
+
+    // Rows of a batch grouped by (type, style) with a counting sort, original order kept within
+    // a group. Buffers are reused across assign() calls
+    class Groups {
+        public:
+            static constexpr size_t KINDS = 4;
+
+            void assign(const OptionBatch& batch) {
+                rows.resize(batch.size);
+                size_t counts[KINDS] = {};
+                for (size_t i = 0; i < batch.size; ++i) {
+                    ++counts[kind(batch.type[i], batch.style[i])];
+                }
+                start[0] = 0;
+                for (size_t k = 0; k < KINDS; ++k) {
+                    start[k + 1] = start[k] + counts[k];
+                }
+                size_t next[KINDS];
+                std::copy(start, start + KINDS, next);
+                for (size_t i = 0; i < batch.size; ++i) {
+                    rows[next[kind(batch.type[i], batch.style[i])]++] = i;
+                }
+            }
+
+            // fn(typeTag, styleTag, rows, count) for each non-empty group
+            template <typename Fn>
+            void forEach(Fn&& fn) const {
+                run<Option::Type::CALL, Option::Style::EUROPEAN>(fn);
+                run<Option::Type::CALL, Option::Style::AMERICAN>(fn);
+                run<Option::Type::PUT, Option::Style::EUROPEAN>(fn);
+                run<Option::Type::PUT, Option::Style::AMERICAN>(fn);
+            }
+
+        private:
+            static constexpr size_t kind(Option::Type type, Option::Style style) {
+                return (type == Option::Type::CALL ? 0 : 2) + (style == Option::Style::AMERICAN ? 1 : 0);
+            }
+
+            template <Option::Type TYPE, Option::Style STYLE, typename Fn>
+            void run(Fn& fn) const {
+                const size_t k = kind(TYPE, STYLE);
+                if (start[k + 1] > start[k]) {
+                    fn(TypeTag<TYPE>{}, StyleTag<STYLE>{}, rows.data() + start[k], start[k + 1] - start[k]);
+                }
+            }
+
+            std::vector<size_t> rows;
+            size_t start[KINDS + 1] = {};
+    };
+}
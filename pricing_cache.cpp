@@ -0,0 +1,373 @@
+#include "pricing_cache.hpp"
+#include "term_structure.hpp"
+#include "instrumentation.hpp"
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    constexpr int32_t EMPTY = -1;
+
+    uint64_t mix(uint64_t h, uint64_t value) {
+        h ^= value + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    int64_t bitsOf(double value) {
+        int64_t bits;
+        std::memcpy(&bits, &value, sizeof bits);
+        return bits;
+    }
+
+    // Bucket of value on a grid of step tolerance, the exact bits when tolerance is 0
+    int64_t quantize(double value, double tolerance) {
+        return tolerance > 0 ? std::llround(value / tolerance) : bitsOf(value);
+    }
+
+    // Batch rows hold the prepaid forward F = (S - PV(dividends)) e^(-qT) while their Greeks are
+    // against the spot, so Taylor moves are taken in F e^(qT), which moves one for one with S
+    double taylorSpot(const OptionBatch& batch, size_t i) {
+        const Carry* carry = batch.carry ? batch.carry[i] : nullptr;
+        return carry ? batch.spot[i] * std::exp(carry->dividendYield() * batch.expiry[i]) : batch.spot[i];
+    }
+
+    size_t nextPowerOfTwo(size_t n) {
+        size_t p = 1;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+    // Per-thread gather buffers for the misses of a batch call
+    struct MissScratch {
+        OptionChain chain;
+        std::vector<size_t> rows;
+        std::vector<double> values;
+    };
+    thread_local MissScratch missScratch;
+}
+
+// Fixed slot ring with CLOCK eviction, indexed by a linear-probing table of slot numbers
+// sized to twice the ring so probe chains stay short
+struct CachedPricer::Shard {
+    mutable std::mutex mutex;
+    std::vector<Entry> slots;
+    std::vector<int32_t> index;
+    size_t indexMask = 0;
+    size_t used = 0;
+    size_t hand = 0;
+    uint64_t hits = 0, taylorHits = 0, misses = 0, evictions = 0;
+
+    void reset(size_t capacity) {
+        slots.assign(capacity, Entry{});
+        index.assign(nextPowerOfTwo(2 * capacity), EMPTY);
+        indexMask = index.size() - 1;
+        used = 0;
+        hand = 0;
+    }
+
+    // Position in index holding key, or the empty position where it would go
+    size_t probe(const Key& key, uint64_t hash) const {
+        size_t position = hash & indexMask;
+        while (index[position] != EMPTY && !(slots[index[position]].key == key)) {
+            position = (position + 1) & indexMask;
+        }
+        return position;
+    }
+
+    // Deletes index[position], shifting later members of the probe chain back into the gap
+    void erase(size_t position) {
+        size_t gap = position;
+        size_t next = position;
+        while (true) {
+            next = (next + 1) & indexMask;
+            if (index[next] == EMPTY) {
+                break;
+            }
+            const size_t home = slots[index[next]].hash & indexMask;
+            // The entry may move into the gap unless its home lies cyclically in (gap, next]
+            const bool homeBetween = gap <= next ? (gap < home && home <= next) : (gap < home || home <= next);
+            if (!homeBetween) {
+                index[gap] = index[next];
+                gap = next;
+            }
+        }
+        index[gap] = EMPTY;
+    }
+
+    // Slot for a new entry: a free one while the ring fills, then the first unreferenced one
+    // under the hand, clearing reference bits on the way
+    size_t claim() {
+        if (used < slots.size()) {
+            return used++;
+        }
+        while (slots[hand].referenced) {
+            slots[hand].referenced = false;
+            hand = (hand + 1) % slots.size();
+        }
+        const size_t victim = hand;
+        hand = (hand + 1) % slots.size();
+        erase(probe(slots[victim].key, slots[victim].hash));
+        ++evictions;
+        return victim;
+    }
+};
+
+CachedPricer::CachedPricer(std::unique_ptr<PricingStrategy> strategy, const CacheSettings& settings)
+    : strategy(std::move(strategy)), settings(settings) {
+    if (!this->strategy) {
+        throw std::invalid_argument("Cache needs a strategy to wrap");
+    }
+    if (settings.shards == 0 || settings.capacity < settings.shards || settings.spotTolerance < 0 ||
+        settings.rateTolerance < 0 || settings.volTolerance < 0 || settings.expiryTolerance < 0 ||
+        settings.taylorRange < 0) {
+        throw std::invalid_argument("Cache needs at least one entry per shard and non-negative tolerances");
+    }
+
+    const size_t shardCount = nextPowerOfTwo(settings.shards);
+    shardMask = shardCount - 1;
+    shards.reset(new Shard[shardCount]);
+    const size_t perShard = (settings.capacity + shardCount - 1) / shardCount;
+    for (size_t s = 0; s < shardCount; ++s) {
+        shards[s].reset(perShard);
+    }
+}
+
+CachedPricer::~CachedPricer() = default;
+
+CachedPricer::Key CachedPricer::makeKey(Option::Type type, Option::Style style, double strike, double expiry,
+                                        double spot, double rate, double volatility, const Carry* carry) const {
+    // With Taylor reuse the spot bucket is the expansion range, so neighbours share one entry
+    const double spotStep = settings.taylorRange > 0 ? settings.taylorRange : settings.spotTolerance;
+    return Key{
+        bitsOf(strike),
+        quantize(expiry, settings.expiryTolerance),
+        spotStep > 0 && spot > 0 ? static_cast<int64_t>(std::floor(std::log(spot) / spotStep)) : bitsOf(spot),
+        quantize(rate, settings.rateTolerance),
+        quantize(volatility, settings.volTolerance),
+        carry ? carry->id() : 0,
+        type,
+        style
+    };
+}
+
+uint64_t CachedPricer::Key::hash() const {
+    uint64_t h = static_cast<uint64_t>(type) * 2 + static_cast<uint64_t>(style);
+    for (const int64_t field : {strike, expiry, spot, rate, volatility}) {
+        h = mix(h, static_cast<uint64_t>(field));
+    }
+    h = mix(h, carry);
+    return h;
+}
+
+CachedPricer::Shard& CachedPricer::shardFor(uint64_t hash) const {
+    // High bits pick the shard, the low ones the index position inside it
+    return shards[(hash >> 48) & shardMask];
+}
+
+bool CachedPricer::lookup(const Key& key, uint64_t hash, double spot, bool needGreeks, PriceWithGreeks& out) const {
+    Shard& shard = shardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const int32_t slot = shard.index[shard.probe(key, hash)];
+    if (slot == EMPTY || (needGreeks && !shard.slots[slot].hasGreeks)) {
+        ++shard.misses;
+        OPTIONS_COUNT(CACHE_MISSES, 1);
+        return false;
+    }
+
+    Entry& entry = shard.slots[slot];
+    entry.referenced = true;
+    out = entry.value;
+    const double move = spot - entry.spot;
+    if (settings.taylorRange > 0 && move != 0.0) {
+        const Greeks& g = entry.value.greeks;
+        out.price += move * (g.delta + 0.5 * g.gamma * move);
+        out.greeks.delta += g.gamma * move;
+        ++shard.taylorHits;
+        OPTIONS_COUNT(CACHE_TAYLOR_HITS, 1);
+    } else {
+        ++shard.hits;
+        OPTIONS_COUNT(CACHE_HITS, 1);
+    }
+    return true;
+}
+
+void CachedPricer::insert(const Key& key, uint64_t hash, double spot, const PriceWithGreeks& value, bool hasGreeks) const {
+    Shard& shard = shardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    size_t position = shard.probe(key, hash);
+    int32_t slot = shard.index[position];
+    if (slot == EMPTY) {
+        slot = static_cast<int32_t>(shard.claim());
+        // Eviction may have shifted the probe chain
+        position = shard.probe(key, hash);
+        shard.index[position] = slot;
+    } else if (shard.slots[slot].hasGreeks && !hasGreeks) {
+        // Another thread stored a richer entry meanwhile
+        return;
+    }
+    shard.slots[slot] = Entry{key, hash, spot, value, hasGreeks, false};
+}
+
+double CachedPricer::calculatePrice(const Option& option, const MarketData& marketData) {
+    OPTIONS_TIME_SCOPE(CACHE_PRICE);
+    const Key key = makeKey(option.getType(), option.getStyle(), option.getStrike(), option.getExpiry(),
+                            marketData.getSpot(), marketData.getRiskFreeRate(), marketData.getVolatility(option),
+                            marketData.getCarry().get());
+    const uint64_t hash = key.hash();
+
+    PriceWithGreeks cached;
+    if (lookup(key, hash, marketData.getSpot(), false, cached)) {
+        return cached.price;
+    }
+
+    // Taylor reuse needs the delta and gamma of every entry
+    if (settings.taylorRange > 0) {
+        const PriceWithGreeks value = strategy->calculatePriceAndGreeks(option, marketData);
+        insert(key, hash, marketData.getSpot(), value, true);
+        return value.price;
+    }
+    PriceWithGreeks value{strategy->calculatePrice(option, marketData), Greeks{}};
+    insert(key, hash, marketData.getSpot(), value, false);
+    return value.price;
+}
+
+PriceWithGreeks CachedPricer::calculatePriceAndGreeks(const Option& option, const MarketData& marketData) {
+    OPTIONS_TIME_SCOPE(CACHE_GREEKS);
+    const Key key = makeKey(option.getType(), option.getStyle(), option.getStrike(), option.getExpiry(),
+                            marketData.getSpot(), marketData.getRiskFreeRate(), marketData.getVolatility(option),
+                            marketData.getCarry().get());
+    const uint64_t hash = key.hash();
+
+    PriceWithGreeks cached;
+    if (lookup(key, hash, marketData.getSpot(), true, cached)) {
+        return cached;
+    }
+    const PriceWithGreeks value = strategy->calculatePriceAndGreeks(option, marketData);
+    insert(key, hash, marketData.getSpot(), value, true);
+    return value;
+}
+
+void CachedPricer::calculatePrices(const OptionBatch& batch, double* prices, size_t count) {
+    OPTIONS_TIME_SCOPE(CACHE_BATCH);
+    if (count < batch.size) {
+        throw std::invalid_argument("Output buffer is smaller than the batch");
+    }
+
+    MissScratch& scratch = missScratch;
+    scratch.chain.clear();
+    scratch.rows.clear();
+    for (size_t i = 0; i < batch.size; ++i) {
+        const Key key = makeKey(batch, i);
+        const uint64_t hash = key.hash();
+        PriceWithGreeks cached;
+        if (lookup(key, hash, taylorSpot(batch, i), false, cached)) {
+            prices[i] = cached.price;
+            continue;
+        }
+        scratch.rows.push_back(i);
+        scratch.chain.addRow(batch, i);
+    }
+
+    const size_t misses = scratch.rows.size();
+    if (misses == 0) {
+        return;
+    }
+
+    const OptionBatch missed = scratch.chain.batch();
+    const bool withGreeks = settings.taylorRange > 0;
+    scratch.values.resize((withGreeks ? 6 : 1) * misses);
+    double* v = scratch.values.data();
+    if (withGreeks) {
+        strategy->calculatePricesAndGreeks(missed, GreeksBatch{v, v + misses, v + 2 * misses, v + 3 * misses,
+                                                               v + 4 * misses, v + 5 * misses}, misses);
+    } else {
+        strategy->calculatePrices(missed, v, misses);
+    }
+
+    for (size_t k = 0; k < misses; ++k) {
+        PriceWithGreeks value{v[k], Greeks{}};
+        if (withGreeks) {
+            value.greeks = Greeks{v[misses + k], v[2 * misses + k], v[3 * misses + k], v[4 * misses + k], v[5 * misses + k]};
+        }
+        prices[scratch.rows[k]] = value.price;
+        const Key key = makeKey(missed, k);
+        insert(key, key.hash(), taylorSpot(missed, k), value, withGreeks);
+    }
+}
+
+void CachedPricer::calculatePricesAndGreeks(const OptionBatch& batch, const GreeksBatch& greeks, size_t count) {
+    OPTIONS_TIME_SCOPE(CACHE_BATCH_GREEKS);
+    if (count < batch.size) {
+        throw std::invalid_argument("Output buffer is smaller than the batch");
+    }
+
+    MissScratch& scratch = missScratch;
+    scratch.chain.clear();
+    scratch.rows.clear();
+    auto store = [&](size_t i, const PriceWithGreeks& value) {
+        greeks.price[i] = value.price;
+        greeks.delta[i] = value.greeks.delta;
+        greeks.gamma[i] = value.greeks.gamma;
+        greeks.theta[i] = value.greeks.theta;
+        greeks.vega[i] = value.greeks.vega;
+        greeks.rho[i] = value.greeks.rho;
+    };
+
+    for (size_t i = 0; i < batch.size; ++i) {
+        const Key key = makeKey(batch, i);
+        const uint64_t hash = key.hash();
+        PriceWithGreeks cached;
+        if (lookup(key, hash, taylorSpot(batch, i), true, cached)) {
+            store(i, cached);
+            continue;
+        }
+        scratch.rows.push_back(i);
+        scratch.chain.addRow(batch, i);
+    }
+
+    const size_t misses = scratch.rows.size();
+    if (misses == 0) {
+        return;
+    }
+
+    const OptionBatch missed = scratch.chain.batch();
+    scratch.values.resize(6 * misses);
+    double* v = scratch.values.data();
+    strategy->calculatePricesAndGreeks(missed, GreeksBatch{v, v + misses, v + 2 * misses, v + 3 * misses,
+                                                           v + 4 * misses, v + 5 * misses}, misses);
+    for (size_t k = 0; k < misses; ++k) {
+        const PriceWithGreeks value{v[k], Greeks{v[misses + k], v[2 * misses + k], v[3 * misses + k],
+                                                 v[4 * misses + k], v[5 * misses + k]}};
+        store(scratch.rows[k], value);
+        const Key key = makeKey(missed, k);
+        insert(key, key.hash(), taylorSpot(missed, k), value, true);
+    }
+}
+
+CacheStats CachedPricer::stats() const {
+    CacheStats total{0, 0, 0, 0, 0};
+    for (size_t s = 0; s <= shardMask; ++s) {
+        std::lock_guard<std::mutex> lock(shards[s].mutex);
+        total.hits += shards[s].hits;
+        total.taylorHits += shards[s].taylorHits;
+        total.misses += shards[s].misses;
+        total.evictions += shards[s].evictions;
+        total.size += shards[s].used;
+    }
+    return total;
+}
+
+void CachedPricer::clear() {
+    for (size_t s = 0; s <= shardMask; ++s) {
+        std::lock_guard<std::mutex> lock(shards[s].mutex);
+        shards[s].reset(shards[s].slots.size());
+        shards[s].hits = shards[s].taylorHits = shards[s].misses = shards[s].evictions = 0;
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "options_classes.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct CacheSettings {
+    size_t capacity = 65536;        // entries over all shards
+    size_t shards = 16;             // independently locked partitions, rounded up to a power of two
+    // Key quantization steps, 0 keys on the exact value. A hit returns the value computed for the
+    // first input seen in its bucket
+    double spotTolerance = 0.0;     // relative, buckets of log spot
+    double rateTolerance = 0.0;     // absolute
+    double volTolerance = 0.0;      // absolute
+    double expiryTolerance = 0.0;   // years
+    // > 0 serves spot moves up to this relative size from the cached delta and gamma, replacing
+    // spotTolerance. Misses then price with Greeks
+    double taylorRange = 0.0;
+};
+
+struct CacheStats {
+    uint64_t hits;         // served as cached
+    uint64_t taylorHits;   // served by a second-order expansion in spot
+    uint64_t misses;
+    uint64_t evictions;
+    size_t size;
+
+    double hitRate() const {
+        const uint64_t total = hits + taylorHits + misses;
+        return total ? static_cast<double>(hits + taylorHits) / total : 0.0;
+    }
+};
+
+// Memoizing decorator over any PricingStrategy
+//
+// Keys are the contract (type, style, strike, expiry) and the quantized market state. Entries
+// live in fixed-capacity shards, each an open-addressed index over a slot ring with CLOCK
+// eviction, so lookups never allocate and contention is spread over the shard locks. Pricing
+// on a miss runs outside the lock, two threads missing the same key both price it.
+// Batch calls collect their misses and price them through the wrapped strategy's batch kernel.
+// The wrapped strategy must be safe to call concurrently, as the built-in pricers are
+class CachedPricer : public PricingStrategy {
+    public:
+        CachedPricer(std::unique_ptr<PricingStrategy> strategy, const CacheSettings& settings = CacheSettings());
+        ~CachedPricer() override;
+
+        double calculatePrice(const Option& option, const MarketData& marketData) override;
+        void calculatePrices(const OptionBatch& batch, double* prices, size_t count) override;
+
+        // Taylor hits shift delta by gamma times the spot move and keep the other Greeks
+        PriceWithGreeks calculatePriceAndGreeks(const Option& option, const MarketData& marketData) override;
+        void calculatePricesAndGreeks(const OptionBatch& batch, const GreeksBatch& greeks, size_t count) override;
+
+        std::string getStrategyName() const override {
+            return "Cached " + strategy->getStrategyName();
+        }
+
+        CacheStats stats() const;
+        void clear();
+
+    private:
+        struct Key {
+            int64_t strike, expiry, spot, rate, volatility;
+            uint64_t carry;         // Carry::id, 0 when flat
+            Option::Type type;
+            Option::Style style;
+
+            bool operator==(const Key& other) const {
+                return strike == other.strike && expiry == other.expiry && spot == other.spot &&
+                       rate == other.rate && volatility == other.volatility && carry == other.carry &&
+                       type == other.type && style == other.style;
+            }
+
+            uint64_t hash() const;
+        };
+
+        struct Entry {
+            Key key;
+            uint64_t hash;
+            double spot;            // spot the value was computed at, the Taylor expansion point
+            PriceWithGreeks value;
+            bool hasGreeks;
+            bool referenced;        // CLOCK bit, set on every hit
+        };
+
+        struct Shard;
+
+        Key makeKey(Option::Type type, Option::Style style, double strike, double expiry,
+                    double spot, double rate, double volatility, const Carry* carry) const;
+        Key makeKey(const OptionBatch& batch, size_t i) const {
+            return makeKey(batch.type[i], batch.style[i], batch.strike[i], batch.expiry[i],
+                           batch.spot[i], batch.riskFreeRate[i], batch.volatility[i],
+                           batch.carry ? batch.carry[i] : nullptr);
+        }
+        Shard& shardFor(uint64_t hash) const;
+
+        // Serves a hit into out, false on a miss
+        bool lookup(const Key& key, uint64_t hash, double spot, bool needGreeks, PriceWithGreeks& out) const;
+        void insert(const Key& key, uint64_t hash, double spot, const PriceWithGreeks& value, bool hasGreeks) const;
+
+        std::unique_ptr<PricingStrategy> strategy;
+        CacheSettings settings;
+        std::unique_ptr<Shard[]> shards;
+        size_t shardMask;
+};
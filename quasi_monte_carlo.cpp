@@ -0,0 +1,349 @@
+#include "quasi_monte_carlo.hpp"
+#include "thread_pool.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    constexpr size_t BLOCK = 1024;  // points per task
+
+    // Joe-Kuo new-joe-kuo-6.21201, dimensions 2..21: degree s, polynomial coefficients a, m_1..m_s
+    struct Primitive {
+        int degree;
+        uint32_t coefficients;
+        uint32_t m[7];
+    };
+    constexpr Primitive JOE_KUO[SobolSequence::MAX_DIMENSIONS - 1] = {
+        {1, 0, {1}},
+        {2, 1, {1, 3}},
+        {3, 1, {1, 3, 1}},
+        {3, 2, {1, 1, 1}},
+        {4, 1, {1, 1, 3, 3}},
+        {4, 4, {1, 3, 5, 13}},
+        {5, 2, {1, 1, 5, 5, 17}},
+        {5, 4, {1, 1, 5, 5, 5}},
+        {5, 7, {1, 1, 7, 11, 19}},
+        {5, 11, {1, 1, 5, 1, 1}},
+        {5, 13, {1, 1, 1, 3, 11}},
+        {5, 14, {1, 3, 5, 5, 31}},
+        {6, 1, {1, 3, 3, 9, 7, 49}},
+        {6, 13, {1, 1, 1, 15, 21, 21}},
+        {6, 16, {1, 3, 1, 13, 27, 49}},
+        {6, 19, {1, 1, 1, 15, 7, 5}},
+        {6, 22, {1, 3, 1, 15, 13, 25}},
+        {6, 25, {1, 1, 5, 5, 19, 61}},
+        {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+        {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+    };
+
+    std::array<SobolSequence::Directions, SobolSequence::MAX_DIMENSIONS> buildDirections() {
+        std::array<SobolSequence::Directions, SobolSequence::MAX_DIMENSIONS> table{};
+        for (int k = 0; k < SobolSequence::BITS; ++k) {
+            table[0][k] = 1u << (31 - k);
+        }
+        for (int d = 1; d < SobolSequence::MAX_DIMENSIONS; ++d) {
+            const Primitive& p = JOE_KUO[d - 1];
+            SobolSequence::Directions& v = table[d];
+            for (int k = 0; k < p.degree; ++k) {
+                v[k] = p.m[k] << (31 - k);
+            }
+            for (int k = p.degree; k < SobolSequence::BITS; ++k) {
+                v[k] = v[k - p.degree] ^ (v[k - p.degree] >> p.degree);
+                for (int i = 1; i < p.degree; ++i) {
+                    if ((p.coefficients >> (p.degree - 1 - i)) & 1) {
+                        v[k] ^= v[k - i];
+                    }
+                }
+            }
+        }
+        return table;
+    }
+
+    // Matousek linear scramble: output digit p is digit p of v xor a random mix of the
+    // more significant digits, a lower triangular matrix with unit diagonal
+    SobolSequence::Directions scramble(const SobolSequence::Directions& v, const Philox4x32::Key& key,
+                                       uint32_t replicate, uint32_t dimension) {
+        uint32_t rows[SobolSequence::BITS];
+        for (uint32_t p = 0; p < SobolSequence::BITS; p += 4) {
+            const Philox4x32::Counter bits = Philox4x32::generate({replicate, dimension, p, 1}, key);
+            for (uint32_t q = 0; q < 4; ++q) {
+                const uint32_t position = p + q;
+                const uint32_t above = static_cast<uint32_t>(~((uint64_t{2} << position) - 1));
+                rows[position] = (1u << position) | (bits[q] & above);
+            }
+        }
+
+        SobolSequence::Directions out{};
+        for (int k = 0; k < SobolSequence::BITS; ++k) {
+            uint32_t x = 0;
+            for (uint32_t position = 0; position < SobolSequence::BITS; ++position) {
+                x |= static_cast<uint32_t>(__builtin_parity(rows[position] & v[k])) << position;
+            }
+            out[k] = x;
+        }
+        return out;
+    }
+
+    struct Scratch {
+        std::vector<uint32_t> points;
+        std::vector<double> normals;
+        std::vector<double> brownian;
+        std::vector<double> path;
+    };
+    thread_local Scratch scratch;
+}
+
+const SobolSequence::Directions& SobolSequence::directions(int dimension) {
+    static const auto table = buildDirections();
+    if (dimension < 0 || dimension >= MAX_DIMENSIONS) {
+        throw std::out_of_range("Sobol dimension out of range");
+    }
+    return table[dimension];
+}
+
+BrownianBridge::BrownianBridge(int steps, double expiry)
+    : steps(steps), bridgeIndex(std::max(steps, 0)), leftIndex(std::max(steps, 0)), rightIndex(std::max(steps, 0)),
+      leftWeight(std::max(steps, 0)), rightWeight(std::max(steps, 0)), stdDev(std::max(steps, 0)) {
+    if (steps <= 0 || !(expiry > 0)) {
+        throw std::invalid_argument("Brownian bridge needs positive steps and expiry");
+    }
+
+    std::vector<double> times(steps);
+    for (int i = 0; i < steps; ++i) {
+        times[i] = expiry * (i + 1) / steps;
+    }
+
+    // Terminal point first, then the midpoint of each unfilled gap in turn (Jaeckel's ordering)
+    std::vector<bool> filled(steps, false);
+    filled[steps - 1] = true;
+    bridgeIndex[0] = steps - 1;
+    stdDev[0] = sqrt(times[steps - 1]);
+
+    int j = 0;
+    for (int i = 1; i < steps; ++i) {
+        while (filled[j]) {
+            ++j;
+        }
+        int k = j;
+        while (!filled[k]) {
+            ++k;
+        }
+        const int l = j + ((k - 1 - j) >> 1);
+        filled[l] = true;
+
+        const double tLeft = j > 0 ? times[j - 1] : 0.0;
+        const double tMid = times[l];
+        const double tRight = times[k];
+        bridgeIndex[i] = l;
+        leftIndex[i] = j;
+        rightIndex[i] = k;
+        leftWeight[i] = (tRight - tMid) / (tRight - tLeft);
+        rightWeight[i] = (tMid - tLeft) / (tRight - tLeft);
+        stdDev[i] = sqrt((tMid - tLeft) * (tRight - tMid) / (tRight - tLeft));
+
+        j = k + 1;
+        if (j >= steps) {
+            j = 0;
+        }
+    }
+}
+
+void BrownianBridge::build(const double* normals, double* path) const {
+    path[steps - 1] = stdDev[0] * normals[0];
+    for (int i = 1; i < steps; ++i) {
+        const int j = leftIndex[i];
+        const double left = j > 0 ? path[j - 1] : 0.0;
+        path[bridgeIndex[i]] = leftWeight[i] * left + rightWeight[i] * path[rightIndex[i]] + stdDev[i] * normals[i];
+    }
+}
+
+double inverseNormalCDF(double p) {
+    if (!(p > 0.0 && p < 1.0)) {
+        throw std::invalid_argument("Probability must lie in (0, 1)");
+    }
+
+    const double q = p - 0.5;
+    if (std::abs(q) <= 0.425) {
+        const double r = 0.180625 - q * q;
+        return q * (((((((2.5090809287301226727e+3 * r + 3.3430575583588128105e+4) * r + 6.7265770927008700853e+4) * r
+                     + 4.5921953931549871457e+4) * r + 1.3731693765509461125e+4) * r + 1.9715909503065514427e+3) * r
+                     + 1.3314166789178437745e+2) * r + 3.3871328727963666080e0)
+                 / (((((((5.2264952788528545610e+3 * r + 2.8729085735721942674e+4) * r + 3.9307895800092710610e+4) * r
+                     + 2.1213794301586595867e+4) * r + 5.3941960214247511077e+3) * r + 6.8718700749205790830e+2) * r
+                     + 4.2313330701600911252e+1) * r + 1.0);
+    }
+
+    double r = sqrt(-log(q < 0 ? p : 1.0 - p));
+    double value;
+    if (r <= 5.0) {
+        r -= 1.6;
+        value = (((((((7.74545014278341407640e-4 * r + 2.27238449892691845833e-2) * r + 2.41780725177450611770e-1) * r
+                  + 1.27045825245236838258e0) * r + 3.64784832476320460504e0) * r + 5.76949722146069140550e0) * r
+                  + 4.63033784615654529590e0) * r + 1.42343711074968357734e0)
+              / (((((((1.05075007164441684324e-9 * r + 5.47593808499534494600e-4) * r + 1.51986665636164571966e-2) * r
+                  + 1.48103976427480074590e-1) * r + 6.89767334985100004550e-1) * r + 1.67638483018380384940e0) * r
+                  + 2.05319162663775882187e0) * r + 1.0);
+    } else {
+        r -= 5.0;
+        value = (((((((2.01033439929228813265e-7 * r + 2.71155556874348757815e-5) * r + 1.24266094738807843860e-3) * r
+                  + 2.65321895265761230930e-2) * r + 2.96560571828504891230e-1) * r + 1.78482653991729133580e0) * r
+                  + 5.46378491116411436990e0) * r + 6.65790464350110377720e0)
+              / (((((((2.04426310338993978564e-15 * r + 1.42151175831644588870e-7) * r + 1.84631831751005468180e-5) * r
+                  + 7.86869131145613259100e-4) * r + 1.48753612908506148525e-2) * r + 1.36929880922735805310e-1) * r
+                  + 5.99832206555887937690e-1) * r + 1.0);
+    }
+    return q < 0 ? -value : value;
+}
+
+QuasiMonteCarloPricer::QuasiMonteCarloPricer(const QuasiMonteCarloSettings& settings, WorkStealingPool* pool,
+                                             std::shared_ptr<const PathPayoff> payoff)
+    : settings(settings), pool(pool), payoff(std::move(payoff)) {
+    if (settings.paths == 0 || settings.steps <= 0 || settings.replicates < 2) {
+        throw std::invalid_argument("Quasi-Monte Carlo needs paths, steps and at least two replicates");
+    }
+
+    // Sobol nets are balanced at powers of two
+    const size_t perReplicate = (settings.paths + settings.replicates - 1) / settings.replicates;
+    pointsPerReplicate = 1;
+    while (pointsPerReplicate < perReplicate) {
+        pointsPerReplicate <<= 1;
+    }
+
+    const int sobolDimensions = std::min(settings.steps, SobolSequence::MAX_DIMENSIONS);
+    const Philox4x32::Key key{static_cast<uint32_t>(settings.seed), static_cast<uint32_t>(settings.seed >> 32)};
+    for (int r = 0; r < settings.replicates; ++r) {
+        for (int d = 0; d < sobolDimensions; ++d) {
+            scrambled.push_back(scramble(SobolSequence::directions(d), key, r, d));
+            shifts.push_back(Philox4x32::generate({static_cast<uint32_t>(r), static_cast<uint32_t>(d), 0, 2}, key)[0]);
+        }
+    }
+}
+
+double QuasiMonteCarloPricer::calculatePrice(const Option& option, const MarketData& marketData) {
+    return estimate(option, marketData).price;
+}
+
+QuasiMonteCarloPricer::Estimate QuasiMonteCarloPricer::estimate(const Option& option, const MarketData& marketData) {
+    OPTIONS_TIME_SCOPE(QUASI_MONTE_CARLO);
+    if (option.getStyle() != Option::Style::EUROPEAN) {
+        throw std::invalid_argument("Quasi-Monte Carlo pricer only handles European exercise");
+    }
+    // As MonteCarloPricer: vanilla contracts on the prepaid forward, path payoffs only on flat data
+    if (payoff && !marketData.isFlat()) {
+        throw std::invalid_argument("Quasi-Monte Carlo path payoffs need flat market data, without dividends or a yield curve");
+    }
+    const double T = option.getExpiry();
+    const double S = marketData.getPrepaidForward(T);
+    const double K = option.getStrike();
+    const double r = marketData.getRiskFreeRate(T);
+    const double sigma = marketData.getVolatility(option);
+    if (S <= 0 || K <= 0 || T <= 0 || sigma <= 0) {
+        throw std::invalid_argument("Invalid parameters: All values must be positive");
+    }
+
+    const int steps = settings.steps;
+    const int sobolDimensions = std::min(steps, SobolSequence::MAX_DIMENSIONS);
+    const bool isCall = option.getType() == Option::Type::CALL;
+    const double dt = T / steps;
+    const double drift = r - 0.5 * sigma * sigma;
+    const double discount = exp(-r * T);
+    const BrownianBridge bridge(steps, T);
+    const Philox4x32::Key key{static_cast<uint32_t>(settings.seed), static_cast<uint32_t>(settings.seed >> 32)};
+
+    const size_t blocksPerReplicate = (pointsPerReplicate + BLOCK - 1) / BLOCK;
+    const size_t tasks = blocksPerReplicate * settings.replicates;
+    OPTIONS_COUNT(RNG_DRAWS, static_cast<uint64_t>(pointsPerReplicate) * settings.replicates * steps);
+    std::vector<double> sums(tasks);
+
+    auto simulate = [&](size_t task) {
+        const uint32_t replicate = static_cast<uint32_t>(task / blocksPerReplicate);
+        const uint64_t begin = (task % blocksPerReplicate) * BLOCK;
+        const uint64_t end = std::min<uint64_t>(pointsPerReplicate, begin + BLOCK);
+        const SobolSequence::Directions* v = scrambled.data() + replicate * sobolDimensions;
+        const uint32_t* shift = shifts.data() + replicate * sobolDimensions;
+
+        scratch.points.resize(sobolDimensions);
+        scratch.normals.resize(steps);
+        scratch.brownian.resize(steps);
+        scratch.path.resize(steps + 1);
+        uint32_t* points = scratch.points.data();
+        double* normals = scratch.normals.data();
+        double* brownian = scratch.brownian.data();
+        double* path = scratch.path.data();
+
+        for (int d = 0; d < sobolDimensions; ++d) {
+            points[d] = SobolSequence::point(v[d], begin) ^ shift[d];
+        }
+
+        double sum = 0.0;
+        for (uint64_t n = begin; n < end; ++n) {
+            for (int d = 0; d < sobolDimensions; ++d) {
+                normals[d] = inverseNormalCDF((points[d] + 0.5) * (1.0 / 4294967296.0));
+            }
+            // Dimensions past the Sobol table take pseudo-random draws, two per generator call
+            for (int d = sobolDimensions; d < steps; d += 2) {
+                const Philox4x32::Counter bits = Philox4x32::generate(
+                    {static_cast<uint32_t>(d), static_cast<uint32_t>(n), static_cast<uint32_t>(n >> 32), replicate}, key);
+                normals[d] = inverseNormalCDF(Philox4x32::toUniform(bits[0], bits[1]) * (1.0 - 0x1p-54));
+                if (d + 1 < steps) {
+                    normals[d + 1] = inverseNormalCDF(Philox4x32::toUniform(bits[2], bits[3]) * (1.0 - 0x1p-54));
+                }
+            }
+
+            if (settings.brownianBridge) {
+                bridge.build(normals, brownian);
+            } else {
+                double w = 0.0;
+                for (int k = 0; k < steps; ++k) {
+                    w += sqrt(dt) * normals[k];
+                    brownian[k] = w;
+                }
+            }
+
+            double value;
+            if (payoff) {
+                path[0] = S;
+                for (int k = 0; k < steps; ++k) {
+                    path[k + 1] = S * exp(drift * dt * (k + 1) + sigma * brownian[k]);
+                }
+                value = payoff->evaluate(option, path, steps);
+            } else {
+                const double terminal = S * exp(drift * T + sigma * brownian[steps - 1]);
+                value = isCall ? std::max(terminal - K, 0.0) : std::max(K - terminal, 0.0);
+            }
+            sum += value;
+
+            if (n + 1 < end) {
+                for (int d = 0; d < sobolDimensions; ++d) {
+                    points[d] = SobolSequence::next(v[d], points[d], n);
+                }
+            }
+        }
+        sums[task] = sum;
+    };
+
+    if (pool) {
+        pool->parallelFor(tasks, simulate);
+    } else {
+        for (size_t t = 0; t < tasks; ++t) {
+            simulate(t);
+        }
+    }
+
+    // Replicate means in a fixed order, their spread is the error estimate
+    double mean = 0.0, m2 = 0.0;
+    for (int rep = 0; rep < settings.replicates; ++rep) {
+        double sum = 0.0;
+        for (size_t b = 0; b < blocksPerReplicate; ++b) {
+            sum += sums[rep * blocksPerReplicate + b];
+        }
+        const double replicateMean = discount * sum / static_cast<double>(pointsPerReplicate);
+        const double delta = replicateMean - mean;
+        mean += delta / (rep + 1);
+        m2 += delta * (replicateMean - mean);
+    }
+
+    const double replicates = settings.replicates;
+    return Estimate{mean, sqrt(m2 / (replicates - 1) / replicates), pointsPerReplicate * settings.replicates};
+}
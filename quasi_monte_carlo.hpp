@@ -0,0 +1,104 @@
+#pragma once
+
+#include "options_classes.hpp"
+#include "monte_carlo.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Sobol low-discrepancy sequence, 32-bit digits
+// Dimensions 1-21 use the Joe-Kuo (new-joe-kuo-6.21201) primitive polynomials and initial
+// direction numbers, embedded below at compile time
+class SobolSequence {
+    public:
+        static constexpr int MAX_DIMENSIONS = 21;
+        static constexpr int BITS = 32;
+        using Directions = std::array<uint32_t, BITS>;
+
+        // Direction numbers v_1..v_32 of a dimension (0-based), v_k scaled by 2^32
+        static const Directions& directions(int dimension);
+
+        // Point n of one dimension from (possibly scrambled) direction numbers, via its Gray code
+        static uint32_t point(const Directions& v, uint64_t n) {
+            const uint64_t gray = n ^ (n >> 1);
+            uint32_t x = 0;
+            for (int k = 0; k < BITS && (gray >> k) != 0; ++k) {
+                if ((gray >> k) & 1) {
+                    x ^= v[k];
+                }
+            }
+            return x;
+        }
+
+        // Point n + 1 from point n, one XOR per dimension
+        static uint32_t next(const Directions& v, uint32_t x, uint64_t n) {
+            return x ^ v[__builtin_ctzll(n + 1)];
+        }
+};
+
+// Brownian bridge on a uniform grid of N steps over [0, T]
+// The first normal fixes W(T), each later one fills the midpoint of the widest remaining gap,
+// so the leading (best distributed) Sobol dimensions carry most of the path's variance
+class BrownianBridge {
+    public:
+        BrownianBridge(int steps, double expiry);
+
+        // Writes W(t_1)..W(t_N) from N standard normals
+        void build(const double* normals, double* path) const;
+
+        int getSteps() const { return steps; }
+
+    private:
+        int steps;
+        std::vector<int> bridgeIndex, leftIndex, rightIndex;
+        std::vector<double> leftWeight, rightWeight, stdDev;
+};
+
+struct QuasiMonteCarloSettings {
+    size_t paths = 16384;         // total, split over the replicates and rounded up to a power of two each
+    int steps = 1;
+    int replicates = 16;          // independent scramblings, their spread gives the standard error
+    uint64_t seed = 42;
+    bool brownianBridge = true;   // false builds the path increment by increment
+};
+
+// Randomized quasi-Monte Carlo pricer for European-exercise payoffs
+//
+// Each replicate applies a random linear matrix scramble and digital shift (Matousek) to the
+// Sobol direction numbers, which keeps the net structure while making every replicate an
+// unbiased estimate. The price is the mean over replicates and the standard error their
+// spread, so results go to StatisticalAnalyzer::analyzeEstimate like MonteCarloPricer's.
+// Paths with more than MAX_DIMENSIONS steps take Philox draws for the remaining bridge
+// dimensions, which only carry the fine detail of the path.
+// Replicates run in fixed blocks on the pool and are summed in block order, so results are
+// bit-identical for any thread count
+class QuasiMonteCarloPricer : public PricingStrategy {
+    public:
+        using Estimate = MonteCarloPricer::Estimate;
+
+        explicit QuasiMonteCarloPricer(const QuasiMonteCarloSettings& settings = QuasiMonteCarloSettings(),
+                                       WorkStealingPool* pool = nullptr,
+                                       std::shared_ptr<const PathPayoff> payoff = nullptr);
+
+        double calculatePrice(const Option& option, const MarketData& marketData) override;
+        Estimate estimate(const Option& option, const MarketData& marketData);
+
+        std::string getStrategyName() const override {
+            return payoff ? "Quasi-Monte Carlo (" + payoff->getName() + ")" : "Quasi-Monte Carlo";
+        }
+
+    private:
+        QuasiMonteCarloSettings settings;
+        WorkStealingPool* pool;
+        std::shared_ptr<const PathPayoff> payoff;
+        size_t pointsPerReplicate;
+        // Scrambled direction numbers and shifts, replicate-major
+        std::vector<SobolSequence::Directions> scrambled;
+        std::vector<uint32_t> shifts;
+};
+
+// Inverse of the standard normal CDF, Wichura's AS241 (PPND16), about 1e-16 relative
+double inverseNormalCDF(double p);
@@ -0,0 +1,205 @@
+#include "repricing_engine.hpp"
+#include "term_structure.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+RepricingEngine::RepricingEngine(std::unique_ptr<PricingStrategy> strategy,
+                                 std::vector<std::unique_ptr<PricingStrategy>> decisionStrategies,
+                                 const RepricingSettings& settings)
+    : strategy(std::move(strategy)), decisionStrategies(std::move(decisionStrategies)), settings(settings),
+      inbox(settings.inboxCapacity) {
+    if (!this->strategy) {
+        throw std::invalid_argument("Repricing engine needs a pricing strategy");
+    }
+    if (!this->decisionStrategies.empty() && this->decisionStrategies.size() < 2) {
+        throw std::invalid_argument("Need at least two pricing strategies for comparison");
+    }
+    if (settings.spotTolerance < 0 || settings.volTolerance < 0 || settings.rateTolerance < 0) {
+        throw std::invalid_argument("Repricing tolerances must be non-negative");
+    }
+    // Rejects a bad subscriber capacity here rather than on the first subscribe
+    LockFree::roundCapacity(settings.queueCapacity);
+}
+
+RepricingEngine::~RepricingEngine() {
+    running = false;
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+size_t RepricingEngine::addUnderlying(const MarketData& marketData) {
+    Underlying underlying;
+    underlying.latest = Update{underlyings.size(), marketData.getSpot(), marketData.getRiskFreeRate(),
+                               marketData.getVolatility(), marketData.getSurface(), marketData.getCarry(), 0,
+                               std::chrono::steady_clock::now()};
+    underlyings.push_back(std::move(underlying));
+    return underlyings.size() - 1;
+}
+
+size_t RepricingEngine::addContract(size_t underlying, const Option& option) {
+    if (underlying >= underlyings.size()) {
+        throw std::invalid_argument("Unknown underlying");
+    }
+    if (option.getStrike() <= 0 || option.getExpiry() <= 0) {
+        throw std::invalid_argument("Invalid parameters: All values must be positive");
+    }
+
+    const size_t contract = book.strike.size();
+    book.strike.push_back(option.getStrike());
+    book.expiry.push_back(option.getExpiry());
+    book.type.push_back(option.getType());
+    book.style.push_back(option.getStyle());
+    // Never priced, NaN inputs fail every tolerance check
+    book.spot.push_back(NAN);
+    book.rate.push_back(NAN);
+    book.volatility.push_back(NAN);
+    book.carry.push_back(0);
+    book.price.push_back(NAN);
+    underlyings[underlying].contracts.push_back(contract);
+    return contract;
+}
+
+RepricingEngine::Subscription RepricingEngine::subscribe() {
+    subscribers.push_back(std::make_shared<SpscQueue<PriceEvent>>(settings.queueCapacity));
+    return subscribers.back();
+}
+
+bool RepricingEngine::post(size_t underlying, const MarketData& marketData) {
+    if (underlying >= underlyings.size()) {
+        throw std::invalid_argument("Unknown underlying");
+    }
+    if (!(marketData.getSpot() > 0) || !(marketData.getVolatility() > 0) || !std::isfinite(marketData.getRiskFreeRate())) {
+        throw std::invalid_argument("Invalid parameters: All values must be positive");
+    }
+    return inbox.push(Update{underlying, marketData.getSpot(), marketData.getRiskFreeRate(), marketData.getVolatility(),
+                             marketData.getSurface(), marketData.getCarry(), sequence.fetch_add(1, std::memory_order_relaxed),
+                             std::chrono::steady_clock::now()});
+}
+
+size_t RepricingEngine::poll() {
+    // Conflate first, so a burst on one underlying costs one repricing
+    size_t drained = 0;
+    Update update;
+    touched.clear();
+    while (inbox.pop(update)) {
+        ++drained;
+        Underlying& underlying = underlyings[update.underlying];
+        if (underlying.pending) {
+            conflated.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            underlying.pending = true;
+            touched.push_back(update.underlying);
+        }
+        underlying.latest = update;
+    }
+    updates.fetch_add(drained, std::memory_order_relaxed);
+
+    for (const size_t id : touched) {
+        underlyings[id].pending = false;
+        reprice(underlyings[id].latest);
+    }
+    return drained;
+}
+
+void RepricingEngine::reprice(const Update& update) {
+    MarketData marketData = update.surface ? MarketData(update.spot, update.rate, update.surface)
+                                           : MarketData(update.spot, update.rate, update.volatility);
+    if (update.carry) {
+        marketData = marketData.withCarry(update.carry);
+    }
+
+    // Any change of Carry reprices, its curve and dividends have no tolerance
+    const uint64_t carry = update.carry ? update.carry->id() : 0;
+
+    rows.clear();
+    chain.clear();
+    for (const size_t c : underlyings[update.underlying].contracts) {
+        // Each contract's own vol, which differs across the book under a surface
+        const double volatility = marketData.getVolatility(book.strike[c], book.expiry[c]);
+        if (std::abs(update.spot - book.spot[c]) <= settings.spotTolerance * book.spot[c] &&
+            std::abs(volatility - book.volatility[c]) <= settings.volTolerance &&
+            std::abs(update.rate - book.rate[c]) <= settings.rateTolerance &&
+            carry == book.carry[c]) {
+            continue;
+        }
+        rows.push_back(c);
+        chain.add(Option(book.type[c], book.style[c], book.strike[c], book.expiry[c]), marketData);
+    }
+    const size_t count = rows.size();
+    skipped.fetch_add(underlyings[update.underlying].contracts.size() - count, std::memory_order_relaxed);
+    if (count == 0) {
+        return;
+    }
+
+    const OptionBatch batch = chain.batch();
+    prices.resize(count);
+    strategy->calculatePrices(batch, prices.data(), count);
+    repriced.fetch_add(count, std::memory_order_relaxed);
+
+    for (size_t k = 0; k < count; ++k) {
+        const size_t c = rows[k];
+        book.price[c] = prices[k];
+        book.spot[c] = update.spot;
+        book.rate[c] = update.rate;
+        book.volatility[c] = batch.volatility[k];
+        book.carry[c] = carry;
+
+        PriceEvent event{update.sequence, c, prices[k], TradingDecision::Action::HOLD, false, update.posted};
+        if (!decisionStrategies.empty()) {
+            try {
+                event.action = trader.makeDecision(Option(book.type[c], book.style[c], book.strike[c], book.expiry[c]),
+                                                   decisionStrategies, marketData, analyzer);
+                event.decided = true;
+            } catch (const std::exception&) {
+                // e.g. a Black-Scholes leg on an American contract, the price still goes out
+            }
+        }
+        publish(event);
+    }
+}
+
+void RepricingEngine::publish(const PriceEvent& event) {
+    for (const Subscription& subscriber : subscribers) {
+        if (subscriber->push(event)) {
+            published.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void RepricingEngine::start() {
+    if (running.exchange(true)) {
+        throw std::logic_error("Repricing engine is already running");
+    }
+    error = nullptr;
+    worker = std::thread([this] {
+        try {
+            while (running.load(std::memory_order_relaxed)) {
+                if (poll() == 0) {
+                    std::this_thread::yield();
+                }
+            }
+            poll();
+        } catch (...) {
+            error = std::current_exception();
+            running = false;
+        }
+    });
+}
+
+void RepricingEngine::stop() {
+    running = false;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    if (error) {
+        std::rethrow_exception(std::exchange(error, nullptr));
+    }
+}
+
+RepricingEngine::Stats RepricingEngine::stats() const {
+    return Stats{updates.load(), conflated.load(), repriced.load(), skipped.load(), published.load(), dropped.load()};
+}
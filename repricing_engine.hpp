@@ -0,0 +1,136 @@
+#pragma once
+
+#include "options_classes.hpp"
+#include "lockfree_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+struct RepricingSettings {
+    // Input moves a contract may accumulate since it was last priced before it is repriced,
+    // 0 reprices on any change
+    double spotTolerance = 0.0;     // relative
+    double volTolerance = 0.0;      // absolute
+    double rateTolerance = 0.0;     // absolute
+    size_t inboxCapacity = 65536;   // market updates waiting for the engine
+    size_t queueCapacity = 65536;   // price events per subscriber
+};
+
+// One repriced contract, as delivered to subscribers
+struct PriceEvent {
+    uint64_t update;                // sequence number of the market update behind it
+    size_t contract;
+    double price;
+    TradingDecision::Action action;
+    bool decided;                   // false without decision strategies or when they reject the contract
+    std::chrono::steady_clock::time_point posted;  // when the update was posted, for tick-to-decision latency
+};
+
+// Event-driven repricing of a resident book
+//
+// Contracts are grouped by underlying, and each underlying has one MarketData, flat or with a
+// VolSurface. Feed threads post updates into a lock-free MPSC inbox. The engine thread drains
+// it and conflates the updates to the latest per underlying. It reprices only that underlying's
+// contracts whose inputs moved past the tolerances since they were last priced, in one batch
+// call. Prices and TradingDecision actions go to every subscriber's SPSC queue. A full
+// subscriber queue drops the event and counts it rather than stalling the book.
+// Book setup (addUnderlying, addContract, subscribe) must happen before start or between polls
+class RepricingEngine {
+    public:
+        using Subscription = std::shared_ptr<SpscQueue<PriceEvent>>;
+
+        struct Stats {
+            uint64_t updates;     // market updates drained
+            uint64_t conflated;   // updates superseded by a later one for the same underlying
+            uint64_t repriced;    // contract prices computed
+            uint64_t skipped;     // contracts left alone, inputs within tolerance
+            uint64_t published;   // events delivered
+            uint64_t dropped;     // events lost to full subscriber queues
+        };
+
+        // decisionStrategies, when given, are the pair TradingDecision compares for every repriced contract
+        explicit RepricingEngine(std::unique_ptr<PricingStrategy> strategy,
+                                 std::vector<std::unique_ptr<PricingStrategy>> decisionStrategies = {},
+                                 const RepricingSettings& settings = RepricingSettings());
+        ~RepricingEngine();
+
+        RepricingEngine(const RepricingEngine&) = delete;
+        RepricingEngine& operator=(const RepricingEngine&) = delete;
+
+        size_t addUnderlying(const MarketData& marketData);
+        // Priced on the next update of its underlying
+        size_t addContract(size_t underlying, const Option& option);
+        Subscription subscribe();
+
+        // Feed side, any thread. False when the inbox is full
+        bool post(size_t underlying, const MarketData& marketData);
+
+        // Engine side, one thread at a time: drains the inbox, reprices and publishes
+        // Returns the number of updates drained
+        size_t poll();
+
+        // Polls on a dedicated thread, stop() rethrows the first pricing error it hit
+        void start();
+        void stop();
+
+        Stats stats() const;
+        double price(size_t contract) const { return book.price[contract]; }
+        size_t contractCount() const { return book.strike.size(); }
+
+    private:
+        struct Update {
+            size_t underlying;
+            double spot, rate, volatility;
+            std::shared_ptr<const VolSurface> surface;   // null for a flat vol
+            std::shared_ptr<const Carry> carry;          // null for a flat rate without dividends
+            uint64_t sequence;
+            std::chrono::steady_clock::time_point posted;
+        };
+
+        struct Underlying {
+            std::vector<size_t> contracts;
+            Update latest;
+            bool pending = false;   // latest holds an update not yet repriced
+        };
+
+        // Per contract, SoA, with the inputs of its last pricing
+        struct Book {
+            std::vector<double> strike, expiry;
+            std::vector<Option::Type> type;
+            std::vector<Option::Style> style;
+            std::vector<double> spot, rate, volatility;
+            std::vector<uint64_t> carry;   // Carry::id() priced under, 0 without one
+            std::vector<double> price;
+        };
+
+        void reprice(const Update& update);
+        void publish(const PriceEvent& event);
+
+        std::unique_ptr<PricingStrategy> strategy;
+        std::vector<std::unique_ptr<PricingStrategy>> decisionStrategies;
+        RepricingSettings settings;
+        StatisticalAnalyzer analyzer;
+        TradingDecision trader;
+
+        std::vector<Underlying> underlyings;
+        Book book;
+        std::vector<Subscription> subscribers;
+        MpscQueue<Update> inbox;
+        std::atomic<uint64_t> sequence{0};
+
+        // Engine-thread scratch, reused across updates
+        std::vector<size_t> touched;
+        std::vector<size_t> rows;
+        OptionChain chain;
+        std::vector<double> prices;
+
+        std::atomic<uint64_t> updates{0}, conflated{0}, repriced{0}, skipped{0}, published{0}, dropped{0};
+        std::atomic<bool> running{false};
+        std::thread worker;
+        std::exception_ptr error;
+};
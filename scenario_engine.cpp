@@ -0,0 +1,357 @@
+#include "scenario_engine.hpp"
+#include "instrumentation.hpp"
+#include "lattice_engine.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    const double MIN_VOL = 1e-4;          // shifted vols are floored here rather than rejected
+    const double RATE_BUMP = 1e-4;        // lattice rho, as BinomialPricer
+    const double VOL_BUMP = 1e-2;         // lattice vega, as BinomialPricer
+    const double MIN_EXPIRY = 1e-12;      // at or below this a contract is settled at intrinsic
+    const size_t SPOTS_PER_TASK = 16;     // spot shifts per task, each task prices its own discount factors
+
+    // Spot tables of the shared geometries, kept apart from threadArena() which each position resets
+    Lattice::Arena& spotArena() {
+        thread_local Lattice::Arena arena;
+        return arena;
+    }
+
+    void accumulate(ScenarioResult& result, double quantity, double price, const Greeks& greeks) {
+        result.value += quantity * price;
+        result.greeks.delta += quantity * greeks.delta;
+        result.greeks.gamma += quantity * greeks.gamma;
+        result.greeks.theta += quantity * greeks.theta;
+        result.greeks.vega += quantity * greeks.vega;
+        result.greeks.rho += quantity * greeks.rho;
+    }
+
+    // Black-Scholes price and Greeks with everything independent of the spot hoisted by the caller,
+    // the same formulas as BlackScholesPricer
+    template <Option::Type TYPE>
+    PriceWithGreeks blackScholes(double S, double logS, double logK, double carryTerm, double sigma, double sigmaSqrtT,
+                                 double sqrtT, double r, double T, double discountedK, bool greeks) {
+        constexpr double sgn = Payoff::Vanilla<TYPE>::SIGN;
+        const double d1 = (logS - logK + carryTerm) / sigmaSqrtT;
+        const double d2 = d1 - sigmaSqrtT;
+        const double nd1 = Utils::normalCDF(sgn * d1);
+        const double kd2 = discountedK * Utils::normalCDF(sgn * d2);
+
+        PriceWithGreeks result{sgn * (S * nd1 - kd2), Greeks{0, 0, 0, 0, 0}};
+        if (greeks) {
+            const double pdf = Utils::normalPDF(d1);
+            result.greeks.delta = sgn * nd1;
+            result.greeks.gamma = pdf / (S * sigmaSqrtT);
+            result.greeks.theta = -S * pdf * sigma / (2 * sqrtT) - sgn * r * kd2;
+            result.greeks.vega = S * pdf * sqrtT;
+            result.greeks.rho = sgn * T * kd2;
+        }
+        return result;
+    }
+
+    void validate(const ScenarioGrid& grid) {
+        if (grid.spotShifts.empty() || grid.volShifts.empty() || grid.rateShifts.empty() || grid.timeShifts.empty()) {
+            throw std::invalid_argument("Scenario grid needs at least one value per axis");
+        }
+        for (double shift : grid.spotShifts) {
+            if (!(shift > -1.0)) {
+                throw std::invalid_argument("Spot shifts must be greater than -1");
+            }
+        }
+        for (double shift : grid.timeShifts) {
+            if (!(shift >= 0.0)) {
+                throw std::invalid_argument("Time shifts must be non-negative");
+            }
+        }
+    }
+}
+
+ScenarioGrid::Scenario ScenarioGrid::scenario(size_t index) const {
+    if (index >= size()) {
+        throw std::out_of_range("Scenario index out of range");
+    }
+    const size_t spot = index % spotShifts.size();
+    index /= spotShifts.size();
+    const size_t vol = index % volShifts.size();
+    index /= volShifts.size();
+    const size_t rate = index % rateShifts.size();
+    const size_t time = index / rateShifts.size();
+    return Scenario{spotShifts[spot], volShifts[vol], rateShifts[rate], timeShifts[time]};
+}
+
+std::vector<double> ScenarioGrid::range(double first, double last, size_t points) {
+    if (points == 0) {
+        throw std::invalid_argument("Range needs at least one point");
+    }
+    std::vector<double> values(points, first);
+    for (size_t i = 1; i < points; ++i) {
+        values[i] = first + (last - first) * i / (points - 1);
+    }
+    return values;
+}
+
+ScenarioEngine::ScenarioEngine(WorkStealingPool* pool, const ScenarioSettings& settings)
+    : pool(pool), settings(settings) {
+    // Level Greeks read the first two levels of the tree
+    if (settings.steps < 4) {
+        throw std::invalid_argument("Scenario lattices need at least 4 steps");
+    }
+}
+
+size_t ScenarioEngine::addUnderlying(const MarketData& marketData) {
+    if (marketData.getCarry()) {
+        throw std::invalid_argument("Scenario engine shifts a flat rate, market data with a carry is not supported");
+    }
+    if (marketData.getSpot() <= 0) {
+        throw std::invalid_argument("Invalid parameters: All values must be positive");
+    }
+    underlyings.push_back(marketData);
+    return underlyings.size() - 1;
+}
+
+size_t ScenarioEngine::addPosition(size_t underlying, const Option& option, double quantity) {
+    if (underlying >= underlyings.size()) {
+        throw std::invalid_argument("Unknown underlying");
+    }
+    const double volatility = underlyings[underlying].getVolatility(option);
+    if (option.getStrike() <= 0 || option.getExpiry() <= 0 || volatility <= 0) {
+        throw std::invalid_argument("Invalid parameters: All values must be positive");
+    }
+    if (!std::isfinite(quantity)) {
+        throw std::invalid_argument("Position quantity must be finite");
+    }
+
+    positions.push_back(Position{underlying, option.getStrike(), log(option.getStrike()), option.getExpiry(),
+                                 volatility, quantity, option.getType(), option.getStyle()});
+    return positions.size() - 1;
+}
+
+// Groups keep the order positions were added in, so every scenario sums in the same order
+std::vector<ScenarioEngine::ExpiryGroup> ScenarioEngine::groups() const {
+    std::vector<ExpiryGroup> result;
+    for (size_t p = 0; p < positions.size(); ++p) {
+        const Position& position = positions[p];
+        auto group = std::find_if(result.begin(), result.end(), [&](const ExpiryGroup& g) {
+            return g.underlying == position.underlying && g.expiry == position.expiry;
+        });
+        if (group == result.end()) {
+            result.push_back(ExpiryGroup{position.underlying, position.expiry, {}, {}});
+            group = result.end() - 1;
+        }
+
+        if (position.style == Option::Style::EUROPEAN) {
+            group->europeans.push_back(p);
+            continue;
+        }
+        auto lattice = std::find_if(group->americans.begin(), group->americans.end(), [&](const LatticeGroup& l) {
+            return l.volatility == position.volatility;
+        });
+        if (lattice == group->americans.end()) {
+            group->americans.push_back(LatticeGroup{position.volatility, {}});
+            lattice = group->americans.end() - 1;
+        }
+        lattice->positions.push_back(p);
+    }
+    return result;
+}
+
+void ScenarioEngine::europeans(const ExpiryGroup& group, const double* spots, size_t spotCount, double volShift,
+                               double r, double T, ScenarioResult* results) const {
+    thread_local std::vector<double> logSpots;
+    logSpots.resize(spotCount);
+    for (size_t s = 0; s < spotCount; ++s) {
+        logSpots[s] = log(spots[s]);
+    }
+    const double sqrtT = sqrt(T);
+    const double discount = exp(-r*T);
+
+    for (size_t p : group.europeans) {
+        const Position& position = positions[p];
+        const double sigma = std::max(position.volatility + volShift, MIN_VOL);
+        const double sigmaSqrtT = sigma * sqrtT;
+        const double carryTerm = (r + sigma*sigma/2) * T;
+        const double discountedK = position.strike * discount;
+
+        Payoff::dispatch(position.type, [&](auto type) {
+            for (size_t s = 0; s < spotCount; ++s) {
+                const PriceWithGreeks priced = blackScholes<decltype(type)::value>(
+                    spots[s], logSpots[s], position.logStrike, carryTerm, sigma, sigmaSqrtT, sqrtT, r, T,
+                    discountedK, settings.greeks);
+                accumulate(results[s], position.quantity, priced.price, priced.greeks);
+            }
+        });
+    }
+}
+
+// One geometry per lane for the whole group, spot tables per spot shift shared by every strike,
+// then per position the sweeps of binomialGreeks: base and rate-bumped lanes together, then both
+// vol bumps together
+void ScenarioEngine::americans(const LatticeGroup& group, const double* spots, size_t spotCount, double volShift,
+                               double r, double T, ScenarioResult* results) const {
+    const int N = settings.steps;
+    const double dt = T/N;
+    const double sigma = std::max(group.volatility + volShift, MIN_VOL);
+    // Keeps the lower vol bump positive for vols near the floor
+    const double volBump = std::min(VOL_BUMP, 0.5 * sigma);
+
+    const Lattice::Geometry geometry = Lattice::crrGeometry(r, sigma, T, N);
+    const Lattice::Geometry rateBumped[2] = {Lattice::crrGeometry(r + RATE_BUMP, sigma, T, N),
+                                             Lattice::crrGeometry(r - RATE_BUMP, sigma, T, N)};
+    const Lattice::Geometry volBumped[2] = {Lattice::crrGeometry(r, sigma + volBump, T, N),
+                                            Lattice::crrGeometry(r, sigma - volBump, T, N)};
+    const size_t spotTable = 2 * N + 1;
+    const size_t exerciseTable = 2 * (N + 1);
+
+    for (size_t s = 0; s < spotCount; ++s) {
+        const double S = spots[s];
+        Lattice::Arena& shared = spotArena();
+        shared.reset(3 * spotTable);
+        const double* baseSpots = Lattice::buildSpots(S, geometry, shared);
+        const double* volSpots[2] = {nullptr, nullptr};
+        if (settings.greeks) {
+            volSpots[0] = Lattice::buildSpots(S, volBumped[0], shared);
+            volSpots[1] = Lattice::buildSpots(S, volBumped[1], shared);
+        }
+
+        for (size_t p : group.positions) {
+            const Position& position = positions[p];
+            const double K = position.strike;
+            Lattice::Arena& arena = Lattice::threadArena();
+            arena.reset(3 * exerciseTable + 3 * (N + 1));
+
+            Payoff::dispatch(position.type, [&](auto type) {
+                constexpr Option::Type TYPE = decltype(type)::value;
+                const Lattice::ExerciseTable exercise = Lattice::buildExercise<TYPE>(baseSpots, N, K, arena);
+                if (!settings.greeks) {
+                    Lattice::Lane lane{geometry, exercise, arena.take(N + 1)};
+                    Lattice::sweep<Option::Style::AMERICAN>(&lane, 1);
+                    accumulate(results[s], position.quantity, lane.values[0], Greeks{0, 0, 0, 0, 0});
+                    return;
+                }
+
+                Lattice::Levels levels;
+                Lattice::Lane rateLanes[3] = {
+                    {geometry, exercise, arena.take(N + 1)},
+                    {rateBumped[0], exercise, arena.take(N + 1)},
+                    {rateBumped[1], exercise, arena.take(N + 1)}
+                };
+                Lattice::sweep<Option::Style::AMERICAN>(rateLanes, 3, &levels);
+                const double price = rateLanes[0].values[0];
+
+                Greeks greeks = Lattice::levelGreeks(levels, price, S, geometry.u, dt);
+                greeks.rho = (rateLanes[1].values[0] - rateLanes[2].values[0]) / (2 * RATE_BUMP);
+
+                Lattice::Lane volLanes[2];
+                for (int k = 0; k < 2; ++k) {
+                    volLanes[k] = Lattice::Lane{volBumped[k], Lattice::buildExercise<TYPE>(volSpots[k], N, K, arena),
+                                                rateLanes[k].values};
+                }
+                Lattice::sweep<Option::Style::AMERICAN>(volLanes, 2);
+                greeks.vega = (volLanes[0].values[0] - volLanes[1].values[0]) / (2 * volBump);
+
+                accumulate(results[s], position.quantity, price, greeks);
+            });
+        }
+    }
+}
+
+void ScenarioEngine::evaluateBlock(const std::vector<ExpiryGroup>& groups, const double* spotShifts, size_t spotCount,
+                                   double volShift, double rateShift, double timeShift, ScenarioResult* results) const {
+    OPTIONS_TIME_SCOPE(SCENARIO_BLOCK);
+    std::fill(results, results + spotCount, ScenarioResult{0.0, 0.0, Greeks{0, 0, 0, 0, 0}});
+    thread_local std::vector<double> spots;
+    spots.resize(spotCount);
+
+    for (const ExpiryGroup& group : groups) {
+        const MarketData& marketData = underlyings[group.underlying];
+        for (size_t s = 0; s < spotCount; ++s) {
+            spots[s] = marketData.getSpot() * (1.0 + spotShifts[s]);
+        }
+        const double r = marketData.getRiskFreeRate() + rateShift;
+        const double T = group.expiry - timeShift;
+
+        if (T > MIN_EXPIRY) {
+            europeans(group, spots.data(), spotCount, volShift, r, T, results);
+            for (const LatticeGroup& lattice : group.americans) {
+                americans(lattice, spots.data(), spotCount, volShift, r, T, results);
+            }
+            continue;
+        }
+
+        // Settled: intrinsic value, delta one share in the money
+        auto settle = [&](size_t p) {
+            const Position& position = positions[p];
+            Payoff::dispatch(position.type, [&](auto type) {
+                using Vanilla = Payoff::Vanilla<decltype(type)::value>;
+                for (size_t s = 0; s < spotCount; ++s) {
+                    const double intrinsic = Vanilla::intrinsic(spots[s], position.strike);
+                    const double delta = settings.greeks && intrinsic > 0 ? Vanilla::SIGN : 0.0;
+                    accumulate(results[s], position.quantity, std::max(0.0, intrinsic), Greeks{delta, 0, 0, 0, 0});
+                }
+            });
+        };
+        std::for_each(group.europeans.begin(), group.europeans.end(), settle);
+        for (const LatticeGroup& lattice : group.americans) {
+            std::for_each(lattice.positions.begin(), lattice.positions.end(), settle);
+        }
+    }
+}
+
+ScenarioResult ScenarioEngine::evaluate(const ScenarioGrid::Scenario& scenario) const {
+    ScenarioGrid grid;
+    grid.spotShifts = {scenario.spotShift};
+    grid.volShifts = {scenario.volShift};
+    grid.rateShifts = {scenario.rateShift};
+    grid.timeShifts = {scenario.timeShift};
+    ScenarioResult result;
+    run(grid, &result, 1);
+    return result;
+}
+
+void ScenarioEngine::run(const ScenarioGrid& grid, ScenarioResult* results, size_t count) const {
+    validate(grid);
+    if (count != grid.size()) {
+        throw std::invalid_argument("Need one result per scenario");
+    }
+    const std::vector<ExpiryGroup> book = groups();
+
+    // The unshifted portfolio, every P&L is taken against it
+    const double zero = 0.0;
+    ScenarioResult base;
+    evaluateBlock(book, &zero, 1, 0.0, 0.0, 0.0, &base);
+
+    // Tasks are runs of up to SPOTS_PER_TASK spot shifts of one (vol, rate, time) point,
+    // writing disjoint slices of results
+    const size_t spotCount = grid.spotShifts.size();
+    const size_t chunks = (spotCount + SPOTS_PER_TASK - 1) / SPOTS_PER_TASK;
+    const size_t points = grid.volShifts.size() * grid.rateShifts.size() * grid.timeShifts.size();
+    auto task = [&](size_t t) {
+        const size_t point = t / chunks;
+        const size_t first = (t % chunks) * SPOTS_PER_TASK;
+        const size_t n = std::min(SPOTS_PER_TASK, spotCount - first);
+        const ScenarioGrid::Scenario scenario = grid.scenario(point * spotCount);
+        ScenarioResult* out = results + point * spotCount + first;
+        evaluateBlock(book, grid.spotShifts.data() + first, n, scenario.volShift, scenario.rateShift,
+                      scenario.timeShift, out);
+        for (size_t s = 0; s < n; ++s) {
+            out[s].pnl = out[s].value - base.value;
+        }
+    };
+
+    if (pool) {
+        pool->parallelFor(points * chunks, task);
+    } else {
+        for (size_t t = 0; t < points * chunks; ++t) {
+            task(t);
+        }
+    }
+}
+
+std::vector<ScenarioResult> ScenarioEngine::run(const ScenarioGrid& grid) const {
+    validate(grid);
+    std::vector<ScenarioResult> results(grid.size());
+    run(grid, results.data(), results.size());
+    return results;
+}
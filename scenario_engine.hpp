@@ -0,0 +1,118 @@
+#pragma once
+
+#include "options_classes.hpp"
+#include <cstddef>
+#include <vector>
+
+class WorkStealingPool;
+
+// Spot x vol x rate x time stress grid. Every combination of the four axes is one scenario,
+// spot varying fastest: index = ((time * rates + rate) * vols + vol) * spots + spot
+struct ScenarioGrid {
+    std::vector<double> spotShifts{0.0};   // relative, the underlying moves to spot * (1 + shift)
+    std::vector<double> volShifts{0.0};    // absolute, added to each contract's volatility
+    std::vector<double> rateShifts{0.0};   // absolute, added to the underlying's rate
+    std::vector<double> timeShifts{0.0};   // years elapsed, every expiry shortens by it
+
+    struct Scenario {
+        double spotShift;
+        double volShift;
+        double rateShift;
+        double timeShift;
+    };
+
+    size_t size() const {
+        return spotShifts.size() * volShifts.size() * rateShifts.size() * timeShifts.size();
+    }
+
+    Scenario scenario(size_t index) const;
+
+    // points values evenly spaced from first to last, for building axes
+    static std::vector<double> range(double first, double last, size_t points);
+};
+
+struct ScenarioSettings {
+    int steps = 200;     // CRR steps for American positions, fixed so every scenario uses the same tree
+    bool greeks = true;  // false prices only, Americans then take one sweep per position instead of five
+};
+
+// One scenario of the portfolio: value, P&L against the unshifted portfolio and Greeks summed over
+// positions weighted by quantity. Delta and gamma add per-share sensitivities, so across several
+// underlyings they are a sum of exposures rather than one underlying's
+struct ScenarioResult {
+    double value;
+    double pnl;
+    Greeks greeks;
+};
+
+// Portfolio revaluation over a stress grid
+//
+// Positions are grouped by underlying and expiry once per run. A task takes a run of spot shifts
+// of one (time, rate, vol) point of the grid, so each expiry group computes its discount factor
+// and sqrt(T) once per task, and each American (sigma, T, N) shares one lattice geometry and its
+// spot tables across every strike quoted at that vol. Europeans use closed-form Black-Scholes
+// Greeks, Americans CRR trees with Greeks as BinomialPricer takes them. Results are summed per
+// scenario as positions are priced, so memory is one ScenarioResult per scenario whatever the
+// portfolio size. Tasks run on the pool when one is given and each scenario sums in a fixed order,
+// so results are bit-identical for any thread count.
+//
+// Volatilities are sticky strike: the shift applies to each contract's vol at setup, read from
+// its MarketData (flat or surface). Contracts past their expiry in a scenario are worth their
+// intrinsic value. Book setup must finish before run
+class ScenarioEngine {
+    public:
+        explicit ScenarioEngine(WorkStealingPool* pool = nullptr, const ScenarioSettings& settings = ScenarioSettings());
+
+        // MarketData with a Carry is rejected, shifts apply to a flat spot and rate
+        size_t addUnderlying(const MarketData& marketData);
+        // Negative quantities are short positions
+        size_t addPosition(size_t underlying, const Option& option, double quantity);
+
+        size_t positionCount() const { return positions.size(); }
+
+        // The portfolio in one scenario, pnl against the unshifted portfolio
+        ScenarioResult evaluate(const ScenarioGrid::Scenario& scenario) const;
+
+        // One result per grid scenario, in grid index order
+        void run(const ScenarioGrid& grid, ScenarioResult* results, size_t count) const;
+        std::vector<ScenarioResult> run(const ScenarioGrid& grid) const;
+
+    private:
+        struct Position {
+            size_t underlying;
+            double strike;
+            double logStrike;
+            double expiry;
+            double volatility;
+            double quantity;
+            Option::Type type;
+            Option::Style style;
+        };
+
+        // Positions sharing an underlying and expiry, Americans further split by volatility
+        struct LatticeGroup {
+            double volatility;
+            std::vector<size_t> positions;
+        };
+
+        struct ExpiryGroup {
+            size_t underlying;
+            double expiry;
+            std::vector<size_t> europeans;
+            std::vector<LatticeGroup> americans;
+        };
+
+        std::vector<ExpiryGroup> groups() const;
+        // Sums the portfolio into results[s] for every spot shift s of one (vol, rate, time) point
+        void evaluateBlock(const std::vector<ExpiryGroup>& groups, const double* spotShifts, size_t spotCount,
+                           double volShift, double rateShift, double timeShift, ScenarioResult* results) const;
+        void europeans(const ExpiryGroup& group, const double* spots, size_t spotCount, double volShift,
+                       double r, double T, ScenarioResult* results) const;
+        void americans(const LatticeGroup& group, const double* spots, size_t spotCount, double volShift,
+                       double r, double T, ScenarioResult* results) const;
+
+        WorkStealingPool* pool;
+        ScenarioSettings settings;
+        std::vector<MarketData> underlyings;
+        std::vector<Position> positions;
+};
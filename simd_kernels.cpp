@@ -0,0 +1,472 @@
+#include "simd_kernels.hpp"
+#include <stdexcept>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OPTIONS_SIMD_X86 1
+#include <immintrin.h>
+#define OPTIONS_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define OPTIONS_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+namespace Simd {
+
+Isa detectIsa() {
+    static const Isa best = [] {
+        if (isSupported(Isa::AVX512)) return Isa::AVX512;
+        if (isSupported(Isa::AVX2)) return Isa::AVX2;
+        return Isa::SCALAR;
+    }();
+    return best;
+}
+
+bool isSupported(Isa isa) {
+    switch (isa) {
+        case Isa::SCALAR:
+            return true;
+#ifdef OPTIONS_SIMD_X86
+        case Isa::AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case Isa::AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::AVX2: return "AVX2";
+        case Isa::AVX512: return "AVX-512";
+        default: return "Scalar";
+    }
+}
+
+#ifdef OPTIONS_SIMD_X86
+namespace {
+    // Range reduction constants, LN2_HI has trailing zero bits so n * LN2_HI is exact
+    constexpr double LOG2E = 1.4426950408889634;
+    constexpr double LN2_HI = 6.93147180369123816490e-01;
+    constexpr double LN2_LO = 1.90821492927058770002e-10;
+    constexpr double SQRT2 = 1.41421356237309504880;
+    constexpr double EXP_MIN = -708.0;
+    constexpr double EXP_MAX = 709.0;
+    // 2^52 + 2^51, adding it to a small integral double exposes the integer in the low mantissa bits
+    constexpr double MAGIC = 6755399441055744.0;
+
+    // Taylor coefficients 1/k! for exp(r), |r| <= ln2/2, highest degree first
+    constexpr double EXP_POLY[] = {
+        1.0/6227020800.0, 1.0/479001600.0, 1.0/39916800.0, 1.0/3628800.0, 1.0/362880.0,
+        1.0/40320.0, 1.0/5040.0, 1.0/720.0, 1.0/120.0, 1.0/24.0, 1.0/6.0, 0.5, 1.0, 1.0
+    };
+    constexpr int EXP_TERMS = sizeof(EXP_POLY) / sizeof(EXP_POLY[0]);
+
+    // atanh series 1/(2k+1) for log(m) = 2s * sum(z^k/(2k+1)), s = (m-1)/(m+1), z = s^2
+    constexpr double LOG_POLY[] = {
+        1.0/21, 1.0/19, 1.0/17, 1.0/15, 1.0/13, 1.0/11, 1.0/9, 1.0/7, 1.0/5, 1.0/3, 1.0
+    };
+    constexpr int LOG_TERMS = sizeof(LOG_POLY) / sizeof(LOG_POLY[0]);
+
+    // Hart (1968) double precision rational approximation of the normal tail, see West (2005)
+    constexpr double CDF_NUM[] = {
+        3.52624965998911e-02, 0.700383064443688, 6.37396220353165, 33.912866078383,
+        112.079291497871, 221.213596169931, 220.206867912376
+    };
+    constexpr double CDF_DEN[] = {
+        8.83883476483184e-02, 1.75566716318264, 16.064177579207, 86.7807322029461,
+        296.564248779674, 637.333633378831, 793.826512519948, 440.413735824752
+    };
+    constexpr double CDF_SPLIT = 7.07106781186547;
+    constexpr double CDF_CUTOFF = 37.0;
+    constexpr double SQRT_2PI = 2.506628274631;
+    constexpr double INV_SQRT_2PI = 0.39894228040143267794;
+
+    // Remainder [offset, size) of a batch padded to W lanes with a benign contract,
+    // so the tail runs through the same kernel as the body of the chain
+    template <size_t W>
+    struct PaddedTail {
+        double spot[W], strike[W], rate[W], vol[W], expiry[W];
+        Option::Type type[W];
+        size_t live;
+
+        PaddedTail(const OptionBatch& batch, size_t offset) : live(batch.size - offset) {
+            for (size_t k = 0; k < W; ++k) {
+                const bool inRange = k < live;
+                spot[k] = inRange ? batch.spot[offset + k] : 1.0;
+                strike[k] = inRange ? batch.strike[offset + k] : 1.0;
+                rate[k] = inRange ? batch.riskFreeRate[offset + k] : 0.0;
+                vol[k] = inRange ? batch.volatility[offset + k] : 1.0;
+                expiry[k] = inRange ? batch.expiry[offset + k] : 1.0;
+                type[k] = inRange ? batch.type[offset + k] : Option::Type::CALL;
+            }
+        }
+
+        OptionBatch batch() const {
+            return OptionBatch{strike, expiry, type, nullptr, spot, rate, vol, W};
+        }
+    };
+
+    // Local Greeks buffers for the padded tail
+    template <size_t W>
+    struct TailGreeks {
+        double price[W], delta[W], gamma[W], theta[W], vega[W], rho[W];
+
+        GreeksBatch view() { return GreeksBatch{price, delta, gamma, theta, vega, rho}; }
+
+        void copyTo(const GreeksBatch& out, size_t offset, size_t count) const {
+            std::copy(price, price + count, out.price + offset);
+            std::copy(delta, delta + count, out.delta + offset);
+            std::copy(gamma, gamma + count, out.gamma + offset);
+            std::copy(theta, theta + count, out.theta + offset);
+            std::copy(vega, vega + count, out.vega + offset);
+            std::copy(rho, rho + count, out.rho + offset);
+        }
+    };
+
+    // ---------------- AVX2: 4 contracts per instruction ----------------
+
+    OPTIONS_TARGET_AVX2 inline __m256d exp4(__m256d x) {
+        x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(EXP_MIN)), _mm256_set1_pd(EXP_MAX));
+        const __m256d n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(LOG2E)),
+                                          _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256d r = _mm256_fnmadd_pd(n, _mm256_set1_pd(LN2_HI), x);
+        r = _mm256_fnmadd_pd(n, _mm256_set1_pd(LN2_LO), r);
+
+        __m256d p = _mm256_set1_pd(EXP_POLY[0]);
+        for (int k = 1; k < EXP_TERMS; ++k) {
+            p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(EXP_POLY[k]));
+        }
+
+        // Scale by 2^n, built directly in the exponent field
+        const __m256d magic = _mm256_set1_pd(MAGIC);
+        const __m256i n64 = _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(n, magic)),
+                                             _mm256_castpd_si256(magic));
+        const __m256i scale = _mm256_slli_epi64(_mm256_add_epi64(n64, _mm256_set1_epi64x(1023)), 52);
+        return _mm256_mul_pd(p, _mm256_castsi256_pd(scale));
+    }
+
+    // Natural log for positive normal inputs
+    OPTIONS_TARGET_AVX2 inline __m256d log4(__m256d x) {
+        const __m256i bits = _mm256_castpd_si256(x);
+        const __m256d magic = _mm256_set1_pd(MAGIC);
+        const __m256i e64 = _mm256_sub_epi64(_mm256_srli_epi64(bits, 52), _mm256_set1_epi64x(1023));
+        __m256d e = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(e64, _mm256_castpd_si256(magic))), magic);
+        __m256d m = _mm256_castsi256_pd(_mm256_or_si256(
+            _mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)),
+            _mm256_set1_epi64x(0x3FF0000000000000LL)));
+
+        // Centre the mantissa on 1 so the series converges quickly
+        const __m256d big = _mm256_cmp_pd(m, _mm256_set1_pd(SQRT2), _CMP_GT_OQ);
+        m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+        e = _mm256_add_pd(e, _mm256_and_pd(big, _mm256_set1_pd(1.0)));
+
+        const __m256d one = _mm256_set1_pd(1.0);
+        const __m256d s = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+        const __m256d z = _mm256_mul_pd(s, s);
+        __m256d p = _mm256_set1_pd(LOG_POLY[0]);
+        for (int k = 1; k < LOG_TERMS; ++k) {
+            p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(LOG_POLY[k]));
+        }
+        const __m256d logm = _mm256_mul_pd(_mm256_add_pd(s, s), p);
+        return _mm256_fmadd_pd(e, _mm256_set1_pd(LN2_HI), _mm256_fmadd_pd(e, _mm256_set1_pd(LN2_LO), logm));
+    }
+
+    OPTIONS_TARGET_AVX2 inline __m256d normalCDF4(__m256d x) {
+        const __m256d a = _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+        const __m256d e = exp4(_mm256_mul_pd(_mm256_mul_pd(a, a), _mm256_set1_pd(-0.5)));
+
+        __m256d num = _mm256_set1_pd(CDF_NUM[0]);
+        for (size_t k = 1; k < sizeof(CDF_NUM) / sizeof(CDF_NUM[0]); ++k) {
+            num = _mm256_fmadd_pd(num, a, _mm256_set1_pd(CDF_NUM[k]));
+        }
+        __m256d den = _mm256_set1_pd(CDF_DEN[0]);
+        for (size_t k = 1; k < sizeof(CDF_DEN) / sizeof(CDF_DEN[0]); ++k) {
+            den = _mm256_fmadd_pd(den, a, _mm256_set1_pd(CDF_DEN[k]));
+        }
+        const __m256d central = _mm256_div_pd(_mm256_mul_pd(e, num), den);
+
+        // Continued fraction for the far tail
+        __m256d cf = _mm256_add_pd(a, _mm256_set1_pd(0.65));
+        for (double k : {4.0, 3.0, 2.0, 1.0}) {
+            cf = _mm256_add_pd(a, _mm256_div_pd(_mm256_set1_pd(k), cf));
+        }
+        const __m256d tail = _mm256_div_pd(e, _mm256_mul_pd(cf, _mm256_set1_pd(SQRT_2PI)));
+
+        __m256d c = _mm256_blendv_pd(tail, central, _mm256_cmp_pd(a, _mm256_set1_pd(CDF_SPLIT), _CMP_LT_OQ));
+        c = _mm256_andnot_pd(_mm256_cmp_pd(a, _mm256_set1_pd(CDF_CUTOFF), _CMP_GT_OQ), c);
+        return _mm256_blendv_pd(c, _mm256_sub_pd(_mm256_set1_pd(1.0), c),
+                                _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_GT_OQ));
+    }
+
+    // Per-lane Black-Scholes intermediates shared by the price and Greeks kernels
+    struct Lanes4 {
+        __m256d S, K, r, sigma, T, sgn, sqrtT, volSqrtT, d1, d2, discountedK;
+    };
+
+    // Put lanes get sgn = -1 so both types share price = sgn * (S N(sgn d1) - K e^-rT N(sgn d2))
+    OPTIONS_TARGET_AVX2 inline Lanes4 load4(const OptionBatch& batch, size_t i) {
+        Lanes4 v;
+        v.S = _mm256_loadu_pd(batch.spot + i);
+        v.K = _mm256_loadu_pd(batch.strike + i);
+        v.r = _mm256_loadu_pd(batch.riskFreeRate + i);
+        v.sigma = _mm256_loadu_pd(batch.volatility + i);
+        v.T = _mm256_loadu_pd(batch.expiry + i);
+
+        const __m128i types = _mm_loadu_si128(reinterpret_cast<const __m128i*>(batch.type + i));
+        const __m128i isCall32 = _mm_cmpeq_epi32(types, _mm_set1_epi32(static_cast<int>(Option::Type::CALL)));
+        const __m256d isCall = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(isCall32));
+        v.sgn = _mm256_blendv_pd(_mm256_set1_pd(-1.0), _mm256_set1_pd(1.0), isCall);
+
+        v.sqrtT = _mm256_sqrt_pd(v.T);
+        v.volSqrtT = _mm256_mul_pd(v.sigma, v.sqrtT);
+        const __m256d drift = _mm256_fmadd_pd(_mm256_mul_pd(v.sigma, v.sigma), _mm256_set1_pd(0.5), v.r);
+        v.d1 = _mm256_div_pd(_mm256_fmadd_pd(drift, v.T, log4(_mm256_div_pd(v.S, v.K))), v.volSqrtT);
+        v.d2 = _mm256_sub_pd(v.d1, v.volSqrtT);
+        v.discountedK = _mm256_mul_pd(v.K, exp4(_mm256_mul_pd(_mm256_sub_pd(_mm256_setzero_pd(), v.r), v.T)));
+        return v;
+    }
+
+    OPTIONS_TARGET_AVX2 inline void blackScholes4(const OptionBatch& batch, size_t i, double* prices) {
+        const Lanes4 v = load4(batch, i);
+        const __m256d nd1 = normalCDF4(_mm256_mul_pd(v.sgn, v.d1));
+        const __m256d nd2 = normalCDF4(_mm256_mul_pd(v.sgn, v.d2));
+        _mm256_storeu_pd(prices, _mm256_mul_pd(v.sgn, _mm256_fmsub_pd(v.S, nd1, _mm256_mul_pd(v.discountedK, nd2))));
+    }
+
+    // delta = sgn N(sgn d1), theta = -S n(d1) sigma / 2sqrtT - sgn r K e^-rT N(sgn d2), rho = sgn T K e^-rT N(sgn d2)
+    OPTIONS_TARGET_AVX2 inline void greeks4(const OptionBatch& batch, size_t i, const GreeksBatch& out, size_t o) {
+        const Lanes4 v = load4(batch, i);
+        const __m256d nd1 = normalCDF4(_mm256_mul_pd(v.sgn, v.d1));
+        const __m256d nd2 = normalCDF4(_mm256_mul_pd(v.sgn, v.d2));
+        const __m256d pdf = _mm256_mul_pd(exp4(_mm256_mul_pd(_mm256_mul_pd(v.d1, v.d1), _mm256_set1_pd(-0.5))),
+                                          _mm256_set1_pd(INV_SQRT_2PI));
+        const __m256d kd2 = _mm256_mul_pd(v.discountedK, nd2);
+        const __m256d spdf = _mm256_mul_pd(v.S, pdf);
+
+        _mm256_storeu_pd(out.price + o, _mm256_mul_pd(v.sgn, _mm256_fmsub_pd(v.S, nd1, kd2)));
+        _mm256_storeu_pd(out.delta + o, _mm256_mul_pd(v.sgn, nd1));
+        _mm256_storeu_pd(out.gamma + o, _mm256_div_pd(pdf, _mm256_mul_pd(v.S, v.volSqrtT)));
+        _mm256_storeu_pd(out.theta + o, _mm256_sub_pd(
+            _mm256_div_pd(_mm256_mul_pd(spdf, v.sigma), _mm256_mul_pd(_mm256_set1_pd(-2.0), v.sqrtT)),
+            _mm256_mul_pd(_mm256_mul_pd(v.sgn, v.r), kd2)));
+        _mm256_storeu_pd(out.vega + o, _mm256_mul_pd(spdf, v.sqrtT));
+        _mm256_storeu_pd(out.rho + o, _mm256_mul_pd(_mm256_mul_pd(v.sgn, v.T), kd2));
+    }
+
+    OPTIONS_TARGET_AVX2 void blackScholesAvx2(const OptionBatch& batch, double* prices) {
+        size_t i = 0;
+        for (; i + 4 <= batch.size; i += 4) {
+            blackScholes4(batch, i, prices + i);
+        }
+        if (i < batch.size) {
+            const PaddedTail<4> tail(batch, i);
+            double out[4];
+            blackScholes4(tail.batch(), 0, out);
+            std::copy(out, out + tail.live, prices + i);
+        }
+    }
+
+    OPTIONS_TARGET_AVX2 void greeksAvx2(const OptionBatch& batch, const GreeksBatch& greeks) {
+        size_t i = 0;
+        for (; i + 4 <= batch.size; i += 4) {
+            greeks4(batch, i, greeks, i);
+        }
+        if (i < batch.size) {
+            const PaddedTail<4> tail(batch, i);
+            TailGreeks<4> out;
+            greeks4(tail.batch(), 0, out.view(), 0);
+            out.copyTo(greeks, i, tail.live);
+        }
+    }
+
+    // ---------------- AVX-512: 8 contracts per instruction ----------------
+
+    // GCC 12's unmasked AVX-512 intrinsics pass _mm512_undefined_pd() as the merge source, which
+    // trips the uninitialized warnings once inlined through target attributes
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+    OPTIONS_TARGET_AVX512 inline __m512d exp8(__m512d x) {
+        x = _mm512_min_pd(_mm512_max_pd(x, _mm512_set1_pd(EXP_MIN)), _mm512_set1_pd(EXP_MAX));
+        const __m512d n = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(LOG2E)),
+                                               _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m512d r = _mm512_fnmadd_pd(n, _mm512_set1_pd(LN2_HI), x);
+        r = _mm512_fnmadd_pd(n, _mm512_set1_pd(LN2_LO), r);
+
+        __m512d p = _mm512_set1_pd(EXP_POLY[0]);
+        for (int k = 1; k < EXP_TERMS; ++k) {
+            p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(EXP_POLY[k]));
+        }
+
+        const __m512d magic = _mm512_set1_pd(MAGIC);
+        const __m512i n64 = _mm512_sub_epi64(_mm512_castpd_si512(_mm512_add_pd(n, magic)),
+                                             _mm512_castpd_si512(magic));
+        const __m512i scale = _mm512_slli_epi64(_mm512_add_epi64(n64, _mm512_set1_epi64(1023)), 52);
+        return _mm512_mul_pd(p, _mm512_castsi512_pd(scale));
+    }
+
+    OPTIONS_TARGET_AVX512 inline __m512d log8(__m512d x) {
+        const __m512i bits = _mm512_castpd_si512(x);
+        const __m512d magic = _mm512_set1_pd(MAGIC);
+        const __m512i e64 = _mm512_sub_epi64(_mm512_srli_epi64(bits, 52), _mm512_set1_epi64(1023));
+        __m512d e = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_add_epi64(e64, _mm512_castpd_si512(magic))), magic);
+        __m512d m = _mm512_castsi512_pd(_mm512_or_si512(
+            _mm512_and_si512(bits, _mm512_set1_epi64(0x000FFFFFFFFFFFFFLL)),
+            _mm512_set1_epi64(0x3FF0000000000000LL)));
+
+        const __m512d one = _mm512_set1_pd(1.0);
+        const __mmask8 big = _mm512_cmp_pd_mask(m, _mm512_set1_pd(SQRT2), _CMP_GT_OQ);
+        m = _mm512_mask_mul_pd(m, big, m, _mm512_set1_pd(0.5));
+        e = _mm512_mask_add_pd(e, big, e, one);
+
+        const __m512d s = _mm512_div_pd(_mm512_sub_pd(m, one), _mm512_add_pd(m, one));
+        const __m512d z = _mm512_mul_pd(s, s);
+        __m512d p = _mm512_set1_pd(LOG_POLY[0]);
+        for (int k = 1; k < LOG_TERMS; ++k) {
+            p = _mm512_fmadd_pd(p, z, _mm512_set1_pd(LOG_POLY[k]));
+        }
+        const __m512d logm = _mm512_mul_pd(_mm512_add_pd(s, s), p);
+        return _mm512_fmadd_pd(e, _mm512_set1_pd(LN2_HI), _mm512_fmadd_pd(e, _mm512_set1_pd(LN2_LO), logm));
+    }
+
+    OPTIONS_TARGET_AVX512 inline __m512d normalCDF8(__m512d x) {
+        const __m512d a = _mm512_abs_pd(x);
+        const __m512d e = exp8(_mm512_mul_pd(_mm512_mul_pd(a, a), _mm512_set1_pd(-0.5)));
+
+        __m512d num = _mm512_set1_pd(CDF_NUM[0]);
+        for (size_t k = 1; k < sizeof(CDF_NUM) / sizeof(CDF_NUM[0]); ++k) {
+            num = _mm512_fmadd_pd(num, a, _mm512_set1_pd(CDF_NUM[k]));
+        }
+        __m512d den = _mm512_set1_pd(CDF_DEN[0]);
+        for (size_t k = 1; k < sizeof(CDF_DEN) / sizeof(CDF_DEN[0]); ++k) {
+            den = _mm512_fmadd_pd(den, a, _mm512_set1_pd(CDF_DEN[k]));
+        }
+        const __m512d central = _mm512_div_pd(_mm512_mul_pd(e, num), den);
+
+        __m512d cf = _mm512_add_pd(a, _mm512_set1_pd(0.65));
+        for (double k : {4.0, 3.0, 2.0, 1.0}) {
+            cf = _mm512_add_pd(a, _mm512_div_pd(_mm512_set1_pd(k), cf));
+        }
+        const __m512d tail = _mm512_div_pd(e, _mm512_mul_pd(cf, _mm512_set1_pd(SQRT_2PI)));
+
+        __m512d c = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a, _mm512_set1_pd(CDF_SPLIT), _CMP_LT_OQ), tail, central);
+        c = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a, _mm512_set1_pd(CDF_CUTOFF), _CMP_GT_OQ), c, _mm512_setzero_pd());
+        return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_GT_OQ),
+                                    c, _mm512_sub_pd(_mm512_set1_pd(1.0), c));
+    }
+
+    // Per-lane Black-Scholes intermediates shared by the price and Greeks kernels
+    struct Lanes8 {
+        __m512d S, K, r, sigma, T, sgn, sqrtT, volSqrtT, d1, d2, discountedK;
+    };
+
+    // Put lanes get sgn = -1 so both types share price = sgn * (S N(sgn d1) - K e^-rT N(sgn d2))
+    OPTIONS_TARGET_AVX512 inline Lanes8 load8(const OptionBatch& batch, size_t i) {
+        Lanes8 v;
+        v.S = _mm512_loadu_pd(batch.spot + i);
+        v.K = _mm512_loadu_pd(batch.strike + i);
+        v.r = _mm512_loadu_pd(batch.riskFreeRate + i);
+        v.sigma = _mm512_loadu_pd(batch.volatility + i);
+        v.T = _mm512_loadu_pd(batch.expiry + i);
+
+        const __m512i types = _mm512_cvtepi32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch.type + i)));
+        const __mmask8 isCall = _mm512_cmpeq_epi64_mask(types, _mm512_set1_epi64(static_cast<int>(Option::Type::CALL)));
+        v.sgn = _mm512_mask_blend_pd(isCall, _mm512_set1_pd(-1.0), _mm512_set1_pd(1.0));
+
+        v.sqrtT = _mm512_sqrt_pd(v.T);
+        v.volSqrtT = _mm512_mul_pd(v.sigma, v.sqrtT);
+        const __m512d drift = _mm512_fmadd_pd(_mm512_mul_pd(v.sigma, v.sigma), _mm512_set1_pd(0.5), v.r);
+        v.d1 = _mm512_div_pd(_mm512_fmadd_pd(drift, v.T, log8(_mm512_div_pd(v.S, v.K))), v.volSqrtT);
+        v.d2 = _mm512_sub_pd(v.d1, v.volSqrtT);
+        v.discountedK = _mm512_mul_pd(v.K, exp8(_mm512_mul_pd(_mm512_sub_pd(_mm512_setzero_pd(), v.r), v.T)));
+        return v;
+    }
+
+    OPTIONS_TARGET_AVX512 inline void blackScholes8(const OptionBatch& batch, size_t i, double* prices) {
+        const Lanes8 v = load8(batch, i);
+        const __m512d nd1 = normalCDF8(_mm512_mul_pd(v.sgn, v.d1));
+        const __m512d nd2 = normalCDF8(_mm512_mul_pd(v.sgn, v.d2));
+        _mm512_storeu_pd(prices, _mm512_mul_pd(v.sgn, _mm512_fmsub_pd(v.S, nd1, _mm512_mul_pd(v.discountedK, nd2))));
+    }
+
+    OPTIONS_TARGET_AVX512 inline void greeks8(const OptionBatch& batch, size_t i, const GreeksBatch& out, size_t o) {
+        const Lanes8 v = load8(batch, i);
+        const __m512d nd1 = normalCDF8(_mm512_mul_pd(v.sgn, v.d1));
+        const __m512d nd2 = normalCDF8(_mm512_mul_pd(v.sgn, v.d2));
+        const __m512d pdf = _mm512_mul_pd(exp8(_mm512_mul_pd(_mm512_mul_pd(v.d1, v.d1), _mm512_set1_pd(-0.5))),
+                                          _mm512_set1_pd(INV_SQRT_2PI));
+        const __m512d kd2 = _mm512_mul_pd(v.discountedK, nd2);
+        const __m512d spdf = _mm512_mul_pd(v.S, pdf);
+
+        _mm512_storeu_pd(out.price + o, _mm512_mul_pd(v.sgn, _mm512_fmsub_pd(v.S, nd1, kd2)));
+        _mm512_storeu_pd(out.delta + o, _mm512_mul_pd(v.sgn, nd1));
+        _mm512_storeu_pd(out.gamma + o, _mm512_div_pd(pdf, _mm512_mul_pd(v.S, v.volSqrtT)));
+        _mm512_storeu_pd(out.theta + o, _mm512_sub_pd(
+            _mm512_div_pd(_mm512_mul_pd(spdf, v.sigma), _mm512_mul_pd(_mm512_set1_pd(-2.0), v.sqrtT)),
+            _mm512_mul_pd(_mm512_mul_pd(v.sgn, v.r), kd2)));
+        _mm512_storeu_pd(out.vega + o, _mm512_mul_pd(spdf, v.sqrtT));
+        _mm512_storeu_pd(out.rho + o, _mm512_mul_pd(_mm512_mul_pd(v.sgn, v.T), kd2));
+    }
+
+    OPTIONS_TARGET_AVX512 void blackScholesAvx512(const OptionBatch& batch, double* prices) {
+        size_t i = 0;
+        for (; i + 8 <= batch.size; i += 8) {
+            blackScholes8(batch, i, prices + i);
+        }
+        if (i < batch.size) {
+            const PaddedTail<8> tail(batch, i);
+            double out[8];
+            blackScholes8(tail.batch(), 0, out);
+            std::copy(out, out + tail.live, prices + i);
+        }
+    }
+
+    OPTIONS_TARGET_AVX512 void greeksAvx512(const OptionBatch& batch, const GreeksBatch& greeks) {
+        size_t i = 0;
+        for (; i + 8 <= batch.size; i += 8) {
+            greeks8(batch, i, greeks, i);
+        }
+        if (i < batch.size) {
+            const PaddedTail<8> tail(batch, i);
+            TailGreeks<8> out;
+            greeks8(tail.batch(), 0, out.view(), 0);
+            out.copyTo(greeks, i, tail.live);
+        }
+    }
+#pragma GCC diagnostic pop
+}
+#endif
+
+void blackScholesBatch(Isa isa, const OptionBatch& batch, double* prices) {
+    static_assert(sizeof(Option::Type) == sizeof(int), "SIMD kernels load option types as 32-bit lanes");
+
+    if (isa == Isa::SCALAR || !isSupported(isa)) {
+        throw std::invalid_argument(std::string("Instruction set not available for vectorized pricing: ") + isaName(isa));
+    }
+
+#ifdef OPTIONS_SIMD_X86
+    if (isa == Isa::AVX512) {
+        blackScholesAvx512(batch, prices);
+    } else {
+        blackScholesAvx2(batch, prices);
+    }
+#endif
+}
+
+void blackScholesGreeksBatch(Isa isa, const OptionBatch& batch, const GreeksBatch& greeks) {
+    if (isa == Isa::SCALAR || !isSupported(isa)) {
+        throw std::invalid_argument(std::string("Instruction set not available for vectorized pricing: ") + isaName(isa));
+    }
+
+#ifdef OPTIONS_SIMD_X86
+    if (isa == Isa::AVX512) {
+        greeksAvx512(batch, greeks);
+    } else {
+        greeksAvx2(batch, greeks);
+    }
+#endif
+}
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "options_classes.hpp"
+#include <cstddef>
+
+// Vectorized pricing kernels with runtime instruction set dispatch
+// AVX2 evaluates 4 contracts per instruction, AVX-512 evaluates 8
+//
+// Accuracy: exp, log and the normal CDF are polynomial/rational approximations
+// accurate to a few ulp, so prices agree with the scalar erf-based path to
+// within 1e-10 absolute (in practice ~1e-13 for spot and strike around 100)
+namespace Simd {
+    enum class Isa { SCALAR, AVX2, AVX512 };
+
+    // Best instruction set supported by both the build and the running CPU
+    Isa detectIsa();
+    bool isSupported(Isa isa);
+    const char* isaName(Isa isa);
+
+    // Black-Scholes prices for a validated, all-European batch
+    // isa must be AVX2 or AVX512 and supported by the CPU
+    void blackScholesBatch(Isa isa, const OptionBatch& batch, double* prices);
+
+    // Prices and Greeks for a validated, all-European batch, same ISA requirements as above
+    void blackScholesGreeksBatch(Isa isa, const OptionBatch& batch, const GreeksBatch& greeks);
+}
@@ -0,0 +1,131 @@
+#include "term_structure.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    uint64_t nextCarryId() {
+        static std::atomic<uint64_t> counter{1};
+        return counter.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+YieldCurve::YieldCurve(double rate) : YieldCurve(std::vector<double>{1.0}, std::vector<double>{rate}) {}
+
+YieldCurve::YieldCurve(std::vector<double> times, const std::vector<double>& zeroRates)
+    : times(std::move(times)), rates(zeroRates) {
+    if (this->times.empty() || this->times.size() != rates.size()) {
+        throw std::invalid_argument("Yield curve needs one zero rate per pillar");
+    }
+    for (size_t i = 0; i < this->times.size(); ++i) {
+        if (!(this->times[i] > 0) || !std::isfinite(this->times[i]) || !std::isfinite(rates[i])) {
+            throw std::invalid_argument("Yield curve pillars must be positive with finite rates");
+        }
+        if (i > 0 && !(this->times[i] > this->times[i - 1])) {
+            throw std::invalid_argument("Yield curve pillars must be strictly increasing");
+        }
+        logDiscounts.push_back(-rates[i] * this->times[i]);
+    }
+}
+
+double YieldCurve::zeroRate(double t) const {
+    if (!(t > times.front())) {
+        return rates.front();
+    }
+    if (t >= times.back()) {
+        return rates.back();
+    }
+    const size_t i = std::upper_bound(times.begin(), times.end(), t) - times.begin() - 1;
+    const double w = (t - times[i]) / (times[i + 1] - times[i]);
+    return -(logDiscounts[i] + w * (logDiscounts[i + 1] - logDiscounts[i])) / t;
+}
+
+double YieldCurve::discount(double t) const {
+    return exp(-zeroRate(t) * t);
+}
+
+bool YieldCurve::isFlat() const {
+    return std::adjacent_find(rates.begin(), rates.end(), std::not_equal_to<double>()) == rates.end();
+}
+
+YieldCurve YieldCurve::shifted(double shift) const {
+    std::vector<double> moved(rates);
+    for (double& rate : moved) {
+        rate += shift;
+    }
+    return YieldCurve(times, moved);
+}
+
+Carry::Carry(YieldCurve curve, std::vector<Dividend> dividends, double dividendYield)
+    : yieldCurve(std::move(curve)), cash(std::move(dividends)), yield(dividendYield), identity(nextCarryId()) {
+    if (!std::isfinite(yield)) {
+        throw std::invalid_argument("Dividend yield must be finite");
+    }
+    for (const Dividend& dividend : cash) {
+        if (!(dividend.time > 0) || !std::isfinite(dividend.time) || !(dividend.amount >= 0) ||
+            !std::isfinite(dividend.amount)) {
+            throw std::invalid_argument("Dividends need a positive time and a non-negative amount");
+        }
+    }
+    std::sort(cash.begin(), cash.end(), [](const Dividend& a, const Dividend& b) { return a.time < b.time; });
+
+    flat = yieldCurve.isFlat() && cash.empty() && yield == 0;
+}
+
+double Carry::dividendValue(double T) const {
+    double value = 0.0;
+    for (const Dividend& dividend : cash) {
+        if (dividend.time > T) {
+            break;
+        }
+        value += dividend.amount * discount(dividend.time);
+    }
+    return value;
+}
+
+double Carry::prepaidForward(double spot, double T) const {
+    return (spot - dividendValue(T)) * exp(-yield * T);
+}
+
+double Carry::spotFor(double prepaidForward, double T) const {
+    return prepaidForward * exp(yield * T) + dividendValue(T);
+}
+
+void Carry::fillSteps(double T, int N, double* growth, double* scale, double* shift) const {
+    const double dt = T / N;
+
+    // The only transcendentals: one discount per level and one yield factor
+    std::vector<double> discounts(N + 1);
+    for (int i = 0; i <= N; ++i) {
+        discounts[i] = discount(i * dt);
+    }
+    for (int i = 0; i < N; ++i) {
+        growth[i] = discounts[i] / discounts[i + 1];
+    }
+
+    const double yieldStep = exp(yield * dt);
+    scale[N] = 1.0;
+    for (int i = N - 1; i >= 0; --i) {
+        scale[i] = scale[i + 1] * yieldStep;
+    }
+
+    // Walk back from T accumulating today's value of the dividends still ahead of each level
+    size_t next = std::upper_bound(cash.begin(), cash.end(), T,
+                                   [](double t, const Dividend& dividend) { return t < dividend.time; }) - cash.begin();
+    double ahead = 0.0;
+    for (int i = N; i >= 0; --i) {
+        const double t = i * dt;
+        while (next > 0 && cash[next - 1].time > t) {
+            --next;
+            ahead += cash[next].amount * discount(cash[next].time);
+        }
+        shift[i] = ahead / discounts[i];
+    }
+}
+
+Carry Carry::shifted(double rateShift) const {
+    return Carry(yieldCurve.shifted(rateShift), cash, yield);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Zero curve with continuously compounded rates
+// Log discount is linear in time between pillars (flat forwards), the zero rate is held flat
+// before the first pillar and after the last
+class YieldCurve {
+    public:
+        explicit YieldCurve(double rate);
+        YieldCurve(std::vector<double> times, const std::vector<double>& zeroRates);
+
+        double discount(double t) const;
+        double zeroRate(double t) const;
+
+        // Equal zero rates at every pillar, so the same rate at every maturity
+        bool isFlat() const;
+
+        // Same curve moved in parallel by shift, for rho
+        YieldCurve shifted(double shift) const;
+
+    private:
+        std::vector<double> times;
+        std::vector<double> rates;
+        std::vector<double> logDiscounts;   // -rate * time at each pillar
+};
+
+// Cash dividend paid at time (years from today)
+struct Dividend {
+    double time;
+    double amount;
+};
+
+// Rates and dividends of one underlying, shared by every contract on it
+//
+// Escrowed dividend model: the stochastic part of the spot is S less the present value of the
+// cash dividends, and it pays the continuous yield on top. A contract to T is then a flat
+// Black-Scholes contract on the prepaid forward with the zero rate to T, exact for Europeans.
+// American trees run on the prepaid forward and add the dividends back level by level.
+class Carry {
+    public:
+        Carry(YieldCurve curve, std::vector<Dividend> dividends = {}, double dividendYield = 0.0);
+
+        const YieldCurve& curve() const { return yieldCurve; }
+        const std::vector<Dividend>& dividends() const { return cash; }
+        double dividendYield() const { return yield; }
+
+        double discount(double t) const { return yieldCurve.discount(t); }
+        double zeroRate(double t) const { return yieldCurve.zeroRate(t); }
+
+        // Value today of the stock delivered at T: (S - PV of cash dividends to T) * e^(-yield T)
+        double prepaidForward(double spot, double T) const;
+        // The spot whose prepaid forward to T is prepaidForward, its inverse
+        double spotFor(double prepaidForward, double T) const;
+
+        // Per-level inputs of an N-step tree to T on the prepaid forward, with t_i = i T / N:
+        //   growth[i] = P(t_i) / P(t_(i+1)), the level's forward growth, for i < N
+        //   scale[i]  = e^(yield (T - t_i)), undoing the yield prepaid from t_i
+        //   shift[i]  = PV at t_i of the cash dividends paid in (t_i, T]
+        // so a level-i node at prepaid-forward spot F exercises against F * scale[i] + shift[i].
+        // growth needs N entries, scale and shift N + 1
+        void fillSteps(double T, int N, double* growth, double* scale, double* shift) const;
+
+        // No rate term structure, dividends or yield, so the flat-rate paths price it exactly
+        bool isFlat() const { return flat; }
+
+        // Distinguishes Carry objects for caches keyed on them, never reused within a process
+        uint64_t id() const { return identity; }
+
+        Carry shifted(double rateShift) const;
+
+    private:
+        double dividendValue(double T) const;   // PV of the cash dividends paid up to T
+
+        YieldCurve yieldCurve;
+        std::vector<Dividend> cash;   // sorted by time
+        double yield;
+        bool flat;
+        uint64_t identity;
+};
@@ -0,0 +1,148 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+
+namespace {
+    // Pool the current thread is working for, used to detect nested parallelFor calls
+    thread_local const WorkStealingPool* currentPool = nullptr;
+}
+
+WorkStealingPool::WorkStealingPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (size_t slot = 0; slot < threads; ++slot) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t slot = 1; slot < threads; ++slot) {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, slot);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::parallelFor(size_t taskCount, const std::function<void(size_t)>& task) {
+    if (taskCount == 0) {
+        return;
+    }
+
+    // Nested call from one of our own tasks, or nothing to share the work with
+    if (currentPool == this || queues.size() == 1) {
+        for (size_t t = 0; t < taskCount; ++t) {
+            task(t);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> submit(submitMutex);
+
+    Job job;
+    job.task = &task;
+    job.remaining.store(taskCount);
+
+    // Contiguous blocks per participant keep neighbouring tiles on one core until stolen
+    const size_t participants = queues.size();
+    for (size_t slot = 0; slot < participants; ++slot) {
+        const size_t begin = taskCount * slot / participants;
+        const size_t end = taskCount * (slot + 1) / participants;
+        std::lock_guard<std::mutex> lock(queues[slot]->mutex);
+        for (size_t t = begin; t < end; ++t) {
+            queues[slot]->tasks.emplace_back(&job, t);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        ++generation;
+    }
+    wake.notify_all();
+
+    // Restore rather than clear, the caller may itself be a worker of another pool
+    const WorkStealingPool* const callerPool = currentPool;
+    currentPool = this;
+    drain(0);
+    currentPool = callerPool;
+
+    {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        finished.wait(lock, [&] { return job.remaining.load() == 0; });
+    }
+
+    if (job.error) {
+        std::rethrow_exception(job.error);
+    }
+}
+
+void WorkStealingPool::workerLoop(size_t slot) {
+    currentPool = this;
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+        drain(slot);
+    }
+}
+
+void WorkStealingPool::drain(size_t slot) {
+    std::pair<Job*, size_t> work;
+    while (popLocal(slot, work) || steal(slot, work)) {
+        run(work);
+    }
+}
+
+bool WorkStealingPool::popLocal(size_t slot, std::pair<Job*, size_t>& out) {
+    Queue& queue = *queues[slot];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    out = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(size_t thief, std::pair<Job*, size_t>& out) {
+    const size_t participants = queues.size();
+    for (size_t offset = 1; offset < participants; ++offset) {
+        Queue& victim = *queues[(thief + offset) % participants];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            out = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(const std::pair<Job*, size_t>& work) {
+    Job& job = *work.first;
+    try {
+        (*job.task)(work.second);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(job.errorMutex);
+        if (!job.error) {
+            job.error = std::current_exception();
+        }
+    }
+
+    if (job.remaining.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        finished.notify_all();
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Fixed-size work-stealing thread pool
+// Each participant owns a deque, pops its own work from the back and steals from the
+// front of the others when it runs dry, so uneven tasks balance without a central queue
+class WorkStealingPool {
+    public:
+        // threads counts every participant including the calling thread, 0 = hardware concurrency
+        explicit WorkStealingPool(size_t threads = 0);
+        ~WorkStealingPool();
+
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+        size_t threadCount() const { return queues.size(); }
+
+        // Runs task(t) for every t in [0, taskCount) and blocks until all have finished
+        // The caller works too. The first exception thrown by a task is rethrown here.
+        // Calls from inside a task run serially on that thread rather than deadlocking
+        void parallelFor(size_t taskCount, const std::function<void(size_t)>& task);
+
+    private:
+        struct Job {
+            const std::function<void(size_t)>* task;
+            std::atomic<size_t> remaining;
+            std::mutex errorMutex;
+            std::exception_ptr error;
+        };
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<std::pair<Job*, size_t>> tasks;
+        };
+
+        void workerLoop(size_t slot);
+        void drain(size_t slot);
+        bool popLocal(size_t slot, std::pair<Job*, size_t>& out);
+        bool steal(size_t thief, std::pair<Job*, size_t>& out);
+        void run(const std::pair<Job*, size_t>& work);
+
+        std::vector<std::unique_ptr<Queue>> queues;  // slot 0 belongs to the submitting thread
+        std::vector<std::thread> workers;
+
+        std::mutex submitMutex;  // one parallelFor at a time
+        std::mutex stateMutex;
+        std::condition_variable wake;
+        std::condition_variable finished;
+        uint64_t generation = 0;
+        bool stopping = false;
+};
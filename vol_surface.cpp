@@ -0,0 +1,153 @@
+#include "vol_surface.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+    // NaN lands on the lower edge rather than indexing the bucket table with it
+    inline double clampTo(double x, double low, double high) {
+        return x > low ? (x < high ? x : high) : low;
+    }
+}
+
+void VolSurface::Axis::build(const char* name) {
+    if (knots.empty()) {
+        throw std::invalid_argument(std::string("Vol surface needs at least one ") + name);
+    }
+    for (size_t i = 0; i < knots.size(); ++i) {
+        if (!(knots[i] > 0) || !std::isfinite(knots[i])) {
+            throw std::invalid_argument(std::string("Vol surface ") + name + " knots must be positive");
+        }
+        if (i > 0 && !(knots[i] > knots[i - 1])) {
+            throw std::invalid_argument(std::string("Vol surface ") + name + " knots must be strictly increasing");
+        }
+    }
+    if (knots.size() < 2) {
+        return;
+    }
+    double narrowest = knots.back() - knots.front();
+    for (size_t i = 0; i + 1 < knots.size(); ++i) {
+        inverseSpan.push_back(1.0 / (knots[i + 1] - knots[i]));
+        narrowest = std::min(narrowest, knots[i + 1] - knots[i]);
+    }
+
+    // Buckets no wider than the narrowest interval hold at most one knot, so interval() needs a
+    // single branch-free step. Very uneven grids are capped and fall back to walking.
+    const double range = knots.back() - knots.front();
+    const double needed = std::ceil(range / narrowest) + 1;
+    singleStep = needed <= 64.0 * knots.size();
+    const size_t count = static_cast<size_t>(std::min(needed, 64.0 * knots.size()));
+    scale = count / range;
+    buckets.resize(count);
+    size_t i = 0;
+    for (size_t b = 0; b < count; ++b) {
+        const double left = knots.front() + b / scale;
+        while (i + 2 < knots.size() && knots[i + 1] <= left) {
+            ++i;
+        }
+        buckets[b] = i;
+    }
+}
+
+size_t VolSurface::Axis::interval(double x) const {
+    const size_t b = std::min(static_cast<size_t>((x - knots.front()) * scale), buckets.size() - 1);
+    size_t i = buckets[b];
+    if (singleStep) {
+        return i + ((i + 2 < knots.size()) & (knots[i + 1] <= x));
+    }
+    while (i + 2 < knots.size() && knots[i + 1] <= x) {
+        ++i;
+    }
+    return i;
+}
+
+VolSurface::VolSurface(std::vector<double> strikes, std::vector<double> expiries, const std::vector<double>& vols) {
+    strikeKnots.knots = std::move(strikes);
+    expiryKnots.knots = std::move(expiries);
+    if (strikeKnots.knots.size() < 2) {
+        throw std::invalid_argument("Vol surface needs at least two strikes");
+    }
+    strikeKnots.build("strike");
+    expiryKnots.build("expiry");
+
+    const std::vector<double>& k = strikeKnots.knots;
+    const size_t n = k.size();
+    const size_t slices = expiryKnots.knots.size();
+    if (vols.size() != n * slices) {
+        throw std::invalid_argument("Vol surface needs one quote per strike and expiry");
+    }
+    for (const double v : vols) {
+        if (!(v > 0) || !std::isfinite(v)) {
+            throw std::invalid_argument("Vol surface quotes must be positive");
+        }
+    }
+
+    // Fritsch-Butland tangents: zero at local extrema, a weighted harmonic mean of the
+    // neighbouring secants elsewhere, which keeps every interval monotone
+    coefficients.resize(4 * (n - 1) * slices);
+    std::vector<double> secant(n - 1), tangent(n);
+    for (size_t j = 0; j < slices; ++j) {
+        const double* y = vols.data() + j * n;
+        for (size_t i = 0; i + 1 < n; ++i) {
+            secant[i] = (y[i + 1] - y[i]) / (k[i + 1] - k[i]);
+        }
+        tangent[0] = secant[0];
+        tangent[n - 1] = secant[n - 2];
+        for (size_t i = 1; i + 1 < n; ++i) {
+            if (secant[i - 1] * secant[i] <= 0) {
+                tangent[i] = 0.0;
+                continue;
+            }
+            const double hLeft = k[i] - k[i - 1];
+            const double hRight = k[i + 1] - k[i];
+            tangent[i] = 3.0 * (hLeft + hRight) /
+                         ((2.0 * hRight + hLeft) / secant[i - 1] + (hRight + 2.0 * hLeft) / secant[i]);
+        }
+
+        double* c = coefficients.data() + 4 * (n - 1) * j;
+        for (size_t i = 0; i + 1 < n; ++i, c += 4) {
+            const double h = k[i + 1] - k[i];
+            c[0] = y[i];
+            c[1] = tangent[i];
+            c[2] = (3.0 * secant[i] - 2.0 * tangent[i] - tangent[i + 1]) / h;
+            c[3] = (tangent[i] + tangent[i + 1] - 2.0 * secant[i]) / (h * h);
+        }
+    }
+}
+
+inline double VolSurface::sliceVolatility(size_t slice, size_t i, double dk) const {
+    const double* c = coefficients.data() + 4 * ((strikeKnots.knots.size() - 1) * slice + i);
+    return c[0] + dk * (c[1] + dk * (c[2] + dk * c[3]));
+}
+
+double VolSurface::volatility(double strike, double expiry) const {
+    const std::vector<double>& k = strikeKnots.knots;
+    const std::vector<double>& t = expiryKnots.knots;
+    const double x = clampTo(strike, k.front(), k.back());
+    const size_t i = strikeKnots.interval(x);
+    const double dk = x - k[i];
+
+    if (!(expiry > t.front())) {
+        return sliceVolatility(0, i, dk);
+    }
+    if (expiry >= t.back()) {
+        return sliceVolatility(t.size() - 1, i, dk);
+    }
+
+    // Linear in total variance between the neighbouring slices
+    const size_t j = expiryKnots.interval(expiry);
+    const double v0 = sliceVolatility(j, i, dk);
+    const double v1 = sliceVolatility(j + 1, i, dk);
+    const double w0 = v0 * v0 * t[j];
+    const double w1 = v1 * v1 * t[j + 1];
+    const double w = w0 + (w1 - w0) * (expiry - t[j]) * expiryKnots.inverseSpan[j];
+    return std::sqrt(w / expiry);
+}
+
+void VolSurface::volatilities(const double* strike, const double* expiry, double* out, size_t count) const {
+    for (size_t c = 0; c < count; ++c) {
+        out[c] = volatility(strike[c], expiry[c]);
+    }
+}
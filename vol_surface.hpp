@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Implied volatility surface on a rectangular (strike, expiry) grid
+//
+// Each expiry slice is a monotone cubic (Fritsch-Butland tangents) in strike, so it passes through
+// every quote and adds no wiggles between them. Coefficients are precomputed and stored
+// contiguously per slice. Between slices, total variance vol^2 * T is linear in expiry. Outside
+// the grid the vol is held flat. Interval lookup is O(1): a uniform bucket table maps a
+// coordinate to the knot interval it starts in.
+class VolSurface {
+    public:
+        // vols is row-major, one row of strikes.size() quotes per expiry
+        VolSurface(std::vector<double> strikes, std::vector<double> expiries, const std::vector<double>& vols);
+
+        double volatility(double strike, double expiry) const;
+
+        // Writes count vols for parallel strike/expiry arrays, e.g. an OptionBatch's columns
+        void volatilities(const double* strike, const double* expiry, double* out, size_t count) const;
+
+        const std::vector<double>& strikes() const { return strikeKnots.knots; }
+        const std::vector<double>& expiries() const { return expiryKnots.knots; }
+
+    private:
+        // Sorted knots plus a bucket table: bucket b covers [first + b / scale, first + (b + 1) / scale)
+        // and holds the interval its left edge falls in
+        struct Axis {
+            std::vector<double> knots;
+            std::vector<size_t> buckets;
+            std::vector<double> inverseSpan;   // 1 / (knots[i + 1] - knots[i])
+            double scale = 0.0;
+            bool singleStep = false;   // no bucket holds more than one knot
+
+            void build(const char* name);
+            // Interval i with knots[i] <= x < knots[i + 1], x already clamped to the knot range
+            size_t interval(double x) const;
+        };
+
+        // Slice j's cubic on strike interval i, in powers of (strike - knots[i])
+        double sliceVolatility(size_t slice, size_t i, double dk) const;
+
+        Axis strikeKnots;
+        Axis expiryKnots;
+        std::vector<double> coefficients;   // 4 per (slice, interval)
+};